@@ -1,7 +1,10 @@
 ﻿#include "ANNNetwork.hpp"
+#include "../Common/Profiler.hpp"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <random>
+#include <sstream>
 
 bool g_ann_imc_trace = true;
 
@@ -52,7 +55,7 @@ std::vector<double> PE::compute(const std::vector<double>& input) const
     return m_yflash.step(input);
 }
 
-std::vector<double> PE::computeBitwise(const std::vector<std::vector<uint8_t>>& activationBits) const 
+std::vector<double> PE::computeBitwise(const std::vector<std::vector<uint8_t>>& activationBits, std::ostream& trace) const 
 {
     const std::vector<double> pmac_cols = m_yflash.bitwise_pmac(activationBits);
 
@@ -76,7 +79,7 @@ std::vector<double> PE::computeBitwise(const std::vector<std::vector<uint8_t>>&
         extern bool g_ann_imc_trace;
         if (g_ann_imc_trace) 
         {
-            std::cout << "[FIRE] col=" << col
+            trace << "[FIRE] col=" << col
                 << " I=" << fire.I_phys << "A"
                 << " Vc(T0)=" << fire.Vc_T0 << "V"
                 << " Vth=" << fire.Vth
@@ -98,6 +101,9 @@ ANNNetwork::ANNNetwork(const NetworkParameters& params)
     : m_annBitSerialBits(params.annBitSerialBits),
     m_annDsaOutBits(params.annDsaOutBits)
 {
+    if (params.computeThreads != 1)
+        m_scheduler = std::make_shared<TaskScheduler>(static_cast<unsigned>(params.computeThreads));
+
     // Build PEs from params.annPEs (preferred path)
     if (!params.annPEs.empty())
     {
@@ -115,8 +121,8 @@ ANNNetwork::ANNNetwork(const NetworkParameters& params)
         {
             NetworkParameters::PEBlock peb;
             peb.id = static_cast<int>(m_VecPEs.size());
-            peb.yflash.rows = static_cast<int>(W.size());
-            peb.yflash.cols = peb.yflash.rows ? static_cast<int>(W.front().size()) : 0;
+            peb.yflash.rows = static_cast<int>(W.rows());
+            peb.yflash.cols = static_cast<int>(W.cols());
             peb.yflash.isSigned = false;
             peb.yflash.Wpos = W;
             m_VecPEs.emplace_back(peb, params);
@@ -129,7 +135,7 @@ ANNNetwork::ANNNetwork(const NetworkParameters& params)
     }
 }
 
-void ANNNetwork::run(std::ifstream& inputFile) 
+void ANNNetwork::run(std::istream& inputFile) 
 {
     enableIMCTrace(true);
     std::vector<int64_t> macs(m_VecPEs.size(), 0);
@@ -138,55 +144,93 @@ void ANNNetwork::run(std::ifstream& inputFile)
         throw std::runtime_error("[ANNNetwork::runIMCFromBitplaneFile] bad input stream");
     }
 
-    auto nextToken = [&](int& bit) -> bool 
+    // Reader stage: each line becomes its 0/1 tokens; a token starting with '#'
+    // comments out the rest of the line, any other token is ignored.
+    auto parseLine = [](const std::string& line, std::size_t, std::vector<double>& bits)
         {
-        // read next non-comment, non-empty token ("0" or "1"), space/newline separated
+        std::istringstream iss(line);
         std::string tok;
-        while (inputFile >> tok) 
+        while (iss >> tok)
         {
-            if (tok.size() && tok[0] == '#') 
-            {
-                std::string discard;
-                std::getline(inputFile, discard); // skip rest of comment line
-                continue;
-            }
-            // trim quotes/whitespace
-            while (!tok.empty() && (tok.back() == '\r' || tok.back() == '\n')) tok.pop_back();
-            if (tok == "0" || tok == "1") { bit = (tok[0] == '1') ? 1 : 0; return true; }
-            // ignore other tokens (blank/garbage)
+            if (tok[0] == '#') break;
+            if (tok == "0" || tok == "1") bits.push_back(tok[0] == '1' ? 1.0 : 0.0);
         }
-        return false; // EOF
         };
+    ProgressReporter progress(m_progress, inputFile);
+    LineReader reader(inputFile, parseLine, m_pipeline, 0, inputOffsetEvery_());
+    InputLine input;
+    std::size_t pos = 0;
+    std::uint64_t linesRead = 0;
 
-    for (size_t p = 0; p < m_VecPEs.size(); ++p) 
+    auto nextToken = [&](int& bit) -> bool 
+        {
+        // next "0"/"1" token of the input, across lines
+        while (pos >= input.values.size())
+        {
+            if (!reader.next(input)) return false; // EOF
+            ++linesRead;
+            progress.lineDone(input);
+            pos = 0;
+        }
+        bit = input.values[pos++] != 0.0 ? 1 : 0;
+        return true;
+        };
+
+    // Reader: every bit-plane grid (rows × cols of 0/1), PE by PE, MSB → LSB. A read error
+    // is reported after the PEs read before it have run, as the sequential loop did.
+    using Grid = std::vector<std::vector<uint8_t>>;
+    std::vector<std::vector<Grid>> planes(m_VecPEs.size());
+    std::string readError;
+    for (size_t p = 0; p < m_VecPEs.size() && readError.empty(); ++p) 
     {
         const int rows = m_VecPEs[p].rows();
         const int cols = m_VecPEs[p].cols();
         if (rows <= 0 || cols <= 0) 
         {
-            throw std::runtime_error("[ANNNetwork::runIMCFromBitplaneFile] PE " + std::to_string(p) + " has invalid dims");
+            readError = "[ANNNetwork::runIMCFromBitplaneFile] PE " + std::to_string(p) + " has invalid dims";
+            break;
         }
 
-        DSA acc(m_annDsaOutBits > 0 ? m_annDsaOutBits : (m_annBitSerialBits + 8));
-        for (int b = m_annBitSerialBits - 1; b >= 0; --b) 
-        { // MSB → LSB
-            // read one bit-plane grid: rows × cols of 0/1
-            std::vector<std::vector<uint8_t>> grid(rows, std::vector<uint8_t>(cols, 0));
-            for (int r = 0; r < rows; ++r) 
+        for (int b = m_annBitSerialBits - 1; b >= 0 && readError.empty(); --b) 
+        {
+            Grid grid(rows, std::vector<uint8_t>(cols, 0));
+            for (int r = 0; r < rows && readError.empty(); ++r) 
             {
                 for (int c = 0; c < cols; ++c) 
                 {
                     int v;
                     if (!nextToken(v)) 
                     {
-                        throw std::runtime_error("[ANNNetwork::runIMCFromBitplaneFile] EOF while reading PE " + std::to_string(p) + " bit " + std::to_string(b) + " grid");
+                        readError = "[ANNNetwork::runIMCFromBitplaneFile] EOF while reading PE " + std::to_string(p) + " bit " + std::to_string(b) + " grid";
+                        break;
                     }
                     grid[r][c] = static_cast<uint8_t>(v);
                 }
             }
+            if (readError.empty())
+                planes[p].push_back(std::move(grid));
+        }
+    }
 
+    // profiling: computeBitwise time per PE, bit-planes and cells hit by a 1 bit
+    const bool profiling = Profiler::enabled();
+    std::vector<std::uint64_t> peNs(profiling ? m_VecPEs.size() : 0, 0);
+    std::vector<std::uint64_t> peCells(m_VecPEs.size(), 0);
+
+    auto computePE = [&](size_t p, std::ostream& trace)
+        {
+        DSA acc(m_annDsaOutBits > 0 ? m_annDsaOutBits : (m_annBitSerialBits + 8));
+        for (const Grid& grid : planes[p])
+        {
             // one IMC bit-cycle → per-column TDC codes (hits MUX → VTC → TDC)
-            auto codes = m_VecPEs[p].computeBitwise(grid);
+            const std::uint64_t start = profiling ? Profiler::now() : 0;
+            auto codes = m_VecPEs[p].computeBitwise(grid, trace);
+            if (profiling)
+            {
+                peNs[p] += Profiler::now() - start;
+                for (const auto& row : grid)
+                    peCells[p] += static_cast<std::uint64_t>(std::count(row.begin(), row.end(), 1));
+            }
 
             // reduce to one pMAC for this bit (sum of codes; adapt if you want another reducer)
             int pMAC = 0;
@@ -194,12 +238,74 @@ void ANNNetwork::run(std::ifstream& inputFile)
             acc.accumulate(pMAC);
         }
         macs[p] = acc.value();
+        };
+
+    // PEs are independent: with a scheduler each one is a task (a PE is a whole run's worth
+    // of bit-planes, so no chunk tuning) and writes its trace to a buffer, printed (and its
+    // error rethrown) in PE order afterwards.
+    std::vector<std::ostringstream> traces(m_scheduler ? m_VecPEs.size() : 0);
+    std::vector<std::exception_ptr> errors(m_VecPEs.size());
+    if (m_scheduler)
+    {
+        m_scheduler->parallelFor(m_VecPEs.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p)
+            {
+                try
+                {
+                    computePE(p, traces[p]);
+                }
+                catch (...)
+                {
+                    errors[p] = std::current_exception();
+                }
+            }
+        });
+    }
+    else
+    {
+        for (size_t p = 0; p < m_VecPEs.size(); ++p)
+            computePE(p, std::cout);
+    }
+    for (size_t p = 0; p < traces.size(); ++p)
+    {
+        std::cout << traces[p].str();
+        if (errors[p]) std::rethrow_exception(errors[p]);
     }
+    if (!readError.empty())
+    {
+        throw std::runtime_error(readError);
+    }
+
+    std::uint64_t bitplanes = 0, activeCells = 0;
+    for (size_t p = 0; p < m_VecPEs.size(); ++p)
+    {
+        bitplanes += planes[p].size();
+        activeCells += peCells[p];
+    }
+    progress.finish();
 
     for (size_t p = 0; p < macs.size(); ++p)
     {
         std::cout << "PE " << p << " IMC-MAC = " << macs[p] << "\n";
     }
+    m_lastMacs = macs;
+
+    if (profiling)
+    {
+        std::uint64_t peTotal = 0;
+        for (std::uint64_t ns : peNs) peTotal += ns;
+        Profiler::addLayerTimes(peNs);
+        Profiler::addTime(Profiler::LayerUpdate, peTotal);
+        Profiler::addCount(Profiler::InputLines, linesRead);
+        Profiler::addCount(Profiler::Cycles, bitplanes);
+        Profiler::addCount(Profiler::SynapticEvents, activeCells);
+    }
+}
+
+void ANNNetwork::collectTotals(std::map<std::string, double>& totals)
+{
+    for (size_t p = 0; p < m_lastMacs.size(); ++p)
+        totals["pe" + std::to_string(p) + "_mac"] = static_cast<double>(m_lastMacs[p]);
 }
 
 void ANNNetwork::printNetworkToFile() 
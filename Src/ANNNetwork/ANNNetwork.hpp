@@ -15,6 +15,8 @@
 
 #include <cstdint>
 #include <fstream>
+#include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -23,6 +25,7 @@
 
  // Adjust include path to your project layout if needed.
 #include "../Common/BaseNetwork.hpp"
+#include "../Common/TaskScheduler.hpp"
 
 /* ============================= *
  *  Back-end helper components   *
@@ -139,7 +142,8 @@ public:
     std::vector<double> compute(const std::vector<double>& input) const;
 
     // Bit-serial (IMC) one bit-cycle: returns a TDC code per column for the given 0/1 mask.
-    std::vector<double> computeBitwise(const std::vector<std::vector<uint8_t>>& activationBits) const;
+    // The per-column trace (g_ann_imc_trace) goes to `trace`.
+    std::vector<double> computeBitwise(const std::vector<std::vector<uint8_t>>& activationBits, std::ostream& trace = std::cout) const;
 
     int rows() const { return m_rows; }
     int cols() const { return m_cols; }
@@ -169,9 +173,10 @@ public:
     explicit ANNNetwork(const NetworkParameters& params);
 
     // BaseNetwork interface (kept)
-    void run(std::ifstream& inputFile) override;  // no-op here
+    void run(std::istream& inputFile) override;  // no-op here
     //std::vector<int64_t> runIMCFromBitplaneFile(std::ifstream& in);
     void printNetworkToFile() override;           // simple stub
+    void collectTotals(std::map<std::string, double>& totals) override; // "pe<i>_mac" per PE
 
     // Convenience: digital vector run; one input per PE
     std::vector<float> run(const std::vector<std::vector<double>>& input);
@@ -192,4 +197,6 @@ private:
     int    m_annBitSerialBits = 0;
     int    m_annDsaOutBits = 0;
     bool   m_imcTrace = false;
+    std::vector<int64_t> m_lastMacs;  // IMC-MAC per PE of the last run()
+    std::shared_ptr<TaskScheduler> m_scheduler; // compute_threads != 1: one task per PE
 };
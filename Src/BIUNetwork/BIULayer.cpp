@@ -1,69 +1,339 @@
 #include "BIULayer.hpp"
 #include "EnergyTable.hpp"
+#include "../Common/Checkpoint.hpp"
+#include "../Common/Profiler.hpp"
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-BIULayer::BIULayer(int numNeurons, double vth, double vdd, double refractory, double cn, double cu, double cpara, double rleak, std::vector<std::vector<double>> weights, EnergyTable* energyTable)
-    : m_energyTable(energyTable)
+namespace {
+
+// The fixed-point neurons take the spikes packed once per layer instead of the inputs.
+template <typename Neuron>
+void storeInputs(Neuron& neuron, const std::vector<double>& inputs, const std::vector<std::uint8_t>&)
+{
+	neuron.setSynapticInputs(inputs);
+}
+
+void storeInputs(FixedBIUNeuron& neuron, const std::vector<double>& inputs, const std::vector<std::uint8_t>& spikes)
+{
+	neuron.setSynapticInputs(inputs, spikes.data());
+}
+
+} // namespace
+
+BIULayer::BIULayer(int numNeurons, double vth, double vdd, double refractory, double cn, double cu, double cpara, double rleak, const WeightMatrix& weights, EnergyTable* energyTable)
+    : m_weights(weights), m_energyTable(energyTable)
 {
 	for (int i = 0; i < numNeurons; ++i)
 	{
-		m_neurons.emplace_back(vth, vdd, refractory, cn, cu, cpara, rleak, weights[i], m_energyTable);
+		m_neurons.emplace_back(vth, vdd, refractory, cn, cu, cpara, rleak, m_weights[i], m_energyTable);
 	}
 }
 
-BIULayer::BIULayer(int numNeurons, double vdd, double cn, double cu, double cpara, std::vector<std::vector<double>> weights, EnergyTable * energyTable, const std::vector<double>&vthPerNeuron, const std::vector<int>&refractoryPerNeuron,  const std::vector<double>& rLeakPerNeuron)
-	 : m_energyTable(energyTable)
+BIULayer::BIULayer(int numNeurons, double vdd, double cpara, const WeightMatrix& weights, EnergyTable * energyTable, const std::vector<double>&vthPerNeuron, const std::vector<int>&refractoryPerNeuron,  const std::vector<double>& rLeakPerNeuron, const std::vector<double>& cnPerNeuron, const std::vector<double>& cuPerNeuron)
+	 : m_weights(weights), m_energyTable(energyTable)
 {
-	if ((int)vthPerNeuron.size() != numNeurons || (int)refractoryPerNeuron.size() != numNeurons || (int)rLeakPerNeuron.size() != numNeurons)
+	if ((int)vthPerNeuron.size() != numNeurons || (int)refractoryPerNeuron.size() != numNeurons || (int)rLeakPerNeuron.size() != numNeurons ||
+		(int)cnPerNeuron.size() != numNeurons || (int)cuPerNeuron.size() != numNeurons)
 	{
 		throw std::runtime_error("BIULayer: per-neuron vectors must match numNeurons.");
 	}
 	
 	for (int i = 0; i < numNeurons; ++i)
 	{
-		m_neurons.emplace_back(vthPerNeuron[i], vdd, (double)refractoryPerNeuron[i],cn, cu, cpara, rLeakPerNeuron[i], weights[i], m_energyTable);
+		m_neurons.emplace_back(vthPerNeuron[i], vdd, (double)refractoryPerNeuron[i], cnPerNeuron[i], cuPerNeuron[i], cpara, rLeakPerNeuron[i], m_weights[i], m_energyTable);
+	}
+}
+
+void BIULayer::setPrecision(Precision precision, const FixedPointFormat& format)
+{
+	if (precision == m_precision)
+		return;
+
+	toDouble_();
+	const size_t cols = m_weights.cols();
+	if (precision == Precision::Float)
+	{
+		m_weightsFloat = std::make_shared<const std::vector<float>>(m_weights.data(), m_weights.data() + m_weights.rows() * cols);
+		m_neuronsFloat.reserve(m_neurons.size());
+		for (size_t i = 0; i < m_neurons.size(); ++i)
+		{
+			m_neuronsFloat.emplace_back(m_neurons[i], BasicWeightRow<float>(m_weightsFloat->data() + i * cols, cols));
+		}
+		m_neurons.clear();
 	}
+	else if (precision == Precision::Fixed)
+	{
+		// The ratio tables cover every active sum S: from all inhibitory weights of a row
+		// spiking to all excitatory ones.
+		auto weights = std::make_shared<std::vector<std::int16_t>>(m_weights.rows() * cols);
+		std::int64_t minSum = 0, maxSum = 0;
+		for (size_t r = 0; r < m_weights.rows(); ++r)
+		{
+			std::int64_t inhibitory = 0, excitatory = 0;
+			for (size_t c = 0; c < cols; ++c)
+			{
+				const double w = m_weights[r][c];
+				if (!(w >= -32768.0 && w <= 32767.0) || w != std::floor(w))
+					throw std::runtime_error("BIULayer Error: fixed precision needs integer weights in -32768..32767 (got " + std::to_string(w) + ")");
+				(*weights)[r * cols + c] = static_cast<std::int16_t>(w);
+				(w < 0.0 ? inhibitory : excitatory) += static_cast<std::int64_t>(w);
+			}
+			minSum = std::min(minSum, inhibitory);
+			maxSum = std::max(maxSum, excitatory);
+		}
+		if (minSum < std::numeric_limits<std::int32_t>::min() || maxSum > std::numeric_limits<std::int32_t>::max())
+			throw std::runtime_error("BIULayer Error: fixed precision weight sums do not fit in 32 bits");
+		m_weightsFixed = weights;
+
+		FixedRatioCache cache(format, static_cast<std::int32_t>(minSum), static_cast<std::int32_t>(maxSum));
+		m_neuronsFixed.reserve(m_neurons.size());
+		for (size_t i = 0; i < m_neurons.size(); ++i)
+		{
+			m_neuronsFixed.emplace_back(m_neurons[i], FixedBIUNeuron::Row(m_weightsFixed->data() + i * cols, cols), format, cache);
+		}
+		m_neurons.clear();
+	}
+	m_precision = precision;
+	applyPatternLut_();
+}
+
+void BIULayer::setPatternLut(size_t maxInputs)
+{
+	if (maxInputs > BasicBIUPatternCache<double>::kMaxInputs)
+		throw std::invalid_argument("BIULayer: spike-pattern tables need at most 16 inputs per neuron.");
+	m_patternLutInputs = maxInputs;
+	applyPatternLut_();
+}
+
+void BIULayer::applyPatternLut_()
+{
+	const bool enabled = m_patternLutInputs > 0 && m_weights.cols() <= m_patternLutInputs;
+	auto apply = [enabled](auto& neurons, auto& cache) {
+		for (auto& neuron : neurons)
+			neuron.setPatternTable(enabled ? cache.get(neuron) : nullptr);
+	};
+	if (m_precision == Precision::Double)
+	{
+		BasicBIUPatternCache<double> cache;
+		apply(m_neurons, cache);
+	}
+	else if (m_precision == Precision::Float)
+	{
+		BasicBIUPatternCache<float> cache;
+		apply(m_neuronsFloat, cache);
+	}
+}
+
+void BIULayer::toDouble_()
+{
+	if (m_precision == Precision::Double)
+		return;
+
+	m_neurons.clear();
+	m_neurons.reserve(getLayerSize());
+	visit_([&](const auto& neurons) {
+		for (size_t i = 0; i < neurons.size(); ++i)
+		{
+			m_neurons.emplace_back(neurons[i], m_weights[i]);
+		}
+	});
+	m_neuronsFloat.clear();
+	m_neuronsFixed.clear();
+	m_weightsFloat.reset();
+	m_weightsFixed.reset();
+	m_precision = Precision::Double;
 }
 
 void BIULayer::setInputs(const std::vector<double>& inputs)
 {
-	for (size_t i = 0; i < m_neurons.size(); ++i)
+	if (m_precision == Precision::Fixed)
 	{
-		m_neurons[i].setSynapticInputs(inputs);
+		if (!m_weights.empty() && inputs.size() != m_weights.cols())
+			throw std::invalid_argument("Input size does not match synaptic weights size.");
+		m_inputSpikes.resize(inputs.size());
+		for (size_t i = 0; i < inputs.size(); ++i)
+			m_inputSpikes[i] = inputs[i] > 0.0 ? 1 : 0;
 	}
+
+	if (m_quiescentFastForward)
+	{
+		if (!m_weights.empty() && inputs.size() != m_weights.cols())
+			throw std::invalid_argument("Input size does not match synaptic weights size.");
+
+		m_inputSilent = std::none_of(inputs.begin(), inputs.end(), [](double x) { return x > 0.0; });
+		if (m_inputSilent)
+			return; // nothing reaches the synapses; the neurons replay this cycle later
+
+		visit_([&](auto& neurons) {
+			parallelFor(m_scheduler, neurons.size(), m_inputGrain, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					neurons[i].fastForward(m_cycle);
+					storeInputs(neurons[i], inputs, m_inputSpikes);
+				}
+			});
+		});
+		accumulateSynapticEnergy_();
+		return;
+	}
+
+	visit_([&](auto& neurons) {
+		parallelFor(m_scheduler, neurons.size(), m_inputGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				storeInputs(neurons[i], inputs, m_inputSpikes);
+			}
+		});
+	});
+	accumulateSynapticEnergy_();
 }
 
-std::vector<uint8_t> BIULayer::update()
+void BIULayer::accumulateSynapticEnergy_()
 {
-	std::vector<uint8_t> spikes;
-	spikes.reserve(m_neurons.size());
+	Profiler::Scope timer(Profiler::EnergyAccounting);
+	visit_([&](auto& neurons) {
+		parallelFor(m_scheduler, neurons.size(), m_energyGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				neurons[i].accumulateSynapticEnergy();
+			}
+		});
+	});
+}
 
-	for (auto& neuron : m_neurons) {
-		spikes.push_back(static_cast<uint8_t>(neuron.update()));
+std::uint64_t BIULayer::getRefractorySkips() const
+{
+	return visit_([](const auto& neurons) {
+		std::uint64_t sum = 0;
+		for (const auto& neuron : neurons) sum += neuron.getRefractorySkips();
+		return sum;
+	});
+}
+
+std::vector<uint8_t> BIULayer::update()
+{
+	if (m_quiescentFastForward && m_inputSilent)
+	{
+		// A silent cycle can never make a neuron fire.
+		++m_cycle;
+		return std::vector<uint8_t>(getLayerSize(), 0);
 	}
+
+	std::vector<uint8_t> spikes(getLayerSize());
+
+	visit_([&](auto& neurons) {
+		parallelFor(m_scheduler, neurons.size(), m_updateGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				spikes[i] = static_cast<uint8_t>(neurons[i].update());
+			}
+		});
+	});
+	++m_cycle;
 	return spikes;
 }
 
+void BIULayer::syncQuiescent()
+{
+	visit_([&](auto& neurons) {
+		for (auto& neuron : neurons)
+		{
+			neuron.fastForward(m_cycle);
+		}
+	});
+}
+
+void BIULayer::idle(std::uint64_t cycles)
+{
+	m_cycle += cycles;
+	if (!m_quiescentFastForward)
+		syncQuiescent();
+}
+
+bool BIULayer::isSettled(double tolerance) const
+{
+	// Neurons lagging in fast-forward mode only have decay/refractory countdown pending,
+	// so their stored state is a conservative bound.
+	return visit_([&](const auto& neurons) {
+		for (const auto& neuron : neurons)
+		{
+			if (neuron.isRefractory() || std::fabs(neuron.getVoltage()) >= tolerance)
+				return false;
+		}
+		return true;
+	});
+}
+
+void BIULayer::settle(std::uint64_t cycles)
+{
+	syncQuiescent();
+	visit_([&](auto& neurons) {
+		for (auto& neuron : neurons)
+		{
+			neuron.settle(cycles);
+		}
+	});
+	m_cycle += cycles;
+}
+
 unsigned int BIULayer::getLayerSize() const
 {
-	return m_neurons.size();
+	return visit_([](const auto& neurons) { return static_cast<unsigned int>(neurons.size()); });
 }
 
 double BIULayer::getTotalLayerSynapsesEnergy() const
 {
-    double sum = 0.0;
-    for (const auto& neuron : m_neurons) sum += neuron.getTotalSynapticEnergy();
-    return sum;
+	return visit_([](const auto& neurons) {
+		double sum = 0.0;
+		for (const auto& neuron : neurons) sum += neuron.getTotalSynapticEnergy();
+		return sum;
+	});
 }
 double BIULayer::getTotalLayerNeuronsEnergy() const
 {
-	double sum = 0.0;
-	for (const auto& neuron : m_neurons) sum += neuron.getNeuronEnergy();
-	return sum;
+	return visit_([](const auto& neurons) {
+		double sum = 0.0;
+		for (const auto& neuron : neurons) sum += neuron.getNeuronEnergy();
+		return sum;
+	});
 }
 double BIULayer::getTotalVINS() const
 {
-	double sum = 0.0;
-	for (const auto& neuron : m_neurons) sum += neuron.m_vin_sum;
-	return sum;
-}
\ No newline at end of file
+	return visit_([](const auto& neurons) {
+		double sum = 0.0;
+		for (const auto& neuron : neurons) sum += neuron.m_vin_sum;
+		return sum;
+	});
+}
+
+void BIULayer::saveState(SnapshotWriter& out) const
+{
+	out.put(m_cycle);
+	out.put(m_inputSilent);
+	out.put<std::uint64_t>(getLayerSize());
+	visit_([&](const auto& neurons) {
+		for (const auto& neuron : neurons) neuron.saveState(out);
+	});
+}
+
+void BIULayer::loadState(SnapshotReader& in)
+{
+	in.get(m_cycle);
+	in.get(m_inputSilent);
+	in.expectCount(getLayerSize(), "neurons per layer");
+	visit_([&](auto& neurons) {
+		for (auto& neuron : neurons) neuron.loadState(in);
+	});
+}
+
+void BIULayer::resetState()
+{
+	syncQuiescent();
+	visit_([&](auto& neurons) {
+		for (auto& neuron : neurons) neuron.resetState();
+	});
+	m_cycle = 0;
+	m_inputSilent = false;
+}
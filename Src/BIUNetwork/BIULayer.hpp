@@ -1,41 +1,119 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include "BIUNeuron.hpp"
+#include "FixedBIUNeuron.hpp"
+#include "../Common/Precision.hpp"
+#include "../Common/TaskScheduler.hpp"
 
 class EnergyTable; // Forward declaration
 
 class BIULayer
 {
+	// Calls f with the neuron vector of the current precision (defined ahead of the
+	// inline accessors below, which deduce their result from it).
+	template <typename F>
+	decltype(auto) visit_(F&& f)
+	{
+		return m_precision == Precision::Float ? f(m_neuronsFloat)
+			: m_precision == Precision::Fixed ? f(m_neuronsFixed) : f(m_neurons);
+	}
+	template <typename F>
+	decltype(auto) visit_(F&& f) const
+	{
+		return m_precision == Precision::Float ? f(m_neuronsFloat)
+			: m_precision == Precision::Fixed ? f(m_neuronsFixed) : f(m_neurons);
+	}
+	size_t checkIndex_(int index) const
+	{
+		if (index < 0 || index >= static_cast<int>(getLayerSize()))
+			throw std::out_of_range("BIULayer: neuron index out of range");
+		return static_cast<size_t>(index);
+	}
+
 public:
-	BIULayer(int numNeurons, double vth, double vdd, double refractory, double cn, double cu, double cpara, double rleak, std::vector<std::vector<double>> weights, EnergyTable* energyTable = nullptr);
-	BIULayer(int numNeurons, double vdd, double cn, double cu, double cpara, std::vector<std::vector<double>> weights, EnergyTable * energyTable, const std::vector<double>&vthPerNeuron, const std::vector<int>&refractoryPerNeuron, const std::vector<double>& rLeakPerNeuron);
+	BIULayer(int numNeurons, double vth, double vdd, double refractory, double cn, double cu, double cpara, double rleak, const WeightMatrix& weights, EnergyTable* energyTable = nullptr);
+	BIULayer(int numNeurons, double vdd, double cpara, const WeightMatrix& weights, EnergyTable * energyTable, const std::vector<double>&vthPerNeuron, const std::vector<int>&refractoryPerNeuron, const std::vector<double>& rLeakPerNeuron, const std::vector<double>& cnPerNeuron, const std::vector<double>& cuPerNeuron);
 	void setInputs(const std::vector<double>& inputs);
 	std::vector<uint8_t> update();
+	// Quiescent fast-forward: cycles without any input spike skip the synapses; each
+	// neuron replays the silent cycles one by one when it next receives input or is read.
+	void setQuiescentFastForward(bool enabled) { m_quiescentFastForward = enabled; }
+	// Numeric type of the neurons (see Precision.hpp). Float and Fixed convert the neurons,
+	// state included, and keep a float / integer copy of the weights; Fixed uses `format`
+	// and needs integer weights in -32768..32767.
+	void setPrecision(Precision precision, const FixedPointFormat& format = FixedPointFormat());
+	Precision getPrecision() const { return m_precision; }
+	// Spike-pattern tables (see BIUNeuron::setPatternTable) when the layer has at most
+	// `maxInputs` inputs per neuron (<= 16); 0 turns them off. Kept across setPrecision()
+	// for double and float; the fixed-point datapath has its own ratio tables.
+	void setPatternLut(size_t maxInputs);
+	// Per-cycle neuron loops (inputs, synaptic energy, update) in neuron ranges on
+	// `scheduler`; null = single-threaded. The results do not depend on it.
+	void setScheduler(TaskScheduler* scheduler) { m_scheduler = scheduler; }
+	// Bring every neuron (state, traces, energy) up to the layer's current cycle.
+	void syncQuiescent();
+	// Advance the layer through `cycles` cycles without input spikes (exact).
+	void idle(std::uint64_t cycles);
+	// True when no neuron is refractory and every |Vn| is below tolerance.
+	bool isSettled(double tolerance) const;
+	// Closed-form counterpart of idle() for a settled layer (approximate, see BIUNeuron::settle).
+	void settle(std::uint64_t cycles);
+	// Checkpoint / resume
+	void saveState(SnapshotWriter& out) const;
+	void loadState(SnapshotReader& in);
+	// Every neuron back to its initial state and the cycle count to 0, after the pending
+	// quiescent cycles are applied; energies and unwritten traces are kept.
+	void resetState();
 	std::vector<double> getVns(int index) const
 	{
-		if (index < 0 || index >= static_cast<int>(m_neurons.size()))
-			throw std::out_of_range("BIULayer: neuron index out of range");
-		return m_neurons[index].getVns();
+		return visit_([&](const auto& neurons) { return neurons[checkIndex_(index)].getVns(); });
 	}
 	std::vector<double> getSpikesVec(int index) const
 	{
-		if (index < 0 || index >= static_cast<int>(m_neurons.size()))
-			throw std::out_of_range("BIULayer: neuron index out of range");
-		return m_neurons[index].getSpikesVec();
+		return visit_([&](const auto& neurons) { return neurons[checkIndex_(index)].getSpikesVec(); });
 	}
 	std::vector<double> getVinVec(int index) const
 	{
-		if (index < 0 || index >= static_cast<int>(m_neurons.size()))
-			throw std::out_of_range("BIULayer: neuron index out of range");
-		return m_neurons[index].getVinVec();
+		return visit_([&](const auto& neurons) { return neurons[checkIndex_(index)].getVinVec(); });
+	}
+	void setRecording(int index, const ProbeRecording& recording)
+	{
+		visit_([&](auto& neurons) { neurons[checkIndex_(index)].setRecording(recording); });
+	}
+	const ProbeRecording& getRecording(int index) const
+	{
+		return visit_([&](const auto& neurons) -> const ProbeRecording& { return neurons[checkIndex_(index)].getRecording(); });
+	}
+	void takeTraces(int index, std::vector<double>& vns, std::vector<double>& spikes, std::vector<double>& vins)
+	{
+		visit_([&](auto& neurons) { neurons[checkIndex_(index)].takeTraces(vns, spikes, vins); });
 	}
 	unsigned int getLayerSize() const;
 	double getTotalLayerSynapsesEnergy() const;
 	double getTotalLayerNeuronsEnergy() const;
 	double getTotalVINS() const;
+	std::uint64_t getRefractorySkips() const;
 private:
-	std::vector<BIUNeuron> m_neurons;
+	WeightMatrix m_weights;      // [neurons][inputs]; the neurons read their rows from it
+	Precision m_precision = Precision::Double;
+	std::vector<BIUNeuron> m_neurons;                   // Precision::Double
+	std::vector<BasicBIUNeuron<float>> m_neuronsFloat;  // Precision::Float
+	std::vector<FixedBIUNeuron> m_neuronsFixed;         // Precision::Fixed
+	std::shared_ptr<const std::vector<float>> m_weightsFloat; // float copy of m_weights, shared by copies (Float only)
+	std::shared_ptr<const std::vector<std::int16_t>> m_weightsFixed; // integer copy (Fixed only)
+	std::vector<std::uint8_t> m_inputSpikes; // spikes of the last setInputs(), 0 / 1 (Fixed only)
     EnergyTable* m_energyTable = nullptr;
+	bool m_quiescentFastForward = false;
+	size_t m_patternLutInputs = 0; // setPatternLut()
+	TaskScheduler* m_scheduler = nullptr;
+	ParallelGrain m_inputGrain, m_energyGrain, m_updateGrain; // per-neuron cost of each loop
+	bool m_inputSilent = false;  // last setInputs() carried no spike (fast-forward mode only)
+	std::uint64_t m_cycle = 0;   // cycles this layer has been updated for
+	void accumulateSynapticEnergy_();
+	void toDouble_();
+	void applyPatternLut_();
 };
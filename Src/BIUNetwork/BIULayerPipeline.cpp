@@ -0,0 +1,101 @@
+#include "BIULayerPipeline.hpp"
+#include "../Common/Profiler.hpp"
+
+BIULayerPipeline::BIULayerPipeline(std::vector<BIULayer>& layers, std::vector<std::uint64_t>* layerNs, std::size_t depth)
+	: m_layers(layers), m_layerNs(layerNs), m_errors(layers.size())
+{
+	for (std::size_t l = 0; l <= m_layers.size(); ++l)
+		m_rings.emplace_back(new SpscRing<Wave>(depth));
+	for (std::size_t l = 0; l < m_layers.size(); ++l)
+		m_workers.emplace_back(&BIULayerPipeline::work_, this, l);
+}
+
+BIULayerPipeline::~BIULayerPipeline()
+{
+	m_stop.store(true, std::memory_order_release);
+	for (auto& ring : m_rings)
+		ring->interrupt(); // workers asleep on an empty or full ring
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+void BIULayerPipeline::work_(std::size_t layer)
+{
+	SpscRing<Wave>& in = *m_rings[layer];
+	SpscRing<Wave>& out = *m_rings[layer + 1];
+	const auto stopped = [this] { return m_stop.load(std::memory_order_acquire); };
+	std::vector<double> inputs;
+	Wave wave;
+	for (;;)
+	{
+		// idle workers sleep in the ring between lines instead of spinning
+		if (!in.pop(wave, stopped))
+			return;
+
+		if (!wave.failed)
+		{
+			const std::uint64_t start = m_layerNs ? Profiler::now() : 0;
+			try
+			{
+				if (layer == 0)
+				{
+					m_layers[0].setInputs(wave.inputs);
+				}
+				else
+				{
+					const std::vector<uint8_t>& previous = wave.spikes.back();
+					inputs.assign(previous.begin(), previous.end());
+					m_layers[layer].setInputs(inputs);
+				}
+				wave.spikes.push_back(m_layers[layer].update());
+			}
+			catch (...)
+			{
+				m_errors[layer] = std::current_exception();
+				wave.failed = true;
+			}
+			if (m_layerNs) (*m_layerNs)[layer] += Profiler::now() - start;
+		}
+
+		if (!out.push(std::move(wave), m_stop))
+			return;
+	}
+}
+
+bool BIULayerPipeline::trySubmit(std::vector<double>& inputs)
+{
+	Wave wave;
+	wave.inputs.swap(inputs);
+	wave.spikes.reserve(m_layers.size());
+	if (!m_rings.front()->tryPush(std::move(wave)))
+	{
+		inputs.swap(wave.inputs);
+		return false;
+	}
+	++m_inFlight;
+	return true;
+}
+
+bool BIULayerPipeline::tryTake(Wave& wave)
+{
+	if (!m_rings.back()->tryPop(wave))
+		return false;
+	--m_inFlight;
+	check_(wave);
+	return true;
+}
+
+void BIULayerPipeline::take(Wave& wave)
+{
+	m_rings.back()->pop(wave);
+	--m_inFlight;
+	check_(wave);
+}
+
+void BIULayerPipeline::check_(const Wave& wave)
+{
+	if (!wave.failed)
+		return;
+	for (const auto& error : m_errors)
+		if (error) std::rethrow_exception(error);
+}
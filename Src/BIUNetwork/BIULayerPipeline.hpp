@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * @file BIULayerPipeline.hpp
+ * @brief Wavefront execution of the layers of a BIU network across consecutive cycles.
+ *
+ * Every layer runs on its own worker thread. The workers are chained by bounded SpscRings
+ * that carry one Wave per cycle: the layer-0 inputs and the spikes of every layer so far.
+ * Layer l consumes the spikes layer l-1 produced in the same cycle, exactly as
+ * BIUNetwork::update() does, but layer 0 can already work on cycle t+1 while layer 1 is
+ * still on cycle t. The results are the same as sequential execution.
+ *
+ * While waves are in flight the layers belong to the workers: the owner must take() every
+ * submitted wave (inFlight() == 0) before it reads or changes a layer (traces, energies,
+ * early exit, checkpoints). An exception thrown by a layer is rethrown by take().
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BIULayer.hpp"
+#include "../Common/SpscRing.hpp"
+
+class BIULayerPipeline
+{
+public:
+	struct Wave
+	{
+		std::vector<double> inputs;               // layer-0 inputs of the cycle
+		std::vector<std::vector<uint8_t>> spikes; // one entry per layer done so far
+		bool failed = false;                      // a layer threw; see take()
+	};
+
+	// layerNs: per-layer update times (Profiler), or nullptr when not profiling.
+	BIULayerPipeline(std::vector<BIULayer>& layers, std::vector<std::uint64_t>* layerNs, std::size_t depth);
+	~BIULayerPipeline();
+	BIULayerPipeline(const BIULayerPipeline&) = delete;
+	BIULayerPipeline& operator=(const BIULayerPipeline&) = delete;
+
+	// Queues the next cycle; false when the first ring is full (take a wave and retry).
+	bool trySubmit(std::vector<double>& inputs);
+	// Oldest finished wave, in submission order; false if none is finished yet.
+	bool tryTake(Wave& wave);
+	// Waits for the oldest wave in flight (there must be one).
+	void take(Wave& wave);
+	std::size_t inFlight() const { return m_inFlight; }
+
+private:
+	std::vector<BIULayer>& m_layers;
+	std::vector<std::uint64_t>* m_layerNs;
+	std::vector<std::unique_ptr<SpscRing<Wave>>> m_rings; // ring l feeds layer l; the last one the owner
+	std::vector<std::exception_ptr> m_errors;             // per layer, set before the wave is forwarded
+	std::vector<std::thread> m_workers;
+	std::atomic<bool> m_stop{ false };
+	std::size_t m_inFlight = 0;
+
+	void work_(std::size_t layer);
+	void check_(const Wave& wave);
+};
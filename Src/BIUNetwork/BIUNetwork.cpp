@@ -1,12 +1,49 @@
 #include "BIUNetwork.hpp"
 #include "EnergyTable.hpp"
+#include "../Common/Profiler.hpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <thread>
 
-// One log file per DS unit: DS_0, DS_1, ...
-static std::vector<std::ofstream> s_dsLogs;
+void BIUNetwork::parseInputLine(const std::string& line, std::size_t lineNumber, std::vector<double>& values)
+{
+    std::istringstream iss(line);
+    double v;
+    while (iss >> v)
+    {
+        if (!std::isfinite(v))
+        {
+            throw std::runtime_error("BIUNetwork Error: Invalid input value at line " + 
+                                    std::to_string(lineNumber) + " (NaN or Inf detected)");
+        }
+        values.push_back(v);
+    }
+    
+    if (values.empty() && !line.empty())
+    {
+        throw std::runtime_error("BIUNetwork Error: Failed to parse values from line " + 
+                                std::to_string(lineNumber));
+    }
+}
+
+// Monte Carlo trial: scale the per-neuron constants of `layer` by their device factors.
+static void applyDeviceVariation(const DeviceVariation& variation, size_t layer, std::vector<double>& vth,
+                                 std::vector<double>& rLeak, std::vector<double>& cn, std::vector<double>& cu)
+{
+    if (!variation.enabled())
+        return;
+    for (size_t n = 0; n < vth.size(); ++n)
+    {
+        vth[n]   *= variation.factor(DeviceVariation::VTh, variation.sigmaVTh, layer, n);
+        rLeak[n] *= variation.factor(DeviceVariation::RLeak, variation.sigmaRLeak, layer, n);
+        cn[n]    *= variation.factor(DeviceVariation::Cn, variation.sigmaCn, layer, n);
+        cu[n]    *= variation.factor(DeviceVariation::Cu, variation.sigmaCu, layer, n);
+    }
+}
 
 BIUNetwork::BIUNetwork(NetworkParameters params)
 {
@@ -14,8 +51,14 @@ BIUNetwork::BIUNetwork(NetworkParameters params)
     m_dsBitWidth = static_cast<unsigned int>(params.DSBitWidth);
     m_dsMode     = params.DSMode;
     m_verbosity  = params.verbosity; // NEW
-
-    m_energyTable = new EnergyTable();
+    m_earlyExitMode      = params.biuEarlyExitMode;
+    m_earlyExitTolerance = params.biuEarlyExitTolerance;
+    m_layerPipelineEnabled = params.biuLayerPipeline;
+    m_resetEveryLines = static_cast<std::size_t>(params.resetEveryLines);
+    if (params.computeThreads != 1)
+        m_scheduler = std::make_shared<TaskScheduler>(static_cast<unsigned>(params.computeThreads));
+
+    m_energyTable = params.energyTable ? params.energyTable : loadEnergyTable(params);
     if (!params.allWeights.empty() && !params.allWeights[0].empty())
     {
         size_t inputCount = params.allWeights[0][0].size(); // number of inputs per neuron
@@ -29,80 +72,120 @@ BIUNetwork::BIUNetwork(NetworkParameters params)
              params.biuNeuronRefractory[i].size() == (size_t)params.layerSizes[i] &&
              params.biuNeuronRLeak[i].size() == (size_t)params.layerSizes[i]);
 
-        if (havePerNeuron)
+        if (havePerNeuron || params.variation.enabled())
         {
-            m_vecLayers.emplace_back(params.layerSizes[i], params.VDD, params.Cn, params.Cu, params.CPara,
-                                     params.allWeights[i], m_energyTable,
-                                     params.biuNeuronVTh[i], params.biuNeuronRefractory[i], params.biuNeuronRLeak[i]);
+            const size_t n = static_cast<size_t>(params.layerSizes[i]);
+            std::vector<double> vth(n, params.VTh), rLeak(n, params.Rleak), cn(n, params.Cn), cu(n, params.Cu);
+            std::vector<int> refractory(n, static_cast<int>(params.refractory));
+            if (havePerNeuron)
+            {
+                vth = params.biuNeuronVTh[i];
+                refractory = params.biuNeuronRefractory[i];
+                rLeak = params.biuNeuronRLeak[i];
+            }
+            applyDeviceVariation(params.variation, i, vth, rLeak, cn, cu);
+
+            m_vecLayers.emplace_back(params.layerSizes[i], params.VDD, params.CPara,
+                                     params.allWeights[i], m_energyTable.get(),
+                                     vth, refractory, rLeak, cn, cu);
         }
         else
         {
             m_vecLayers.emplace_back(params.layerSizes[i], params.VTh, params.VDD, params.refractory,
                                      params.Cn, params.CPara, params.Cu, params.Rleak,
-                                     params.allWeights[i], m_energyTable);
+                                     params.allWeights[i], m_energyTable.get());
         }
+        m_vecLayers.back().setQuiescentFastForward(params.biuQuiescentFastForward);
+        m_vecLayers.back().setPrecision(params.precision, params.fixedPoint);
+        m_vecLayers.back().setPatternLut(static_cast<size_t>(params.biuPatternLutInputs));
+        m_vecLayers.back().setScheduler(m_scheduler.get());
     }
+
+    // Traces kept per neuron: the probed ones, else spikes (and Vn, Vin in Debug) of all
+    m_hasProbes = !params.probes.empty();
+    const auto recordings = resolveProbes(params.probes, params.layerSizes,
+        m_verbosity == Verbosity::Debug ? ProbeRecording::all() : ProbeRecording::spikesOnly());
+    for (size_t l = 0; l < m_vecLayers.size(); ++l)
+        for (size_t n = 0; n < recordings[l].size(); ++n)
+            m_vecLayers[l].setRecording(static_cast<int>(n), recordings[l][n]);
+}
+
+std::shared_ptr<EnergyTable> BIUNetwork::loadEnergyTable(const NetworkParameters& params)
+{
+    std::shared_ptr<EnergyTable> table = std::make_shared<EnergyTable>();
     if (!params.synapsesEnergyCsvPath.empty())
     {
-        if (!m_energyTable->loadSynapseEnergyCSV(params.synapsesEnergyCsvPath)) {
+        if (!table->loadSynapseEnergyCSV(params.synapsesEnergyCsvPath)) {
             throw std::runtime_error("Failed to load synapses energy table from: " + params.synapsesEnergyCsvPath);
         }
     }
     if (!params.neuronEnergyCsvPath.empty())
     {
-        if (!m_energyTable->loadNeuronEnergyCSV(params.neuronEnergyCsvPath)) {
+        if (!table->loadNeuronEnergyCSV(params.neuronEnergyCsvPath)) {
             throw std::runtime_error("Failed to load neuron energy table from: " + params.neuronEnergyCsvPath);
         }
     }
+    return table;
 }
 
-BIUNetwork::~BIUNetwork()
-{
-    delete m_energyTable;
-    m_energyTable = nullptr;
-}
-
-void BIUNetwork::run(std::ifstream& inputFile)
+void BIUNetwork::run(std::istream& inputFile)
 {
-    if (!inputFile.is_open()) {
-        throw std::runtime_error("BIUNetwork Error: Input file is not open");
+    if (!inputFile) {
+        throw std::runtime_error("BIUNetwork Error: Input stream is not readable");
     }
 
-    const std::size_t totalLines = countLines(inputFile);
-
-    std::string line;
-    std::size_t currentLine = 0;
-
-    while (std::getline(inputFile, line))
+    std::vector<std::size_t> layerSizes;
+    for (const auto& layer : m_vecLayers) layerSizes.push_back(layer.getLayerSize());
+    startSpikeStats_(layerSizes, m_dsClockMHz > 0.0 ? 1e-6 / m_dsClockMHz : 0.0);
+    if ((m_spikeStats || m_readoutOptions.mode != ReadoutMode::Off) && !m_hasProbes)
     {
-        ++currentLine;
+        // the statistics / readout replace the traces; probes still select some explicitly
+        for (auto& layer : m_vecLayers)
+            for (unsigned int n = 0; n < layer.getLayerSize(); ++n)
+                layer.setRecording(static_cast<int>(n), ProbeRecording());
+    }
 
-        // Parse raw values for this line (digital codes for DS)
-        std::istringstream iss(line);
-        std::vector<double> values;
-        double v;
-        while (iss >> v)
-        {
-            if (!std::isfinite(v))
-            {
-                throw std::runtime_error("BIUNetwork Error: Invalid input value at line " + 
-                                        std::to_string(currentLine) + " (NaN or Inf detected)");
-            }
-            values.push_back(v);
-        }
-        
-        if (values.empty() && !line.empty())
-        {
-            throw std::runtime_error("BIUNetwork Error: Failed to parse values from line " + 
-                                    std::to_string(currentLine));
-        }
+    if (streamsTraces_())
+        openTraceFiles_();
+    startReadout_(layerSizes.empty() ? 0 : layerSizes.back());
+    const std::size_t resumedLines = resumeFromCheckpoint_(inputFile);
+    m_traceWriter.start(m_pipeline);
+
+    ProgressReporter progress(m_progress, inputFile);
+    LineReader reader(inputFile, parseInputLine, m_pipeline, resumedLines, inputOffsetEvery_());
+    InputLine input;
+    m_linesRun = 0;
+    m_spikeCount = 0;
+    if (Profiler::enabled())
+        m_layerNs.assign(m_vecLayers.size(), 0);
+
+    // Wavefront mode: the layers run on their own threads during the DS-gated cycles
+    std::unique_ptr<BIULayerPipeline> layerPipeline;
+    if (m_layerPipelineEnabled && !m_dsUnits.empty() && !m_vecLayers.empty())
+        layerPipeline.reset(new BIULayerPipeline(m_vecLayers, m_layerNs.empty() ? nullptr : &m_layerNs,
+                                                 DS::patternCycles(m_dsBitWidth)));
+
+    while (reader.next(input))
+    {
+        ++m_linesRun;
+        const std::vector<double>& values = input.values;
+        if (resetDue_(input)) resetState_();
 
         // If no DS front-end, fall back to original single-step behavior.
         if (m_dsUnits.empty())
         {
             setInputs(values);      // original path
             update();
-            showProgressBar(currentLine, totalLines);
+            if (m_spikeStats) m_spikeStats->endLine();
+            if (m_readout)
+            {
+                TraceWriter::Batch row;
+                m_readout->endLine(input.number, row);
+                m_traceWriter.submit(std::move(row));
+            }
+            if (streamsTraces_()) streamTraces_();
+            checkpointIfDue_(input);
+            progress.lineDone(input);
             continue;
         }
 
@@ -118,37 +201,72 @@ void BIUNetwork::run(std::ifstream& inputFile)
             m_dsUnits[i].setCode(clampToCode_(values[i]));
         }
 
-        // Gating loop: keep ticking until safety limit reached
-        const std::size_t maxSafetyCycles = 32; // safety cap
+        // Gating loop: one DS pattern period per line
+        const std::size_t maxSafetyCycles = m_dsUnits.front().getPatternCycles();
         std::size_t cycles = 0;
 
-        while (true)
-        {
-            std::vector<double> dsOut;
-            dsOut.reserve(m_dsUnits.size());
-           
+        // Number of leading cycles of this line in which some DS unit still fires;
+        // past it the front-end is silent for the rest of the line.
+        std::size_t activeCycles = maxSafetyCycles;
+        if (m_earlyExitMode != EarlyExitMode::Off)
+            activeCycles = m_dsKernels->activeCycles(m_dsUnits.data(), m_dsUnits.size(),
+                                                     static_cast<unsigned int>(maxSafetyCycles));
 
-            // Tick each DS; record first spike occurrence.
-            for (size_t i = 0; i < m_dsUnits.size(); ++i)
+        while (cycles < maxSafetyCycles)
+        {
+            if (cycles >= activeCycles)
             {
-                bool spk = m_dsUnits[i].tick();
-                dsOut.push_back(spk ? 1.0 : 0.0);
+                if (layerPipeline) drainWaves_(*layerPipeline); // the layers are read and advanced
+                if (skipSilentCycles_(maxSafetyCycles - cycles))
+                    break;
             }
 
-            setInputs(dsOut);
-            update();
+            std::vector<double> dsOut(m_dsUnits.size());
+
+            // Tick each DS (the bank kernel of the bit width, chosen once per network)
+            {
+                Profiler::Scope timer(Profiler::DsTick);
+                m_dsKernels->tick(m_dsUnits.data(), m_dsUnits.size(), dsOut.data());
+            }
 
-            if (++cycles >= maxSafetyCycles)
+            if (layerPipeline)
             {
-                break;
+                recordDsOutputs_(dsOut);
+                submitWave_(*layerPipeline, dsOut);
             }
+            else
+            {
+                setInputs(dsOut);
+                update();
+            }
+            ++cycles;
+        }
+        if (layerPipeline) drainWaves_(*layerPipeline);
+        m_simulatedCycles += cycles;
+        ++m_gatedLines;
+        if (m_spikeStats)
+        {
+            m_spikeStats->endCycle(maxSafetyCycles - cycles); // replayed by skipSilentCycles_
+            m_spikeStats->endLine();
         }
+        if (m_readout) m_readout->endLine(input.number, m_dsBatch);
 
-        showProgressBar(currentLine, totalLines);
+        m_traceWriter.submit(std::move(m_dsBatch));
+        resetDsBatch_();
+        if (streamsTraces_()) streamTraces_();
+        checkpointIfDue_(input);
+        progress.lineDone(input, cycles);
     }
+    layerPipeline.reset();
+    progress.finish();
 
     std::cout << "\nFinished executing.\n";
-    inputFile.close();
+
+    // Apply any pending quiescent cycles before traces and energy are read.
+    for (auto& layer : m_vecLayers) layer.syncQuiescent();
+    m_traceWriter.close();
+    finishSpikeStats_();
+    finishReadout_();
 
     auto totalSynapsesEnergy = getTotalSynapsesEnergy();
     std::cout << "Total synaptic energy: " << totalSynapsesEnergy << " fJ" << '\n';
@@ -159,19 +277,25 @@ void BIUNetwork::run(std::ifstream& inputFile)
     auto totalspk = getTotalspikes();
     std::cout << "Total spike ins: " << totalspk << " " << '\n';
 
+    if (m_earlyExitMode != EarlyExitMode::Off && m_gatedLines > 0)
+    {
+        std::cout << "Average simulated cycles per line: "
+                  << static_cast<double>(m_simulatedCycles) / static_cast<double>(m_gatedLines)
+                  << " (of " << DS::patternCycles(m_dsBitWidth) << ")" << '\n';
+    }
+
+    if (Profiler::enabled())
+        reportProfile_();
+
 
 }
 
 void BIUNetwork::setInputs(const std::vector<double>& inputs)
 {
+    const std::uint64_t start = m_layerNs.empty() ? 0 : Profiler::now();
     if (!m_vecLayers.empty() && !m_dsUnits.empty())
     {
-        const size_t n = std::min(inputs.size(), m_dsUnits.size());
-        
-        for (size_t i = 0; i < n; ++i)
-        {
-            s_dsLogs[i] << (inputs[i] ? 1 : 0) << '\n';
-        }
+        recordDsOutputs_(inputs);
         m_vecLayers[0].setInputs(inputs);
     }
     else
@@ -179,13 +303,16 @@ void BIUNetwork::setInputs(const std::vector<double>& inputs)
         if (!m_vecLayers.empty())
             m_vecLayers[0].setInputs(inputs);
     }
+    if (!m_layerNs.empty()) m_layerNs[0] += Profiler::now() - start;
 }
 
 std::vector<std::vector<uint8_t>> BIUNetwork::update()
 {
     std::vector<std::vector<uint8_t>> allSpikes;
+    const bool profiling = !m_layerNs.empty();
     for (size_t i = 0; i < m_vecLayers.size(); ++i)
     {
+        const std::uint64_t start = profiling ? Profiler::now() : 0;
         if (i > 0)
         {
             std::vector<double> inputs;
@@ -195,49 +322,138 @@ std::vector<std::vector<uint8_t>> BIUNetwork::update()
             m_vecLayers[i].setInputs(inputs);
         }
         auto spikes = m_vecLayers[i].update();
+        if (profiling)
+        {
+            m_layerNs[i] += Profiler::now() - start;
+            m_spikeCount += static_cast<std::uint64_t>(std::count(spikes.begin(), spikes.end(), 1));
+        }
         allSpikes.push_back(spikes);
     }
+    recordCycle_(allSpikes);
     return allSpikes;
 }
 
+void BIUNetwork::recordDsOutputs_(const std::vector<double>& outputs)
+{
+    const size_t n = std::min(outputs.size(), m_dsUnits.size());
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_dsBatch[i].values.push_back(outputs[i] ? 1 : 0);
+    }
+}
+
+// Per-cycle bookkeeping of update(), on the spikes of every layer
+void BIUNetwork::recordCycle_(const std::vector<std::vector<uint8_t>>& allSpikes)
+{
+    if (m_spikeStats) m_spikeStats->recordCycle(allSpikes);
+    if (m_readout && !allSpikes.empty())
+    {
+        const std::vector<uint8_t>& output = allSpikes.back();
+        for (size_t n = 0; n < output.size(); ++n)
+            if (output[n]) m_readout->recordSpike(n);
+        m_readout->endCycle();
+    }
+}
+
+// ===== Layer pipeline (see BIULayerPipeline.hpp) =====
+void BIUNetwork::submitWave_(BIULayerPipeline& pipeline, std::vector<double>& layerInputs)
+{
+    BIULayerPipeline::Wave wave;
+    while (!pipeline.trySubmit(layerInputs))
+    {
+        if (pipeline.tryTake(wave))
+            finishWave_(wave);
+        else
+            std::this_thread::yield();
+    }
+    while (pipeline.tryTake(wave))
+        finishWave_(wave);
+}
+
+void BIUNetwork::drainWaves_(BIULayerPipeline& pipeline)
+{
+    BIULayerPipeline::Wave wave;
+    while (pipeline.inFlight() > 0)
+    {
+        pipeline.take(wave);
+        finishWave_(wave);
+    }
+}
+
+void BIUNetwork::finishWave_(const BIULayerPipeline::Wave& wave)
+{
+    if (!m_layerNs.empty())
+    {
+        for (const auto& spikes : wave.spikes)
+            m_spikeCount += static_cast<std::uint64_t>(std::count(spikes.begin(), spikes.end(), 1));
+    }
+    recordCycle_(wave.spikes);
+}
+
+void BIUNetwork::reportProfile_()
+{
+    std::uint64_t layerTotal = 0, refractorySkips = 0;
+    for (std::uint64_t ns : m_layerNs) layerTotal += ns;
+    for (const auto& layer : m_vecLayers) refractorySkips += layer.getRefractorySkips();
+
+    Profiler::addLayerTimes(m_layerNs);
+    Profiler::addTime(Profiler::LayerUpdate, layerTotal);
+    Profiler::addCount(Profiler::InputLines, m_linesRun);
+    Profiler::addCount(Profiler::Cycles, m_dsUnits.empty() ? m_linesRun : m_simulatedCycles);
+    Profiler::addCount(Profiler::Spikes, m_spikeCount);
+    Profiler::addCount(Profiler::SynapticEvents, static_cast<std::uint64_t>(getTotalspikes()));
+    Profiler::addCount(Profiler::RefractorySkips, refractorySkips);
+}
+
 void BIUNetwork::printNetworkToFile()
 {
+    if (streamsTraces_())
+        return; // traces were streamed to their files during run()
+
     for (size_t layerIdx = 0; layerIdx < m_vecLayers.size(); ++layerIdx)
     {
         size_t numNeurons = m_vecLayers[layerIdx].getLayerSize();
 
         for (size_t neuronIdx = 0; neuronIdx < numNeurons; ++neuronIdx)
         {
-            std::string spikesFile = "spikes_" + std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
+            // only the quantities this neuron records (all spikes, plus Vn and Vin in Debug,
+            // unless probes select otherwise)
+            const ProbeRecording& recording = m_vecLayers[layerIdx].getRecording(neuronIdx);
+            const std::string suffix = std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
 
-            if (m_verbosity == Verbosity::Debug)
+            if (recording.vn)
             {
-                std::vector<double> Vns    = m_vecLayers[layerIdx].getVns(neuronIdx);
-                std::vector<double> spikes = m_vecLayers[layerIdx].getSpikesVec(neuronIdx);
-                std::vector<double> Vin    = m_vecLayers[layerIdx].getVinVec(neuronIdx);
-
-                std::string vnsFile = "vns_" + std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
-                std::string vinFile = "vin_" + std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
-
-                std::ofstream vnsOut(vnsFile);
-                std::ofstream spikesOut(spikesFile);
-                std::ofstream vinOut(vinFile);
-
-                if (vnsOut.is_open())    for (const auto& v : Vns)    vnsOut << v << '\n';
-                if (spikesOut.is_open()) for (const auto& s : spikes) spikesOut << s << '\n';
-                if (vinOut.is_open())    for (const auto& x : Vin)    vinOut << x << '\n';
+                std::vector<double> Vns = m_vecLayers[layerIdx].getVns(neuronIdx);
+                std::ofstream vnsOut("vns_" + suffix);
+                if (vnsOut.is_open()) for (const auto& v : Vns) vnsOut << v << '\n';
             }
-            else
+            if (recording.spikes)
             {
-                // Info: only spikes
                 std::vector<double> spikes = m_vecLayers[layerIdx].getSpikesVec(neuronIdx);
-                std::ofstream spikesOut(spikesFile);
+                std::ofstream spikesOut("spikes_" + suffix);
                 if (spikesOut.is_open()) for (const auto& s : spikes) spikesOut << s << '\n';
             }
+            if (recording.vin)
+            {
+                std::vector<double> Vin = m_vecLayers[layerIdx].getVinVec(neuronIdx);
+                std::ofstream vinOut("vin_" + suffix);
+                if (vinOut.is_open()) for (const auto& x : Vin) vinOut << x << '\n';
+            }
         }
     }
 }
 
+void BIUNetwork::collectTotals(std::map<std::string, double>& totals)
+{
+    totals["synaptic_energy_fJ"] = getTotalSynapsesEnergy();
+    totals["neuron_energy_fJ"] = getTotalNeuronsEnergy();
+    totals["spike_ins"] = getTotalspikes();
+    if (m_gatedLines > 0)
+        totals["simulated_cycles_per_line"] = static_cast<double>(m_simulatedCycles) / static_cast<double>(m_gatedLines);
+    if (m_readout && m_readout->hasLabels())
+        totals["readout_accuracy"] = m_readout->accuracy();
+}
+
 double BIUNetwork::getTotalNeuronsEnergy()
 {
     double sum = 0.0;
@@ -259,25 +475,132 @@ double BIUNetwork::getTotalspikes()
     return sum;
 }
 
+// ===== Early exit of the gating loop =====
+// Called once the DS front-end is silent for the remaining `cycles` of the line. Since a
+// layer without input spikes cannot fire, the whole network only decays from here on.
+// Strict: replay the cycles exactly (bit-identical). Tolerance: only once the network has
+// settled (nothing refractory, all |Vn| below tolerance), apply the closed-form decay.
+bool BIUNetwork::skipSilentCycles_(std::size_t cycles)
+{
+    if (m_earlyExitMode == EarlyExitMode::Off)
+        return false;
+
+    if (m_earlyExitMode == EarlyExitMode::Tolerance)
+    {
+        for (const auto& layer : m_vecLayers)
+        {
+            if (!layer.isSettled(m_earlyExitTolerance))
+                return false;
+        }
+    }
+
+    for (size_t i = 0; i < m_dsUnits.size(); ++i)
+    {
+        m_dsUnits[i].advance(static_cast<unsigned int>(cycles));
+        m_dsBatch[i].values.insert(m_dsBatch[i].values.end(), cycles, 0.0);
+    }
+
+    for (auto& layer : m_vecLayers)
+    {
+        if (m_earlyExitMode == EarlyExitMode::Strict)
+            layer.idle(cycles);
+        else
+            layer.settle(cycles);
+    }
+    return true;
+}
+
+// reset_every_lines: the DS units and layers start the line as if the network were new
+void BIUNetwork::resetState_()
+{
+    for (auto& ds : m_dsUnits) ds.reset();
+    for (auto& layer : m_vecLayers) layer.resetState();
+}
+
 // ===== Helpers for DS front-end =====
 void BIUNetwork::initFrontEndDS_(size_t inputCount)
 {
     m_dsUnits.clear();
     m_dsUnits.reserve(inputCount);
+    m_dsKernels = &DS::bankKernels(m_dsBitWidth);
 
-    // (Re)open log files
-    s_dsLogs.clear();
-    s_dsLogs.resize(inputCount);
+    // One log file per DS unit: DS_0, DS_1, ... (created now, in the launch directory)
+    m_dsLogIds.clear();
+    m_dsLogIds.reserve(inputCount);
     for (size_t i = 0; i < inputCount; ++i)
     {
         m_dsUnits.emplace_back(m_dsClockMHz, m_dsBitWidth, m_dsMode);
         m_dsUnits.back().setCode(0);
-        s_dsLogs[i].open("DS_" + std::to_string(i), std::ios::out | std::ios::trunc);
-        if (!s_dsLogs[i].is_open())
-            std::cerr << "Warning: could not open DS_" << i << " for writing.\n";
+        m_dsLogIds.push_back(m_traceWriter.open("DS_" + std::to_string(i)));
+    }
+    resetDsBatch_();
+}
+
+// ===== Trace output =====
+void BIUNetwork::resetDsBatch_()
+{
+    m_dsBatch.clear();
+    m_dsBatch.resize(m_dsLogIds.size());
+    for (size_t i = 0; i < m_dsLogIds.size(); ++i)
+    {
+        m_dsBatch[i].fileId = m_dsLogIds[i];
+        m_dsBatch[i].values.reserve(DS::patternCycles(m_dsBitWidth));
     }
 }
 
+// Streamed mode: the per-neuron files printNetworkToFile() would write are created up
+// front and filled line by line, so the histories never accumulate in memory.
+void BIUNetwork::openTraceFiles_()
+{
+    m_traceIds.assign(m_vecLayers.size(), std::vector<NeuronTraceIds>());
+    for (size_t layerIdx = 0; layerIdx < m_vecLayers.size(); ++layerIdx)
+    {
+        const size_t numNeurons = m_vecLayers[layerIdx].getLayerSize();
+        m_traceIds[layerIdx].resize(numNeurons);
+
+        for (size_t neuronIdx = 0; neuronIdx < numNeurons; ++neuronIdx)
+        {
+            const std::string suffix = std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
+            NeuronTraceIds& ids = m_traceIds[layerIdx][neuronIdx];
+            const ProbeRecording& recording = m_vecLayers[layerIdx].getRecording(static_cast<int>(neuronIdx));
+            if (recording.vn)
+                ids.vns = m_traceWriter.open("vns_" + suffix);
+            if (recording.spikes)
+                ids.spikes = m_traceWriter.open("spikes_" + suffix);
+            if (recording.vin)
+                ids.vin = m_traceWriter.open("vin_" + suffix);
+        }
+    }
+}
+
+void BIUNetwork::streamTraces_()
+{
+    TraceWriter::Batch batch;
+    for (size_t layerIdx = 0; layerIdx < m_vecLayers.size(); ++layerIdx)
+    {
+        BIULayer& layer = m_vecLayers[layerIdx];
+        layer.syncQuiescent();
+
+        const size_t numNeurons = layer.getLayerSize();
+        for (size_t neuronIdx = 0; neuronIdx < numNeurons; ++neuronIdx)
+        {
+            const NeuronTraceIds& ids = m_traceIds[layerIdx][neuronIdx];
+            if (ids.vns < 0 && ids.spikes < 0 && ids.vin < 0)
+                continue; // not probed: nothing recorded
+            TraceWriter::Chunk vns, spikes, vin;
+            layer.takeTraces(static_cast<int>(neuronIdx), vns.values, spikes.values, vin.values);
+
+            vns.fileId = ids.vns;
+            spikes.fileId = ids.spikes;
+            vin.fileId = ids.vin;
+            if (vns.fileId >= 0)    batch.push_back(std::move(vns));
+            if (spikes.fileId >= 0) batch.push_back(std::move(spikes));
+            if (vin.fileId >= 0)    batch.push_back(std::move(vin));
+        }
+    }
+    m_traceWriter.submit(std::move(batch));
+}
+
 unsigned int BIUNetwork::clampToCode_(double x) const
 {
     if (m_dsBitWidth >= 31) return 0; // safety
@@ -285,4 +608,25 @@ unsigned int BIUNetwork::clampToCode_(double x) const
     if (x < 0.0) return 0u;
     if (x > (double)maxCode) return maxCode;
     return static_cast<unsigned int>(x);
-}
\ No newline at end of file
+}
+
+// ===== Checkpoint / resume =====
+void BIUNetwork::saveState(SnapshotWriter& out) const
+{
+    out.put<std::uint64_t>(m_dsUnits.size());
+    for (const auto& ds : m_dsUnits) ds.saveState(out);
+    out.put<std::uint64_t>(m_vecLayers.size());
+    for (const auto& layer : m_vecLayers) layer.saveState(out);
+    out.put<std::uint64_t>(m_simulatedCycles);
+    out.put<std::uint64_t>(m_gatedLines);
+}
+
+void BIUNetwork::loadState(SnapshotReader& in)
+{
+    in.expectCount(m_dsUnits.size(), "DS units");
+    for (auto& ds : m_dsUnits) ds.loadState(in);
+    in.expectCount(m_vecLayers.size(), "layers");
+    for (auto& layer : m_vecLayers) layer.loadState(in);
+    m_simulatedCycles = static_cast<std::size_t>(in.get<std::uint64_t>());
+    m_gatedLines = static_cast<std::size_t>(in.get<std::uint64_t>());
+}
@@ -1,8 +1,11 @@
 #pragma once
 #include <iostream>
 
+#include <cstdint>
 #include <vector>
+#include <memory>
 #include "BIULayer.hpp"
+#include "BIULayerPipeline.hpp"
 #include "../Common/BaseNetwork.hpp"
 #include "../NemoSimEngine/networkParams.hpp"
 #include "../DS/DS.hpp"
@@ -13,23 +16,60 @@ class BIUNetwork : public BaseNetwork
 {
 public:
 	explicit BIUNetwork(NetworkParameters params);
-	~BIUNetwork();
-	void run(std::ifstream& inputFile) override;
+	// Loads the energy tables named in `params` (empty paths leave a table empty); throws
+	// std::runtime_error if a file cannot be loaded.
+	static std::shared_ptr<EnergyTable> loadEnergyTable(const NetworkParameters& params);
+	void run(std::istream& inputFile) override;
 	void printNetworkToFile() override;
+	void collectTotals(std::map<std::string, double>& totals) override;
 	double getTotalNeuronsEnergy();
 	double getTotalSynapsesEnergy();
 	double getTotalspikes();
+	// Parses one input line (digital codes for DS); runs on the reader stage.
+	static void parseInputLine(const std::string& line, std::size_t lineNumber, std::vector<double>& values);
 private:
 	Verbosity m_verbosity = Verbosity::Info; // NEW
+	bool m_hasProbes = false;                // probes select the recorded traces (see Probes.hpp)
 	std::vector<BIULayer> m_vecLayers;
 	void setInputs(const std::vector<double>& inputs);
 	std::vector<std::vector<uint8_t>> update();
-	EnergyTable* m_energyTable = nullptr; // Pointer to energy table for energy calculations
+	void recordCycle_(const std::vector<std::vector<uint8_t>>& allSpikes); // stats / readout of a cycle
+	void recordDsOutputs_(const std::vector<double>& outputs);            // DS_<i> traces of a cycle
+	std::shared_ptr<EnergyTable> m_energyTable; // energy table for energy calculations (may be shared)
 	// ===== DS front-end (one DS per input channel) =====
 	std::vector<DS> m_dsUnits;            // created to match layer-0 fan-in
 	unsigned int m_dsBitWidth = 4;        // default: 4-bit codes (0..255)
 	double m_dsClockMHz = 10.0;           // default DS clock
 	DS::Mode m_dsMode = DS::ThresholdMode;
+	const DS::BankKernels* m_dsKernels = nullptr; // tick / activeCycles of m_dsBitWidth
+	// ===== Early exit of the gating loop =====
+	EarlyExitMode m_earlyExitMode = EarlyExitMode::Off;
+	double m_earlyExitTolerance = 0.01;
+	std::size_t m_simulatedCycles = 0;    // cycles actually stepped through the layers
+	std::size_t m_gatedLines = 0;         // input lines processed through the DS front-end
+	bool skipSilentCycles_(std::size_t cycles);
+	void resetState_();
+	// ===== Layer pipeline (see BIULayerPipeline.hpp) =====
+	bool m_layerPipelineEnabled = false;
+	std::shared_ptr<TaskScheduler> m_scheduler; // compute_threads != 1; shared by the layers
+	void submitWave_(BIULayerPipeline& pipeline, std::vector<double>& layerInputs);
+	void drainWaves_(BIULayerPipeline& pipeline);   // every submitted cycle finished and recorded
+	void finishWave_(const BIULayerPipeline::Wave& wave);
+	// ===== Profiling (see Profiler.hpp); m_layerNs is empty unless enabled =====
+	std::vector<std::uint64_t> m_layerNs;  // update time per layer
+	std::size_t m_linesRun = 0;
+	std::uint64_t m_spikeCount = 0;
+	void reportProfile_();
+	// ===== Trace output (through BaseNetwork::m_traceWriter) =====
+	struct NeuronTraceIds { int vns = -1; int spikes = -1; int vin = -1; };
+	std::vector<int> m_dsLogIds;                          // DS_<i> files, one per DS unit
+	TraceWriter::Batch m_dsBatch;                         // DS outputs of the current input line
+	std::vector<std::vector<NeuronTraceIds>> m_traceIds;  // streamed mode: per-neuron files
+	void resetDsBatch_();
+	void openTraceFiles_();
+	void streamTraces_();
+	void saveState(SnapshotWriter& out) const override;
+	void loadState(SnapshotReader& in) override;
 	void initFrontEndDS_(size_t inputCount);
 	unsigned int clampToCode_(double x) const; // map file value -> [0..(1<<bw)-1]
 };
@@ -1,5 +1,8 @@
 #include "BIUNeuron.hpp"
+#include "FixedBIUNeuron.hpp"
 #include "EnergyTable.hpp"
+#include "../Common/Checkpoint.hpp"
+#include <algorithm>
 #include <vector>
 #include <stdexcept> // For std::invalid_argument and std::runtime_error
 #include <cmath> // exp
@@ -8,29 +11,110 @@
 #define R_LEAK 1e8  // Leakage resistor
 #define VDD_HALF_FACTOR 0.5 // For clarity in voltage calculation
 
-BIUNeuron::BIUNeuron(double vth, double vdd, double refractory,
+template <typename Real>
+BasicBIUNeuron<Real>::BasicBIUNeuron(double vth, double vdd, double refractory,
     double cn, double cu, double cpara, double rLeak,
-    const std::vector<double>& weights, EnergyTable* energyTable)
-    : m_VTH(vth), m_VDD(vdd), m_refractoryTime(refractory),
-    m_Cn(cn), m_Cu(cu), m_Cpara(cpara), m_RLeak(rLeak),
+    Row weights, EnergyTable* energyTable)
+    : m_VTH(static_cast<Real>(vth)), m_VDD(static_cast<Real>(vdd)), m_refractoryTime(refractory),
+    m_Cn(static_cast<Real>(cn)), m_Cu(static_cast<Real>(cu)), m_Cpara(static_cast<Real>(cpara)), m_RLeak(rLeak),
     m_synapticWeights(weights), m_energyTable(energyTable)
 {
     m_Vn = 0;
     cyclesLeft = 0;
     m_synapticInputs.resize(weights.size(), 0.0);
     m_synapticEnergy.resize(weights.size(), 0.0);
+    precompute_();
 }
 
-void BIUNeuron::setSynapticInputs(const std::vector<double>& inputs)
+template <typename Real>
+BasicBIUNeuron<Real>::BasicBIUNeuron(const FixedBIUNeuron& other, Row weights)
+    : m_VTH(static_cast<Real>(other.m_VTH)), m_VDD(static_cast<Real>(other.m_VDD)),
+    m_refractoryTime(other.m_refractoryTime),
+    m_Cn(static_cast<Real>(other.m_Cn)), m_Cu(static_cast<Real>(other.m_Cu)),
+    m_Vn(static_cast<Real>(other.getVoltage())), m_RLeak(other.m_RLeak),
+    m_Cpara(static_cast<Real>(other.m_Cpara)), cyclesLeft(other.cyclesLeft),
+    m_cycle(other.m_cycle), m_refractorySkips(other.m_refractorySkips),
+    m_synapticWeights(weights), m_synapticInputs(other.unpackInputs_()),
+    m_synapticEnergy(other.m_synapticEnergy), m_neuronEnergy(other.m_neuronEnergy),
+    m_recording(other.m_recording), m_spikes(other.m_spikes), m_Vins(other.m_Vins),
+    m_Vns(other.m_Vns), m_energyTable(other.m_energyTable)
+{
+    m_vin_sum = other.m_vin_sum;
+    if (weights.size() != other.m_synapticWeights.size())
+        throw std::invalid_argument("BIUNeuron: weight row size does not match the neuron.");
+    precompute_();
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::precompute_()
+{
+    const size_t Nu = m_synapticWeights.size();
+    m_Cstatic = m_Cn + static_cast<Real>(Nu) * m_Cpara;
+    m_decay = static_cast<Real>(std::exp(-1.0 / (m_RLeak * static_cast<double>(m_Cstatic) * FCLK)));
+
+    // With no spikes every injection term is a (signed) zero. Fold them once so the
+    // quiescent path reproduces update() bit for bit, including the sign of a zero Vn.
+    m_zeroInjection = -Real(0);
+    for (size_t i = 0; i < Nu; ++i)
+    {
+        m_zeroInjection += (m_Cu / m_Cstatic) * Real(0) * (m_synapticWeights[i] * m_VDD);
+    }
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::setPatternTable(std::shared_ptr<const PatternTable> table)
+{
+    if (table && table->size() != (size_t(1) << m_synapticWeights.size()))
+        throw std::invalid_argument("BIUNeuron: spike-pattern table does not match the number of synapses.");
+    m_patternTable = std::move(table);
+}
+
+template <typename Real>
+std::shared_ptr<const typename BasicBIUNeuron<Real>::PatternTable>
+BasicBIUPatternCache<Real>::get(const BasicBIUNeuron<Real>& neuron)
+{
+    const size_t Nu = neuron.m_synapticWeights.size();
+    if (Nu > kMaxInputs)
+        throw std::invalid_argument("BIUNeuron: spike-pattern tables need at most 16 synapses.");
+
+    std::vector<double> key = { double(neuron.m_Cstatic), double(neuron.m_Cu), double(neuron.m_decay), double(neuron.m_VDD) };
+    key.insert(key.end(), neuron.m_synapticWeights.begin(), neuron.m_synapticWeights.end());
+    auto& table = m_tables[key];
+    if (table)
+        return table;
+
+    // Same operations as BasicBIUNeuron::update() for every pattern, folded per entry
+    auto built = std::make_shared<typename BasicBIUNeuron<Real>::PatternTable>(size_t(1) << Nu);
+    for (size_t mask = 0; mask < built->size(); ++mask)
+    {
+        Real Ctotal = neuron.m_Cstatic;
+        for (size_t i = 0; i < Nu; ++i)
+        {
+            const Real spike = ((mask >> i) & 1u) ? Real(1) : Real(0);
+            Ctotal += spike * (neuron.m_Cu * neuron.m_synapticWeights[i]);
+        }
+        if (Ctotal == Real(0))
+            throw std::runtime_error("Total capacitance is zero.");
+
+        Real injection = -Real(0);
+        for (size_t i = 0; i < Nu; ++i)
+        {
+            const Real spike = ((mask >> i) & 1u) ? Real(1) : Real(0);
+            injection += (neuron.m_Cu / Ctotal) * spike * (neuron.m_synapticWeights[i] * neuron.m_VDD);
+        }
+        (*built)[mask] = { (neuron.m_Cstatic / Ctotal) * neuron.m_decay, injection };
+    }
+    table = built;
+    return table;
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::setSynapticInputs(const std::vector<double>& inputs)
 {
     if (inputs.size() != m_synapticWeights.size())
         throw std::invalid_argument("Input size does not match synaptic weights size.");
     m_synapticInputs = inputs;
-    for (size_t i = 0; i < m_synapticInputs.size(); ++i)
-    {
-	    m_synapticEnergy[i] += m_energyTable->getSynapseEnergy(static_cast<int>(m_synapticWeights[i]), m_synapticInputs[i] > 0);
-    }
-    if (!m_synapticInputs.empty())
+    if (!m_synapticInputs.empty() && m_recording.vin && m_recording.samples(m_cycle))
     {
 		double neuronInput = 0.0;
         for (size_t i = 0; i < m_synapticInputs.size(); ++i)
@@ -42,77 +126,228 @@ void BIUNeuron::setSynapticInputs(const std::vector<double>& inputs)
        
 }
 
-bool BIUNeuron::update()
+template <typename Real>
+void BasicBIUNeuron<Real>::accumulateSynapticEnergy()
 {
+    for (size_t i = 0; i < m_synapticInputs.size(); ++i)
+    {
+	    m_synapticEnergy[i] += m_energyTable->getSynapseEnergy(static_cast<int>(m_synapticWeights[i]), m_synapticInputs[i] > 0);
+    }
+}
+
+template <typename Real>
+bool BasicBIUNeuron<Real>::update()
+{
+    const bool sampled = m_recording.any() && m_recording.samples(m_cycle);
     m_neuronEnergy += m_energyTable->getNeuronEnergy(m_VTH, m_Vn);
-    m_Vns.emplace_back(m_Vn);
+    if (sampled && m_recording.vn) m_Vns.emplace_back(m_Vn);
+    ++m_cycle;
 
     if (cyclesLeft > 0)
     {
         m_Vn = 0;
         cyclesLeft--;
-        m_spikes.emplace_back(0);
+        ++m_refractorySkips;
+        if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
         return false;
     }
 
     const size_t Nu = m_synapticWeights.size();
-    const double Cstatic = m_Cn + static_cast<double>(Nu) * m_Cpara;
+    if (m_patternTable)
+    {
+        std::uint32_t mask = 0, spikes = 0;
+        for (size_t i = 0; i < Nu; ++i)
+        {
+            const std::uint32_t spike = m_synapticInputs[i] > 0.0 ? 1u : 0u;
+            mask |= spike << i;
+            spikes += spike;
+        }
+        m_vin_sum += spikes;
+        const BIUPatternEntry<Real>& ratios = (*m_patternTable)[mask];
+        m_Vn = m_Vn * ratios.decay + ratios.injection;
+        return fire_(sampled);
+    }
+
+    const Real Cstatic = m_Cstatic;
 
     // Ctotal = Cn + Nu*Cpara + sum_i spike_i * (Cu * Wi)
-    double Ctotal = Cstatic;
+    Real Ctotal = Cstatic;
     for (size_t i = 0; i < Nu; ++i)
     {
-        const double spike = (m_synapticInputs[i] > 0.0) ? 1.0 : 0.0;
+        const Real spike = (m_synapticInputs[i] > 0.0) ? Real(1) : Real(0);
         m_vin_sum += spike;
         Ctotal += spike * (m_Cu * m_synapticWeights[i]);
     }
 
-    if (Ctotal == 0.0)
+    if (Ctotal == Real(0))
         throw std::runtime_error("Total capacitance is zero.");
 
-    // exp(-1 / (R * (Cn + Nu*Cpara) * fclk))
-    const double decay = std::exp(-1.0 / (m_RLeak * Cstatic * FCLK));
+    // exp(-1 / (R * (Cn + Nu*Cpara) * fclk)), precomputed in the constructor
+    const Real decay = m_decay;
 
     // First term: ((Cn+Nu*Cpara)/Ctotal * Vn(t)) * decay
-    double vn_next = (Cstatic / Ctotal) * m_Vn * decay;
+    Real vn_next = (Cstatic / Ctotal) * m_Vn * decay;
 
     // Second term: sum_i [ (Cu/Ctotal) * spike_i * (Wi * (VDD * WS_i)) ]
     // Here WS_i = +1.0 by default.
     for (size_t i = 0; i < Nu; ++i)
     {
-        const double spike = (m_synapticInputs[i] > 0.0) ? 1.0 : 0.0;
-        const double Wi = m_synapticWeights[i];
-        const double WSi = 1.0; // TODO: replace if you have per-synapse sign/selector
+        const Real spike = (m_synapticInputs[i] > 0.0) ? Real(1) : Real(0);
+        const Real Wi = m_synapticWeights[i];
+        const Real WSi = Real(1); // TODO: replace if you have per-synapse sign/selector
         vn_next += (m_Cu / Ctotal) * spike * (Wi * (m_VDD * WSi));
     }
 
     m_Vn = vn_next;
+    return fire_(sampled);
+}
 
+template <typename Real>
+bool BasicBIUNeuron<Real>::fire_(bool sampled)
+{
     if (m_Vn >= m_VTH)
     {
         m_Vn = 0;
         cyclesLeft = static_cast<int>(m_refractoryTime);
-        m_spikes.emplace_back(1);
+        if (sampled && m_recording.spikes) m_spikes.emplace_back(1);
         return true;
     }
 
-    m_spikes.emplace_back(0);
+    if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
     return false;
 }
 
-double BIUNeuron::getVoltage() const
+template <typename Real>
+void BasicBIUNeuron<Real>::fastForward(std::uint64_t toCycle)
+{
+    while (m_cycle < toCycle)
+    {
+        quiescentStep_();
+    }
+}
+
+// One cycle of setSynapticInputs(all zeros) + update(), without touching the synapses:
+// no synaptic energy (spike_rate 0), Vin = 0, Ctotal = Cstatic, so Vn only decays.
+template <typename Real>
+void BasicBIUNeuron<Real>::quiescentStep_()
+{
+    const bool sampled = m_recording.any() && m_recording.samples(m_cycle);
+    if (sampled && m_recording.vin && !m_synapticWeights.empty())
+    {
+        m_Vins.emplace_back(0.0);
+    }
+
+    m_neuronEnergy += m_energyTable->getNeuronEnergy(m_VTH, m_Vn);
+    if (sampled && m_recording.vn) m_Vns.emplace_back(m_Vn);
+    ++m_cycle;
+
+    if (cyclesLeft > 0)
+    {
+        m_Vn = 0;
+        cyclesLeft--;
+        ++m_refractorySkips;
+    }
+    else
+    {
+        if (m_Cstatic == Real(0))
+            throw std::runtime_error("Total capacitance is zero.");
+
+        // A decaying Vn stays below VTh, so a silent cycle can never fire.
+        m_Vn = m_Vn * m_decay + m_zeroInjection;
+    }
+    if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::settle(std::uint64_t cycles)
 {
-    return m_Vn;
+    if (cycles == 0)
+        return;
+
+    // entry bin for every cycle (exact below 50 mV, see the header)
+    const double energyPerCycle = m_energyTable->getNeuronEnergy(m_VTH, m_Vn);
+    m_neuronEnergy += energyPerCycle * static_cast<double>(cycles);
+
+    // Vn after k silent cycles, for the trace and the final state alike: k decays and the
+    // (signed zero) injection of quiescentStep_(), which only fixes the sign of a zero Vn.
+    const Real vn0 = m_Vn;
+    auto decayed = [&](std::uint64_t k) {
+        return k == 0 ? vn0 : static_cast<Real>(vn0 * std::pow(m_decay, static_cast<double>(k))) + m_zeroInjection;
+    };
+    for (std::uint64_t k = 0; m_recording.any() && k < cycles; ++k)
+    {
+        if (m_recording.samples(m_cycle + k))
+        {
+            if (m_recording.vin && !m_synapticWeights.empty())
+            {
+                m_Vins.emplace_back(0.0);
+            }
+            if (m_recording.vn) m_Vns.emplace_back(decayed(k));
+            if (m_recording.spikes) m_spikes.emplace_back(0);
+        }
+    }
+
+    m_Vn = decayed(cycles);
+    m_cycle += cycles;
 }
 
-double BIUNeuron::getTotalSynapticEnergy() const
+template <typename Real>
+double BasicBIUNeuron<Real>::getTotalSynapticEnergy() const
 {
     double sum = 0.0;
     for (double e : m_synapticEnergy) sum += e;
     return sum;
 }
 
-double BIUNeuron::getNeuronEnergy() const
+template <typename Real>
+double BasicBIUNeuron<Real>::getNeuronEnergy() const
 {
     return m_neuronEnergy;
-}
\ No newline at end of file
+}
+
+// Vn is stored as double whatever Real is, so snapshots do not depend on the precision.
+template <typename Real>
+void BasicBIUNeuron<Real>::saveState(SnapshotWriter& out) const
+{
+    out.put(static_cast<double>(m_Vn));
+    out.put(cyclesLeft);
+    out.put(m_cycle);
+    out.put(m_neuronEnergy);
+    out.put(m_vin_sum);
+    out.putVector(m_synapticInputs);
+    out.putVector(m_synapticEnergy);
+    out.putVector(m_Vns);
+    out.putVector(m_spikes);
+    out.putVector(m_Vins);
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::loadState(SnapshotReader& in)
+{
+    m_Vn = static_cast<Real>(in.get<double>());
+    in.get(cyclesLeft);
+    in.get(m_cycle);
+    in.get(m_neuronEnergy);
+    in.get(m_vin_sum);
+    in.getVector(m_synapticInputs);
+    in.getVector(m_synapticEnergy);
+    if (m_synapticInputs.size() != m_synapticWeights.size() || m_synapticEnergy.size() != m_synapticWeights.size())
+        throw std::runtime_error("Checkpoint Error: snapshot does not match the network (synapses per neuron)");
+    in.getVector(m_Vns);
+    in.getVector(m_spikes);
+    in.getVector(m_Vins);
+}
+
+template <typename Real>
+void BasicBIUNeuron<Real>::resetState()
+{
+    m_Vn = 0;
+    cyclesLeft = 0;
+    m_cycle = 0;
+    std::fill(m_synapticInputs.begin(), m_synapticInputs.end(), 0.0);
+}
+
+template class BasicBIUNeuron<double>;
+template class BasicBIUNeuron<float>;
+template class BasicBIUPatternCache<double>;
+template class BasicBIUPatternCache<float>;
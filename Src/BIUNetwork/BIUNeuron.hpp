@@ -1,44 +1,168 @@
 #pragma once
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <map>
+#include <memory>
+#include "../Common/WeightMatrix.hpp"
+#include "../Common/Probes.hpp"
 
 class EnergyTable; // Forward declaration
+class SnapshotWriter;
+class SnapshotReader;
+class FixedBIUNeuron;
+template <typename Real> class BasicBIUPatternCache;
 
-class BIUNeuron 
+// Both capacitance ratios of one input spike pattern: Vn' = Vn * decay + injection.
+template <typename Real>
+struct BIUPatternEntry
+{
+	Real decay;     // Cstatic / Ctotal * exp(-1 / (RLeak * Cstatic * fclk))
+	Real injection; // sum_i spike_i * Cu / Ctotal * Wi * VDD
+};
+
+// Real: type of the membrane state, device constants and weights (see Precision.hpp);
+// energies and traces are double in both instantiations.
+template <typename Real>
+class BasicBIUNeuron
 {
 public:
-	BIUNeuron(double vth, double vdd, double refractory,
+	using Row = BasicWeightRow<Real>;
+
+	BasicBIUNeuron(double vth, double vdd, double refractory,
 		double cn, double cu, double cpara, double rLeak,
-		const std::vector<double>& weights, EnergyTable* energyTable); 
+		Row weights, EnergyTable* energyTable);
+	// Same neuron (constants, state, traces) in another precision, reading `weights`.
+	template <typename Other>
+	BasicBIUNeuron(const BasicBIUNeuron<Other>& other, Row weights);
+	// Back from the integer datapath (see FixedBIUNeuron.hpp), reading `weights`.
+	BasicBIUNeuron(const FixedBIUNeuron& other, Row weights);
+	// Which traces this neuron keeps (see Probes.hpp); default: all, every cycle.
+	using PatternTable = std::vector<BIUPatternEntry<Real>>;
+
+	void setRecording(const ProbeRecording& recording) { m_recording = recording; }
+	// Spike-pattern table: entry m holds the ratios of the inputs whose bit is set in m
+	// (input i = bit i), so update() is one lookup and a multiply-add instead of the
+	// Ctotal sum and two divisions. Only for Nu <= 16 (see BasicBIUPatternCache); the
+	// result matches the default update up to rounding. nullptr turns it off.
+	void setPatternTable(std::shared_ptr<const PatternTable> table);
+	const ProbeRecording& getRecording() const { return m_recording; }
+	// Stores the inputs of the next update() and records their weighted sum (Vin trace).
 	void setSynapticInputs(const std::vector<double>& inputs);
+	// Charges the synaptic energy of the inputs stored by setSynapticInputs().
+	void accumulateSynapticEnergy();
 	bool update();
-	double getVoltage() const;
+	// Quiescent fast-forward: replay, one cycle at a time, the silent cycles between the last
+	// cycle this neuron was touched and toCycle (pure decay / refractory countdown, no synapses).
+	void fastForward(std::uint64_t toCycle);
+	// Closed-form version for settled neurons (not refractory): Vn *= decay^cycles, for the
+	// trace samples and the final state alike (up to rounding of pow against repeated
+	// multiplies, hence approximate). The neuron energy of the entry Vn bin is charged for
+	// every cycle: exact while |Vn| < 50 mV (the first bin, which a decaying Vn never
+	// leaves), part of the early-exit tolerance error above.
+	void settle(std::uint64_t cycles);
+	bool isRefractory() const { return cyclesLeft > 0; }
+	std::uint64_t getCycle() const { return m_cycle; }
+	size_t getNumSynapses() const { return m_synapticWeights.size(); }
+	double getVoltage() const { return m_Vn; }
 	std::vector<double> getVns() const { return m_Vns; }
 	std::vector<double> getSpikesVec() const { return m_spikes; }
 	std::vector<double> getVinVec() const { return m_Vins; }
+	// Hands the recorded traces to the caller and starts empty ones (streamed output).
+	void takeTraces(std::vector<double>& vns, std::vector<double>& spikes, std::vector<double>& vins)
+	{
+		vns.swap(m_Vns);       m_Vns.clear();
+		spikes.swap(m_spikes); m_spikes.clear();
+		vins.swap(m_Vins);     m_Vins.clear();
+	}
     void setEnergyTable(EnergyTable* table) { m_energyTable = table; }
     double getTotalSynapticEnergy() const;
     double getNeuronEnergy() const;
+	// Checkpoint / resume: dynamic state, energy accumulators and unwritten traces.
+	void saveState(SnapshotWriter& out) const;
+	void loadState(SnapshotReader& in);
+	// Back to the state of a new neuron (Vn, refractory countdown, inputs, cycle count);
+	// energy accumulators and unwritten traces are kept.
+	void resetState();
 	double m_vin_sum = 0;
+	std::uint64_t getRefractorySkips() const { return m_refractorySkips; }
 private:
-	double m_VTH;
-	double m_VDD = 1.2;
+	template <typename> friend class BasicBIUNeuron;
+	friend class FixedBIUNeuron;
+	friend class BasicBIUPatternCache<Real>;
+
+	Real m_VTH;
+	Real m_VDD = Real(1.2);
 	int m_refractoryTime;
-	double m_Cn = 170e-15;
-	double m_Cu = 0.6e-15;
-	double m_Vn;
+	Real m_Cn = Real(170e-15);
+	Real m_Cu = Real(0.6e-15);
+	Real m_Vn;
 	double m_RLeak = 1e6;
-	double m_Cpara = 5.5e-15;
+	Real m_Cpara = Real(5.5e-15);
 	int cyclesLeft;
-	std::vector<double> m_synapticWeights;
+	Real m_Cstatic;            // Cn + Nu*Cpara
+	Real m_decay;              // exp(-1 / (RLeak * Cstatic * fclk))
+	Real m_zeroInjection;      // signed zero produced by the injection sum when no input spiked
+	std::uint64_t m_cycle = 0; // number of cycles this neuron has been advanced through
+	std::uint64_t m_refractorySkips = 0; // updates spent in the refractory period (profiling)
+	Row m_synapticWeights;     // row of the owning layer's weight matrix (or its float copy)
+	std::shared_ptr<const PatternTable> m_patternTable; // optional, see setPatternTable()
 	std::vector<double> m_synapticInputs;
 	std::vector<double> m_synapticEnergy;
 	double m_neuronEnergy = 0;
 
 	//output vetors for vn and spikes
+	ProbeRecording m_recording = ProbeRecording::all();
 	std::vector<double> m_spikes;
 	std::vector<double> m_Vins;
 	std::vector<double> m_Vns;
 
 
     EnergyTable* m_energyTable = nullptr; // Pointer to shared energy table
+
+	void quiescentStep_();
+	void precompute_();
+	bool fire_(bool sampled); // threshold test and spike trace of update()
 };
+
+// Builds the spike-pattern tables of a layer; neurons with the same constants and
+// weights share one (2^Nu entries each).
+template <typename Real>
+class BasicBIUPatternCache
+{
+public:
+	static constexpr size_t kMaxInputs = 16;
+	std::shared_ptr<const typename BasicBIUNeuron<Real>::PatternTable> get(const BasicBIUNeuron<Real>& neuron);
+
+private:
+	std::map<std::vector<double>, std::shared_ptr<const typename BasicBIUNeuron<Real>::PatternTable>> m_tables;
+};
+
+using BIUNeuron = BasicBIUNeuron<double>;
+
+// Both instantiations are compiled in BIUNeuron.cpp.
+extern template class BasicBIUNeuron<double>;
+extern template class BasicBIUNeuron<float>;
+extern template class BasicBIUPatternCache<double>;
+extern template class BasicBIUPatternCache<float>;
+
+template <typename Real>
+template <typename Other>
+BasicBIUNeuron<Real>::BasicBIUNeuron(const BasicBIUNeuron<Other>& other, Row weights)
+	: m_VTH(static_cast<Real>(other.m_VTH)), m_VDD(static_cast<Real>(other.m_VDD)),
+	m_refractoryTime(other.m_refractoryTime),
+	m_Cn(static_cast<Real>(other.m_Cn)), m_Cu(static_cast<Real>(other.m_Cu)),
+	m_Vn(static_cast<Real>(other.m_Vn)), m_RLeak(other.m_RLeak),
+	m_Cpara(static_cast<Real>(other.m_Cpara)), cyclesLeft(other.cyclesLeft),
+	m_cycle(other.m_cycle), m_refractorySkips(other.m_refractorySkips),
+	m_synapticWeights(weights), m_synapticInputs(other.m_synapticInputs),
+	m_synapticEnergy(other.m_synapticEnergy), m_neuronEnergy(other.m_neuronEnergy),
+	m_recording(other.m_recording), m_spikes(other.m_spikes), m_Vins(other.m_Vins),
+	m_Vns(other.m_Vns), m_energyTable(other.m_energyTable)
+{
+	m_vin_sum = other.m_vin_sum;
+	if (weights.size() != other.m_synapticWeights.size())
+		throw std::invalid_argument("BIUNeuron: weight row size does not match the neuron.");
+	precompute_();
+}
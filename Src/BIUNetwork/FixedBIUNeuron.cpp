@@ -0,0 +1,318 @@
+#include "FixedBIUNeuron.hpp"
+#include "EnergyTable.hpp"
+#include "../Common/Checkpoint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+void checkFormat(const FixedPointFormat& format)
+{
+    if (format.vnBits < 4 || format.vnBits > 30 || format.ratioBits < 4 || format.ratioBits > 30)
+        throw std::invalid_argument("FixedBIUNeuron: fixed_vn_bits and fixed_ratio_bits must be between 4 and 30.");
+}
+
+// round(value * scale), saturated to +-limit
+std::int32_t roundToCode(double value, double scale, std::int32_t limit)
+{
+    const double code = std::floor(value * scale + 0.5);
+    return code <= -limit ? -limit : code >= limit ? limit : static_cast<std::int32_t>(code);
+}
+
+} // namespace
+
+FixedRatioCache::FixedRatioCache(const FixedPointFormat& format, std::int32_t minSum, std::int32_t maxSum)
+    : m_format(format), m_minSum(minSum), m_maxSum(maxSum)
+{
+    checkFormat(format);
+    if (minSum > 0 || maxSum < 0)
+        throw std::invalid_argument("FixedBIUNeuron: the ratio table must cover S = 0.");
+}
+
+std::shared_ptr<const FixedRatioTable> FixedRatioCache::get(double cstatic, double cu, double decay)
+{
+    auto& table = m_tables[std::make_tuple(cstatic, cu, decay)];
+    if (table)
+        return table;
+
+    const double ratioScale = std::ldexp(1.0, m_format.ratioBits);
+    const double vnScale = std::ldexp(1.0, m_format.vnBits);
+    const std::size_t size = static_cast<std::size_t>(std::int64_t(m_maxSum) - m_minSum + 1);
+    auto built = std::make_shared<FixedRatioTable>();
+    built->minSum = m_minSum;
+    built->decay.resize(size);
+    built->injection.resize(size);
+    for (std::size_t k = 0; k < size; ++k)
+    {
+        const double s = static_cast<double>(m_minSum + static_cast<std::int64_t>(k));
+        const double ctotal = cstatic + cu * s;
+        if (ctotal == 0.0)
+            throw std::runtime_error("Total capacitance is zero.");
+        built->decay[k] = roundToCode(cstatic / ctotal * decay, ratioScale, std::numeric_limits<std::int32_t>::max());
+        built->injection[k] = roundToCode(cu * s / ctotal, vnScale, static_cast<std::int32_t>(vnScale));
+    }
+    table = built;
+    return table;
+}
+
+FixedBIUNeuron::FixedBIUNeuron(const BIUNeuron& other, Row weights, const FixedPointFormat& format, FixedRatioCache& cache)
+    : m_VTH(other.m_VTH), m_VDD(other.m_VDD), m_Cn(other.m_Cn), m_Cu(other.m_Cu), m_Cpara(other.m_Cpara),
+    m_RLeak(other.m_RLeak), m_refractoryTime(other.m_refractoryTime), cyclesLeft(other.cyclesLeft),
+    m_ratioBits(format.ratioBits), m_cycle(other.m_cycle), m_refractorySkips(other.m_refractorySkips),
+    m_synapticWeights(weights), m_synapticEnergy(other.m_synapticEnergy), m_neuronEnergy(other.m_neuronEnergy),
+    m_recording(other.m_recording), m_spikes(other.m_spikes), m_Vins(other.m_Vins),
+    m_Vns(other.m_Vns), m_energyTable(other.m_energyTable)
+{
+    checkFormat(format);
+    if (weights.size() != other.m_synapticWeights.size())
+        throw std::invalid_argument("BIUNeuron: weight row size does not match the neuron.");
+    if (m_VDD <= 0.0)
+        throw std::invalid_argument("FixedBIUNeuron: VDD must be positive.");
+
+    m_vin_sum = other.m_vin_sum;
+    m_maxCode = (std::int32_t(1) << format.vnBits) - 1;
+    m_lsb = m_VDD / std::ldexp(1.0, format.vnBits);
+    const double vthCode = std::ceil(m_VTH / m_lsb);
+    m_vthCode = vthCode <= -m_maxCode ? -m_maxCode : vthCode > m_maxCode ? m_maxCode + 1 : static_cast<std::int32_t>(vthCode);
+    m_vn = toCode_(other.m_Vn);
+    m_table = cache.get(other.m_Cstatic, m_Cu, other.m_decay);
+    packInputs_(other.m_synapticInputs);
+    sumActiveInputs_();
+}
+
+std::int32_t FixedBIUNeuron::toCode_(double vn) const
+{
+    return roundToCode(vn, 1.0 / m_lsb, m_maxCode);
+}
+
+// Vn' = (decay[S] * Vn) >> ratioBits (rounded, arithmetic shift) + inj[S], saturated.
+// |decay| < 2^31 and |Vn| < 2^30, so the product fits in 64 bits.
+std::int32_t FixedBIUNeuron::decayStep_(std::int32_t vn, std::int32_t sum) const
+{
+    const std::size_t entry = static_cast<std::size_t>(sum - m_table->minSum);
+    const std::int64_t half = std::int64_t(1) << (m_ratioBits - 1);
+    const std::int64_t next = ((std::int64_t(m_table->decay[entry]) * vn + half) >> m_ratioBits) + m_table->injection[entry];
+    return next > m_maxCode ? m_maxCode : next < -m_maxCode ? -m_maxCode : static_cast<std::int32_t>(next);
+}
+
+void FixedBIUNeuron::packInputs_(const std::vector<double>& inputs)
+{
+    m_inputSpikes.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        m_inputSpikes[i] = inputs[i] > 0.0 ? 1 : 0;
+    }
+}
+
+std::vector<double> FixedBIUNeuron::unpackInputs_() const
+{
+    return std::vector<double>(m_inputSpikes.begin(), m_inputSpikes.end());
+}
+
+// Branch-free int16 x uint8 dot product over contiguous arrays (vectorized by the compiler)
+void FixedBIUNeuron::sumActiveInputs_()
+{
+    const std::int16_t* w = m_synapticWeights.data();
+    const std::uint8_t* spike = m_inputSpikes.data();
+    const size_t n = m_synapticWeights.size();
+    std::int32_t sum = 0;
+    std::uint32_t active = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += w[i] * spike[i];
+        active += spike[i];
+    }
+    if (sum < m_table->minSum || std::int64_t(sum) - m_table->minSum >= std::int64_t(m_table->decay.size()))
+        throw std::runtime_error("FixedBIUNeuron: active weight sum exceeds the ratio table.");
+    m_activeSum = sum;
+    m_activeInputs = active;
+}
+
+void FixedBIUNeuron::setSynapticInputs(const std::vector<double>& inputs)
+{
+    if (inputs.size() != m_synapticWeights.size())
+        throw std::invalid_argument("Input size does not match synaptic weights size.");
+    packInputs_(inputs);
+    inputsStored_(inputs);
+}
+
+void FixedBIUNeuron::setSynapticInputs(const std::vector<double>& inputs, const std::uint8_t* spikes)
+{
+    if (inputs.size() != m_synapticWeights.size())
+        throw std::invalid_argument("Input size does not match synaptic weights size.");
+    std::copy(spikes, spikes + inputs.size(), m_inputSpikes.begin());
+    inputsStored_(inputs);
+}
+
+// Active sum of the new spikes and the Vin trace of `inputs`
+void FixedBIUNeuron::inputsStored_(const std::vector<double>& inputs)
+{
+    sumActiveInputs_();
+    if (!inputs.empty() && m_recording.vin && m_recording.samples(m_cycle))
+    {
+        double neuronInput = 0.0;
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            neuronInput += inputs[i] * m_synapticWeights[i];
+        }
+        m_Vins.emplace_back(neuronInput);
+    }
+}
+
+void FixedBIUNeuron::accumulateSynapticEnergy()
+{
+    for (size_t i = 0; i < m_inputSpikes.size(); ++i)
+    {
+        m_synapticEnergy[i] += m_energyTable->getSynapseEnergy(static_cast<int>(m_synapticWeights[i]), m_inputSpikes[i] != 0);
+    }
+}
+
+bool FixedBIUNeuron::update()
+{
+    const bool sampled = m_recording.any() && m_recording.samples(m_cycle);
+    m_neuronEnergy += m_energyTable->getNeuronEnergy(m_VTH, getVoltage());
+    if (sampled && m_recording.vn) m_Vns.emplace_back(getVoltage());
+    ++m_cycle;
+
+    if (cyclesLeft > 0)
+    {
+        m_vn = 0;
+        cyclesLeft--;
+        ++m_refractorySkips;
+        if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
+        return false;
+    }
+
+    m_vin_sum += m_activeInputs;
+    m_vn = decayStep_(m_vn, m_activeSum);
+
+    if (m_vn >= m_vthCode)
+    {
+        m_vn = 0;
+        cyclesLeft = m_refractoryTime;
+        if (sampled && m_recording.spikes) m_spikes.emplace_back(1);
+        return true;
+    }
+
+    if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
+    return false;
+}
+
+void FixedBIUNeuron::fastForward(std::uint64_t toCycle)
+{
+    while (m_cycle < toCycle)
+    {
+        quiescentStep_();
+    }
+}
+
+// One cycle of setSynapticInputs(all zeros) + update(), without touching the synapses.
+void FixedBIUNeuron::quiescentStep_()
+{
+    const bool sampled = m_recording.any() && m_recording.samples(m_cycle);
+    if (sampled && m_recording.vin && !m_synapticWeights.empty())
+    {
+        m_Vins.emplace_back(0.0);
+    }
+
+    m_neuronEnergy += m_energyTable->getNeuronEnergy(m_VTH, getVoltage());
+    if (sampled && m_recording.vn) m_Vns.emplace_back(getVoltage());
+    ++m_cycle;
+
+    if (cyclesLeft > 0)
+    {
+        m_vn = 0;
+        cyclesLeft--;
+        ++m_refractorySkips;
+    }
+    else
+    {
+        m_vn = decayStep_(m_vn, 0);
+    }
+    if (sampled && m_recording.spikes) m_spikes.emplace_back(0);
+}
+
+void FixedBIUNeuron::settle(std::uint64_t cycles)
+{
+    if (cycles == 0)
+        return;
+
+    // entry bin for every cycle, see BIUNeuron::settle
+    const double energyPerCycle = m_energyTable->getNeuronEnergy(m_VTH, getVoltage());
+    m_neuronEnergy += energyPerCycle * static_cast<double>(cycles);
+
+    for (std::uint64_t k = 0; k < cycles; ++k)
+    {
+        const std::int32_t next = decayStep_(m_vn, 0);
+        if (m_recording.any())
+        {
+            if (m_recording.samples(m_cycle + k))
+            {
+                if (m_recording.vin && !m_synapticWeights.empty())
+                {
+                    m_Vins.emplace_back(0.0);
+                }
+                if (m_recording.vn) m_Vns.emplace_back(getVoltage());
+                if (m_recording.spikes) m_spikes.emplace_back(0);
+            }
+        }
+        else if (next == m_vn)
+        {
+            break; // the rounded decay has reached its fixed point
+        }
+        m_vn = next;
+    }
+    m_cycle += cycles;
+}
+
+double FixedBIUNeuron::getTotalSynapticEnergy() const
+{
+    double sum = 0.0;
+    for (double e : m_synapticEnergy) sum += e;
+    return sum;
+}
+
+// Same layout as BIUNeuron: Vn as a voltage, so snapshots do not depend on the precision.
+void FixedBIUNeuron::saveState(SnapshotWriter& out) const
+{
+    out.put(getVoltage());
+    out.put(cyclesLeft);
+    out.put(m_cycle);
+    out.put(m_neuronEnergy);
+    out.put(m_vin_sum);
+    out.putVector(unpackInputs_());
+    out.putVector(m_synapticEnergy);
+    out.putVector(m_Vns);
+    out.putVector(m_spikes);
+    out.putVector(m_Vins);
+}
+
+void FixedBIUNeuron::loadState(SnapshotReader& in)
+{
+    m_vn = toCode_(in.get<double>());
+    in.get(cyclesLeft);
+    in.get(m_cycle);
+    in.get(m_neuronEnergy);
+    in.get(m_vin_sum);
+    std::vector<double> inputs;
+    in.getVector(inputs);
+    in.getVector(m_synapticEnergy);
+    if (inputs.size() != m_synapticWeights.size() || m_synapticEnergy.size() != m_synapticWeights.size())
+        throw std::runtime_error("Checkpoint Error: snapshot does not match the network (synapses per neuron)");
+    packInputs_(inputs);
+    in.getVector(m_Vns);
+    in.getVector(m_spikes);
+    in.getVector(m_Vins);
+    sumActiveInputs_();
+}
+
+void FixedBIUNeuron::resetState()
+{
+    m_vn = toCode_(0.0);
+    cyclesLeft = 0;
+    m_cycle = 0;
+    std::fill(m_inputSpikes.begin(), m_inputSpikes.end(), std::uint8_t(0));
+    sumActiveInputs_();
+}
@@ -0,0 +1,132 @@
+#pragma once
+/**
+ * @file FixedBIUNeuron.hpp
+ * @brief Integer BIU neuron (Precision::Fixed): the update of BIUNeuron on the fixed-width
+ *        datapath of the hardware.
+ *
+ * Ctotal = Cstatic + Cu * S only depends on S, the sum of the weights whose input spiked,
+ * so both capacitance ratios of a cycle come from a table indexed by S (weights must be
+ * integers in -32768..32767; inhibitory weights make S, and Vn, negative) and the update
+ * has no division:
+ *
+ *   S        = sum_i spike_i * W_i                                  (signed integer)
+ *   decay[S] = round(Cstatic / Ctotal(S) * exp(-1 / (RLeak Cstatic fclk)) * 2^ratioBits)
+ *   inj[S]   = round(Cu * S / Ctotal(S) * 2^vnBits)                 (VDD in Vn codes)
+ *   Vn'      = clamp((decay[S] * Vn + 2^(ratioBits-1)) >> ratioBits + inj[S], +-(2^vnBits - 1))
+ *   spike    = Vn' >= ceil(VTh / LSB), LSB = VDD / 2^vnBits
+ *
+ * Everything outside the membrane update (energies, traces, snapshots, the Vin trace)
+ * is double and identical to BIUNeuron; traces and energies see Vn as code * LSB.
+ */
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include "BIUNeuron.hpp"
+#include "../Common/Precision.hpp"
+
+// Ratio table of one (Cstatic, Cu, decay) combination, for S = minSum..maxSum (entry S - minSum).
+struct FixedRatioTable
+{
+    std::int32_t minSum = 0;
+    std::vector<std::int32_t> decay;     // Q.ratioBits (above 1 when inhibition lowers Ctotal)
+    std::vector<std::int32_t> injection; // Vn codes
+};
+
+// Builds the ratio tables of a layer, sharing one between neurons with the same constants.
+class FixedRatioCache
+{
+public:
+    // minSum / maxSum: most negative and most positive active weight sum of any neuron.
+    FixedRatioCache(const FixedPointFormat& format, std::int32_t minSum, std::int32_t maxSum);
+    std::shared_ptr<const FixedRatioTable> get(double cstatic, double cu, double decay);
+
+private:
+    FixedPointFormat m_format;
+    std::int32_t m_minSum, m_maxSum;
+    std::map<std::tuple<double, double, double>, std::shared_ptr<const FixedRatioTable>> m_tables;
+};
+
+class FixedBIUNeuron
+{
+public:
+	using Row = BasicWeightRow<std::int16_t>;
+
+	// The double neuron's constants and state on the fixed datapath, reading `weights`
+	// (integer copy of its weight row) and the ratio table of its constants from `cache`.
+	FixedBIUNeuron(const BIUNeuron& other, Row weights, const FixedPointFormat& format, FixedRatioCache& cache);
+	void setRecording(const ProbeRecording& recording) { m_recording = recording; }
+	const ProbeRecording& getRecording() const { return m_recording; }
+	void setSynapticInputs(const std::vector<double>& inputs);
+	// Same, with the spikes of `inputs` already packed by the layer (1 byte per input, 0 or 1)
+	void setSynapticInputs(const std::vector<double>& inputs, const std::uint8_t* spikes);
+	void accumulateSynapticEnergy();
+	bool update();
+	void fastForward(std::uint64_t toCycle);
+	// Silent cycles applied exactly (the integer decay reaches a fixed point), trace and
+	// state from the same steps; the neuron energy of the entry Vn bin is charged for every
+	// cycle, exact below 50 mV and otherwise part of the tolerance error (BIUNeuron::settle).
+	void settle(std::uint64_t cycles);
+	bool isRefractory() const { return cyclesLeft > 0; }
+	std::uint64_t getCycle() const { return m_cycle; }
+	size_t getNumSynapses() const { return m_synapticWeights.size(); }
+	double getVoltage() const { return m_vn * m_lsb; }
+	std::int32_t getVoltageCode() const { return m_vn; }
+	std::vector<double> getVns() const { return m_Vns; }
+	std::vector<double> getSpikesVec() const { return m_spikes; }
+	std::vector<double> getVinVec() const { return m_Vins; }
+	void takeTraces(std::vector<double>& vns, std::vector<double>& spikes, std::vector<double>& vins)
+	{
+		vns.swap(m_Vns);       m_Vns.clear();
+		spikes.swap(m_spikes); m_spikes.clear();
+		vins.swap(m_Vins);     m_Vins.clear();
+	}
+	double getTotalSynapticEnergy() const;
+	double getNeuronEnergy() const { return m_neuronEnergy; }
+	void saveState(SnapshotWriter& out) const;
+	void loadState(SnapshotReader& in);
+	void resetState(); // see BIUNeuron::resetState
+	double m_vin_sum = 0;
+	std::uint64_t getRefractorySkips() const { return m_refractorySkips; }
+private:
+	template <typename> friend class BasicBIUNeuron;
+
+	// device constants, kept to convert back to BIUNeuron
+	double m_VTH, m_VDD, m_Cn, m_Cu, m_Cpara, m_RLeak;
+	int m_refractoryTime;
+	int cyclesLeft;
+
+	int m_ratioBits;
+	std::int32_t m_maxCode;    // 2^vnBits - 1; Vn saturates at +-m_maxCode
+	std::int32_t m_vthCode;    // first code that fires
+	double m_lsb;              // volts per code
+	std::int32_t m_vn = 0;
+	std::shared_ptr<const FixedRatioTable> m_table;
+	std::int32_t m_activeSum = 0;     // S of the inputs stored by setSynapticInputs()
+	std::uint32_t m_activeInputs = 0; // number of those inputs that spiked
+
+	std::uint64_t m_cycle = 0;
+	std::uint64_t m_refractorySkips = 0;
+	Row m_synapticWeights;
+	std::vector<std::uint8_t> m_inputSpikes; // inputs of the next update(), 1 where one spiked
+	std::vector<double> m_synapticEnergy;
+	double m_neuronEnergy = 0;
+
+	ProbeRecording m_recording = ProbeRecording::all();
+	std::vector<double> m_spikes;
+	std::vector<double> m_Vins;
+	std::vector<double> m_Vns;
+
+	EnergyTable* m_energyTable = nullptr;
+
+	std::int32_t decayStep_(std::int32_t vn, std::int32_t sum) const;
+	std::int32_t toCode_(double vn) const;
+	void packInputs_(const std::vector<double>& inputs);
+	std::vector<double> unpackInputs_() const; // as BIUNeuron stores them (0.0 / 1.0)
+	void sumActiveInputs_();
+	void inputsStored_(const std::vector<double>& inputs);
+	void quiescentStep_();
+};
@@ -0,0 +1,388 @@
+#include "SyntheticNetwork.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// splitmix64: the same network for a seed on every platform
+class Rng
+{
+public:
+    explicit Rng(std::uint64_t seed) : m_state(seed) {}
+    std::uint64_t next()
+    {
+        std::uint64_t x = (m_state += 0x9E3779B97F4A7C15ull);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+    int below(int n) { return static_cast<int>(next() % static_cast<std::uint64_t>(n)); }
+
+private:
+    std::uint64_t m_state;
+};
+
+bool makeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+    return CreateDirectory(path.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+std::ofstream openOutput(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+        throw std::runtime_error("Generator Error: cannot write " + path);
+    out.precision(6);
+    return out;
+}
+
+// One weight: zero with probability `sparsity`, otherwise uniform in [lo, hi] (integers if `integral`).
+class WeightSource
+{
+public:
+    WeightSource(Rng& rng, double sparsity, double lo, double hi, bool integral)
+        : m_rng(rng), m_sparsity(sparsity), m_lo(lo), m_hi(hi), m_integral(integral) {}
+
+    double next()
+    {
+        if (m_sparsity > 0.0 && m_rng.uniform() < m_sparsity)
+            return 0.0;
+        if (m_integral)
+            return m_lo + m_rng.below(static_cast<int>(m_hi - m_lo) + 1);
+        return m_lo + (m_hi - m_lo) * m_rng.uniform();
+    }
+
+private:
+    Rng& m_rng;
+    double m_sparsity, m_lo, m_hi;
+    bool m_integral;
+};
+
+void writeRows(std::ostream& out, const char* indent, std::size_t rows, std::size_t cols, WeightSource& weights)
+{
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        out << indent << "<row>";
+        for (std::size_t c = 0; c < cols; ++c)
+            out << (c ? " " : "") << weights.next();
+        out << "</row>\n";
+    }
+}
+
+void writeBiu(const SyntheticSpec& spec, Rng& rng, std::ostream& xml, std::ostream& input)
+{
+    const bool defaultRange = spec.weightMax <= spec.weightMin;
+    WeightSource weights(rng, spec.sparsity, defaultRange ? 1.0 : spec.weightMin, defaultRange ? 8.0 : spec.weightMax, defaultRange);
+
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<NetworkConfig type=\"BIUNetwork\">\n"
+        << "\t<BIUNetwork>\n"
+        << "\t\t<VTh>" << (spec.vth > 0.0 ? spec.vth : 0.05) << "</VTh>\n"
+        << "\t\t<refractory>4</refractory>\n"
+        << "\t\t<fclk>1e7</fclk>\n"
+        << "\t\t<RLeak>1e6</RLeak>\n"
+        << "\t\t<VDD>1.2</VDD>\n"
+        << "\t\t<Cn>170e-15</Cn>\n"
+        << "\t\t<Cu>0.6e-15</Cu>\n"
+        << "\t\t<CPara>5.5e-15</CPara>\n"
+        << "\t\t<DSBitWidth>4</DSBitWidth>\n"
+        << "\t\t<DSClockMHz>10</DSClockMHz>\n"
+        << "\t</BIUNetwork>\n"
+        << "\t<Architecture>\n";
+    std::size_t fanIn = spec.inputs;
+    for (std::size_t size : spec.layers)
+    {
+        xml << "\t\t<Layer size=\"" << size << "\">\n"
+            << "\t\t\t<synapses rows=\"" << size << "\" cols=\"" << fanIn << "\">\n"
+            << "\t\t\t\t<weights>\n";
+        writeRows(xml, "\t\t\t\t\t", size, fanIn, weights);
+        xml << "\t\t\t\t</weights>\n"
+            << "\t\t\t</synapses>\n"
+            << "\t\t</Layer>\n";
+        fanIn = size;
+    }
+    xml << "\t</Architecture>\n"
+        << "</NetworkConfig>\n";
+
+    // one DS code (0..15) per input and line
+    for (std::size_t s = 0; s < spec.samples; ++s)
+    {
+        for (std::size_t i = 0; i < spec.inputs; ++i)
+            input << (i ? " " : "") << (rng.uniform() < spec.activity ? 1 + rng.below(15) : 0);
+        input << "\n";
+    }
+}
+
+void writeLif(const SyntheticSpec& spec, Rng& rng, std::ostream& xml, std::ostream& input)
+{
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<NetworkConfig type=\"LIFNetwork\">\n"
+        << "\t<LIFNetwork>\n"
+        << "\t\t<Cm>1.0e-12</Cm>\n"
+        << "\t\t<Cf>0.01e-12</Cf>\n"
+        << "\t\t<VDD>1</VDD>\n"
+        << "\t\t<VTh>" << (spec.vth > 0.0 ? spec.vth : 0.6) << "</VTh>\n"
+        << "\t\t<dt>0.001</dt>\n"
+        << "\t\t<IR>100.0e-12</IR>\n"
+        << "\t</LIFNetwork>\n"
+        << "\t<Architecture>\n";
+    for (std::size_t l = 0; l < spec.layers.size(); ++l)
+    {
+        if (l > 0)
+        {
+            // Y-Flash between layers: [previous layer][this layer]
+            const std::size_t fanIn = spec.layers[l - 1];
+            const bool defaultRange = spec.weightMax <= spec.weightMin;
+            WeightSource weights(rng, spec.sparsity, defaultRange ? 0.0 : spec.weightMin,
+                                 defaultRange ? 8e-10 / static_cast<double>(fanIn) : spec.weightMax, false);
+            xml << "\t\t<YFlash rows=\"" << fanIn << "\" cols=\"" << spec.layers[l] << "\">\n"
+                << "\t\t\t<weights>\n";
+            writeRows(xml, "\t\t\t\t", fanIn, spec.layers[l], weights);
+            xml << "\t\t\t</weights>\n"
+                << "\t\t</YFlash>\n";
+        }
+        xml << "\t\t<Layer size=\"" << spec.layers[l] << "\"/>\n";
+    }
+    xml << "\t</Architecture>\n"
+        << "</NetworkConfig>\n";
+
+    // one input current per first-layer neuron and line
+    for (std::size_t s = 0; s < spec.samples; ++s)
+    {
+        for (std::size_t n = 0; n < spec.layers[0]; ++n)
+            input << (n ? " " : "") << (rng.uniform() < spec.activity ? spec.current : 0.0);
+        input << "\n";
+    }
+}
+
+void writeAnn(const SyntheticSpec& spec, Rng& rng, std::ostream& xml, std::ostream& input)
+{
+    const bool defaultRange = spec.weightMax <= spec.weightMin;
+    WeightSource weights(rng, spec.sparsity, defaultRange ? 0.0 : spec.weightMin, defaultRange ? 1.0 : spec.weightMax, false);
+
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<NetworkConfig type=\"ANNNetwork\">\n"
+        << "\t<ANNNetwork>\n"
+        << "\t\t<VDD>1.8</VDD>\n"
+        << "\t\t<ClockHz>6.667e7</ClockHz>\n"
+        << "\t\t<BitSerialBits>" << spec.bits << "</BitSerialBits>\n"
+        << "\t\t<Mux>\n"
+        << "\t\t\t<FanIn>8</FanIn>\n"
+        << "\t\t\t<ShareAcrossColumns>true</ShareAcrossColumns>\n"
+        << "\t\t</Mux>\n"
+        << "\t\t<VTC>\n"
+        << "\t\t\t<C>1.0e-14</C>\n"
+        << "\t\t\t<Idis>1.0e-6</Idis>\n"
+        << "\t\t\t<Vth>0.1</Vth>\n"
+        << "\t\t\t<T0>1.0e-8</T0>\n"
+        << "\t\t\t<dtLSB>2.1094e-10</dtLSB>\n"
+        << "\t\t</VTC>\n"
+        << "\t\t<TDC>\n"
+        << "\t\t\t<Bits>6</Bits>\n"
+        << "\t\t</TDC>\n"
+        << "\t\t<DSA>\n"
+        << "\t\t\t<OutBits>" << spec.bits + 8 << "</OutBits>\n"
+        << "\t\t</DSA>\n"
+        << "\t</ANNNetwork>\n"
+        << "\t<Architecture>\n";
+    for (std::size_t p = 0; p < spec.pes; ++p)
+    {
+        xml << "\t\t<PE id=\"" << p << "\">\n"
+            << "\t\t\t<YFlash rows=\"" << spec.rows << "\" cols=\"" << spec.cols << "\" signed=\"false\">\n"
+            << "\t\t\t\t<weights pos=\"true\">\n";
+        writeRows(xml, "\t\t\t\t\t", spec.rows, spec.cols, weights);
+        xml << "\t\t\t\t</weights>\n"
+            << "\t\t\t</YFlash>\n"
+            << "\t\t</PE>\n";
+    }
+    xml << "\t</Architecture>\n"
+        << "</NetworkConfig>\n";
+
+    // per PE, bit-planes MSB -> LSB of rows x cols activation bits
+    for (std::size_t p = 0; p < spec.pes; ++p)
+    {
+        for (int b = spec.bits - 1; b >= 0; --b)
+        {
+            input << "# PE " << p << ", bit " << b << "\n";
+            for (std::size_t r = 0; r < spec.rows; ++r)
+            {
+                for (std::size_t c = 0; c < spec.cols; ++c)
+                    input << (c ? " " : "") << (rng.uniform() < spec.activity ? 1 : 0);
+                input << "\n";
+            }
+            input << "\n";
+        }
+    }
+}
+
+void checkSpec(const SyntheticSpec& spec)
+{
+    if (spec.type == NetworkTypes::ANNNetworkType)
+    {
+        if (spec.pes == 0 || spec.rows == 0 || spec.cols == 0)
+            throw std::runtime_error("Generator Error: an ANN network needs pes, rows and cols > 0");
+        if (spec.bits < 1 || spec.bits > 16)
+            throw std::runtime_error("Generator Error: bits must be between 1 and 16");
+    }
+    else
+    {
+        if (spec.layers.empty())
+            throw std::runtime_error("Generator Error: no layers given");
+        for (std::size_t size : spec.layers)
+            if (size == 0)
+                throw std::runtime_error("Generator Error: layer sizes must be > 0");
+        if (spec.type == NetworkTypes::BIUNetworkType && spec.inputs == 0)
+            throw std::runtime_error("Generator Error: a BIU network needs inputs > 0");
+        if (spec.samples == 0)
+            throw std::runtime_error("Generator Error: samples must be > 0");
+    }
+    if (spec.sparsity < 0.0 || spec.sparsity > 1.0)
+        throw std::runtime_error("Generator Error: sparsity must be between 0 and 1");
+    if (spec.activity < 0.0 || spec.activity > 1.0)
+        throw std::runtime_error("Generator Error: activity must be between 0 and 1");
+}
+
+} // namespace
+
+SyntheticFiles writeSyntheticNetwork(const SyntheticSpec& spec, const std::string& directory)
+{
+    checkSpec(spec);
+    if (!makeDirectory(directory))
+        throw std::runtime_error("Generator Error: cannot create directory " + directory);
+
+    SyntheticFiles files;
+    files.network = directory + "/network.xml";
+    files.input = directory + "/input.txt";
+    files.config = directory + "/config.json";
+
+    Rng rng(spec.seed);
+    {
+        std::ofstream xml = openOutput(files.network);
+        std::ofstream input = openOutput(files.input);
+        switch (spec.type)
+        {
+        case NetworkTypes::BIUNetworkType: writeBiu(spec, rng, xml, input); break;
+        case NetworkTypes::LIFNetworkType: writeLif(spec, rng, xml, input); break;
+        case NetworkTypes::ANNNetworkType: writeAnn(spec, rng, xml, input); break;
+        }
+        if (!xml || !input)
+            throw std::runtime_error("Generator Error: failed writing to " + directory);
+    }
+
+    std::ofstream config = openOutput(files.config);
+    config << "{\n"
+           << "  \"output_directory\": \"" << directory << "/output\",\n"
+           << "  \"xml_config_path\": \"" << files.network << "\",\n"
+           << "  \"data_input_file\": \"" << files.input << "\",\n";
+    if (spec.type == NetworkTypes::BIUNetworkType && !spec.energyDir.empty())
+    {
+        config << "  \"synapses_energy_table_path\": \"" << spec.energyDir << "/Spike-in_vs_Not_spike-in.csv\",\n"
+               << "  \"neuron_energy_table_path\": \"" << spec.energyDir << "/Energy_Neuron_CSV_Content.csv\",\n";
+    }
+    config << "  \"verbosity\": \"info\",\n"
+           << "  \"progress_interval_seconds\": 2\n"
+           << "}\n";
+    return files;
+}
+
+// ---------------- command-line options ----------------
+
+static double optionNumber(const std::string& option, const char* value)
+{
+    char* end = nullptr;
+    double v = std::strtod(value, &end);
+    if (end == value || *end != '\0' || !std::isfinite(v))
+        throw std::runtime_error("Generator Error: invalid value '" + std::string(value) + "' for " + option);
+    return v;
+}
+
+static std::size_t optionCount(const std::string& option, const char* value)
+{
+    double v = optionNumber(option, value);
+    if (v < 0 || v != std::floor(v))
+        throw std::runtime_error("Generator Error: " + option + " must be a non-negative integer");
+    return static_cast<std::size_t>(v);
+}
+
+int parseSyntheticOption(int argc, char* argv[], int i, SyntheticSpec& spec)
+{
+    const std::string option = argv[i];
+    static const char* const kOptions[] = { "--type", "--layers", "--inputs", "--pes", "--rows", "--cols", "--bits",
+                                            "--sparsity", "--weight-min", "--weight-max", "--vth", "--samples",
+                                            "--activity", "--current", "--seed", "--energy-dir" };
+    bool known = false;
+    for (const char* name : kOptions)
+        known = known || option == name;
+    if (!known)
+        return 0;
+    if (i + 1 >= argc)
+        throw std::runtime_error("Generator Error: " + option + " needs a value");
+    const char* value = argv[i + 1];
+
+    if (option == "--type")
+    {
+        const std::string type = value;
+        if (type == "biu")      spec.type = NetworkTypes::BIUNetworkType;
+        else if (type == "lif") spec.type = NetworkTypes::LIFNetworkType;
+        else if (type == "ann") spec.type = NetworkTypes::ANNNetworkType;
+        else throw std::runtime_error("Generator Error: unknown network type '" + type + "' (expected biu, lif or ann)");
+    }
+    else if (option == "--layers")
+    {
+        // comma-separated neurons per layer, e.g. 256,128,10
+        spec.layers.clear();
+        std::stringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ','))
+            spec.layers.push_back(optionCount(option, item.c_str()));
+    }
+    else if (option == "--inputs")     spec.inputs = optionCount(option, value);
+    else if (option == "--pes")        spec.pes = optionCount(option, value);
+    else if (option == "--rows")       spec.rows = optionCount(option, value);
+    else if (option == "--cols")       spec.cols = optionCount(option, value);
+    else if (option == "--bits")       spec.bits = static_cast<int>(optionCount(option, value));
+    else if (option == "--sparsity")   spec.sparsity = optionNumber(option, value);
+    else if (option == "--weight-min") spec.weightMin = optionNumber(option, value);
+    else if (option == "--weight-max") spec.weightMax = optionNumber(option, value);
+    else if (option == "--vth")        spec.vth = optionNumber(option, value);
+    else if (option == "--samples")    spec.samples = optionCount(option, value);
+    else if (option == "--activity")   spec.activity = optionNumber(option, value);
+    else if (option == "--current")    spec.current = optionNumber(option, value);
+    else if (option == "--seed")       spec.seed = static_cast<std::uint64_t>(optionCount(option, value));
+    else if (option == "--energy-dir") spec.energyDir = value;
+    return 2;
+}
+
+const char* syntheticOptionsUsage()
+{
+    return "  --type biu|lif|ann        network type (default biu)\n"
+           "  --layers N,N,...          BIU/LIF neurons per layer (default 64,64,10)\n"
+           "  --inputs N                BIU DS inputs of the first layer (default 64)\n"
+           "  --pes N --rows N --cols N ANN processing elements and Y-Flash size (default 4, 64x64)\n"
+           "  --bits N                  ANN bit-serial bits (default 8)\n"
+           "  --sparsity F              fraction of zero weights (default 0)\n"
+           "  --weight-min F --weight-max F  weight range (default per type)\n"
+           "  --vth F                   BIU/LIF threshold voltage (default 0.05 / 0.6)\n"
+           "  --samples N               BIU/LIF input lines (default 1000)\n"
+           "  --activity F              fraction of active stimulus entries (default 0.1)\n"
+           "  --current F               LIF input current of a driven neuron (default 2e-10)\n"
+           "  --seed N                  random seed (default 1)\n"
+           "  --energy-dir DIR          BIU energy CSVs referenced by config.json\n";
+}
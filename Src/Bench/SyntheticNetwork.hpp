@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * @file SyntheticNetwork.hpp
+ * @brief Synthetic BIU, LIF and ANN networks with matching stimulus files, for scaling runs.
+ *
+ * writeSyntheticNetwork() writes three files into a directory:
+ *
+ *     network.xml   the network (random weights from a fixed seed)
+ *     input.txt     the stimulus, `samples` lines (BIU DS codes, LIF currents) or one set of
+ *                   bit-planes per PE (ANN)
+ *     config.json   a run configuration for NEMOSIM / Session, output in <directory>/output
+ *
+ * Size and shape:
+ *   BIU  `layers` neurons per layer, `inputs` DS inputs feeding the first layer
+ *   LIF  `layers` neurons per layer; the first layer takes one input current per neuron
+ *   ANN  `pes` processing elements of `rows` x `cols` Y-Flash cells, `bits` bit-planes each
+ *
+ * `sparsity` is the fraction of weights set to zero. The other weights are uniform in
+ * [weightMin, weightMax]; when unset: BIU integers 1..8, LIF 0..8e-10 / fan-in conductances
+ * (so a layer's input current stays in the range the neurons react to), ANN 0..1.
+ * `activity` is the fraction of active stimulus entries: non-zero DS codes (BIU), neurons
+ * driven with `current` (LIF) or 1 bits (ANN).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "networkParams.hpp"
+
+struct SyntheticSpec
+{
+    NetworkTypes type = NetworkTypes::BIUNetworkType;
+    std::vector<std::size_t> layers{ 64, 64, 10 }; // BIU / LIF neurons per layer
+    std::size_t inputs = 64;                       // BIU: DS inputs of the first layer
+    std::size_t pes = 4, rows = 64, cols = 64;     // ANN
+    int bits = 8;                                  // ANN bit-serial bits
+
+    double sparsity = 0.0;     // fraction of zero weights
+    double weightMin = 0.0;
+    double weightMax = 0.0;    // weightMax <= weightMin: the per-type default range
+    double vth = 0.0;          // BIU / LIF threshold; 0 = default (BIU 0.05 V, LIF 0.6 V)
+
+    std::size_t samples = 1000; // BIU / LIF input lines
+    double activity = 0.1;      // fraction of active stimulus entries
+    double current = 2e-10;     // LIF: input current of a driven neuron (A)
+    std::uint64_t seed = 1;
+
+    std::string energyDir;      // BIU: directory of the energy CSVs referenced by config.json
+};
+
+/// Paths of the files written by writeSyntheticNetwork().
+struct SyntheticFiles
+{
+    std::string config;
+    std::string network;
+    std::string input;
+};
+
+/// Writes network.xml, input.txt and config.json into `directory` (created if needed).
+/// Throws std::runtime_error ("Generator Error: ...") on an invalid spec or I/O failure.
+SyntheticFiles writeSyntheticNetwork(const SyntheticSpec& spec, const std::string& directory);
+
+/// Reads generator option argv[i] (and its value) into `spec`. Returns the number of
+/// arguments used, 0 if argv[i] is not a generator option. Throws on an invalid value.
+int parseSyntheticOption(int argc, char* argv[], int i, SyntheticSpec& spec);
+
+/// Usage text of the generator options.
+const char* syntheticOptionsUsage();
@@ -0,0 +1,561 @@
+/**
+ * @file nemosim_bench.cpp
+ * @brief Microbenchmarks of the simulator hot paths, reported as JSON.
+ *
+ *     nemosim_bench [--filter <text>] [--min-time <seconds>] [--out <file>]
+ *                   [--energy-dir <dir>] [--list]
+ *
+ * Every benchmark runs over a matrix of sizes and input densities (fraction of spiking
+ * inputs / non-zero values). Inputs are generated from a fixed seed, so two builds measure
+ * the same work. A case is timed in batches that are grown until one batch lasts
+ * min-time / 5; the best of five batches is reported as ns per operation, along with the
+ * items (synapses, cells, ticks, values) one operation processes.
+ *
+ * The JSON document ("schema": "nemosim-bench/1") goes to stdout or --out; progress goes
+ * to stderr. Compare two documents case by case (benchmark + params) to follow regressions.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../BIUNetwork/BIUNeuron.hpp"
+#include "../BIUNetwork/BIULayer.hpp"
+#include "../BIUNetwork/BIUNetwork.hpp"
+#include "../BIUNetwork/EnergyTable.hpp"
+#include "../DS/DS.hpp"
+#include "../YFlash/YFlash.hpp"
+#include "../YFlash/ANNYFlash.hpp"
+#include "../ANNNetwork/ANNNetwork.hpp"
+#include "../Common/NumberParser.hpp"
+#include "../Common/WeightMatrix.hpp"
+
+extern bool g_ann_imc_trace; // ANNNetwork.cpp: per-column [FIRE] printout of PE::computeBitwise
+
+namespace {
+
+volatile double g_sink = 0.0; // keeps the measured results alive
+
+struct Options
+{
+    std::string filter;
+    double minTime = 0.2;
+    std::string outPath;
+    std::string energyDir = NEMOSIM_BENCH_ENERGY_DIR;
+    bool list = false;
+};
+
+struct Param
+{
+    std::string key;
+    double value;
+};
+
+struct Result
+{
+    std::string benchmark;
+    std::vector<Param> params;
+    std::uint64_t iterations = 0;  // operations per timed batch
+    double nsPerOp = 0.0;
+    double itemsPerOp = 0.0;
+    std::string item;
+};
+
+// splitmix64: deterministic inputs, identical on every platform
+class Rng
+{
+public:
+    explicit Rng(std::uint64_t seed) : m_state(seed) {}
+    std::uint64_t next()
+    {
+        std::uint64_t x = (m_state += 0x9E3779B97F4A7C15ull);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+    int below(int n) { return static_cast<int>(next() % static_cast<std::uint64_t>(n)); }
+
+private:
+    std::uint64_t m_state;
+};
+
+class Bench
+{
+public:
+    explicit Bench(const Options& options) : m_options(options) {}
+
+    /// Times `op` (returns a value to keep) unless the filter excludes `benchmark`.
+    template <typename Op>
+    void run(const std::string& benchmark, std::vector<Param> params, double itemsPerOp,
+             const std::string& item, Op op)
+    {
+        if (!m_options.filter.empty() && benchmark.find(m_options.filter) == std::string::npos)
+            return;
+        if (m_options.list)
+        {
+            std::cout << benchmark << label_(params) << "\n";
+            return;
+        }
+
+        Result result;
+        result.benchmark = benchmark;
+        result.params = std::move(params);
+        result.itemsPerOp = itemsPerOp;
+        result.item = item;
+
+        const double target = m_options.minTime / 5.0;
+        std::uint64_t n = 1;
+        double seconds = time_(op, n);
+        while (seconds < target && n < (1ull << 40))
+        {
+            double grow = seconds > 0.0 ? 1.5 * target / seconds : 100.0;
+            n = static_cast<std::uint64_t>(static_cast<double>(n) * std::min(100.0, std::max(2.0, grow)));
+            seconds = time_(op, n);
+        }
+        double best = seconds;
+        for (int sample = 1; sample < 5; ++sample)
+            best = std::min(best, time_(op, n));
+
+        result.iterations = n;
+        result.nsPerOp = best * 1e9 / static_cast<double>(n);
+        std::cerr << benchmark << label_(result.params) << ": " << result.nsPerOp << " ns/op" << std::endl;
+        m_results.push_back(std::move(result));
+    }
+
+    const std::vector<Result>& results() const { return m_results; }
+    bool listing() const { return m_options.list; }
+
+private:
+    const Options& m_options;
+    std::vector<Result> m_results;
+
+    template <typename Op>
+    static double time_(Op& op, std::uint64_t n)
+    {
+        double keep = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < n; ++i)
+            keep += op();
+        const auto stop = std::chrono::steady_clock::now();
+        g_sink = g_sink + keep;
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    static std::string label_(const std::vector<Param>& params)
+    {
+        std::ostringstream s;
+        for (const auto& p : params)
+            s << " " << p.key << "=" << p.value;
+        return s.str();
+    }
+};
+
+const double kDensities[] = { 0.01, 0.1, 0.5 };
+
+// BIU synapse weights are small integers (the energy table has one row per weight value)
+WeightMatrix randomBiuWeights(Rng& rng, std::size_t rows, std::size_t cols)
+{
+    std::vector<double> values(rows * cols);
+    for (auto& v : values)
+        v = static_cast<double>(rng.below(9));
+    return WeightMatrix(rows, cols, std::move(values));
+}
+
+WeightMatrix randomConductances(Rng& rng, std::size_t rows, std::size_t cols)
+{
+    std::vector<double> values(rows * cols);
+    for (auto& v : values)
+        v = rng.uniform();
+    return WeightMatrix(rows, cols, std::move(values));
+}
+
+// `count` input vectors of 0/1 spikes with the given density
+std::vector<std::vector<double>> spikeInputs(Rng& rng, std::size_t width, double density, std::size_t count)
+{
+    std::vector<std::vector<double>> inputs(count, std::vector<double>(width, 0.0));
+    for (auto& input : inputs)
+        for (auto& x : input)
+            x = rng.uniform() < density ? 1.0 : 0.0;
+    return inputs;
+}
+
+// ---------------- BIU ----------------
+
+void benchBiuNeuron(Bench& bench, EnergyTable& energy)
+{
+    for (std::size_t synapses : { 16, 64, 256, 1024 })
+    {
+        for (double density : kDensities)
+        for (bool lut : { false, true })
+        {
+            if (lut && synapses > BasicBIUPatternCache<double>::kMaxInputs)
+                continue;
+            Rng rng(synapses * 1000 + static_cast<std::uint64_t>(density * 100));
+            const WeightMatrix weights = randomBiuWeights(rng, 1, synapses);
+            const auto inputs = spikeInputs(rng, synapses, density, 64);
+            BIUNeuron neuron(0.6, 1.2, 2, 170e-15, 0.6e-15, 5.5e-15, 1e6, weights[0], &energy);
+            BasicBIUPatternCache<double> patterns;
+            if (lut)
+                neuron.setPatternTable(patterns.get(neuron));
+            std::vector<double> vns, spikes, vins;
+            std::size_t cycle = 0;
+
+            // one cycle: new synaptic inputs, then the membrane update
+            bench.run("BIUNeuron::update", { { "synapses", double(synapses) }, { "density", density },
+                                             { "lut", lut ? 1.0 : 0.0 } },
+                      double(synapses), "synapse", [&]() {
+                neuron.setSynapticInputs(inputs[cycle & 63]);
+                neuron.accumulateSynapticEnergy();
+                double fired = neuron.update() ? 1.0 : 0.0;
+                if ((++cycle & 1023) == 0)
+                    neuron.takeTraces(vns, spikes, vins); // bound the trace memory
+                return fired;
+            });
+        }
+    }
+}
+
+void benchBiuLayer(Bench& bench, EnergyTable& energy)
+{
+    const std::size_t shapes[][2] = { { 16, 16 }, { 64, 64 }, { 256, 256 }, { 1024, 256 } };
+    for (const auto& shape : shapes)
+    {
+        const std::size_t neurons = shape[0], inputsPerNeuron = shape[1];
+        for (double density : kDensities)
+        for (Precision precision : { Precision::Double, Precision::Float, Precision::Fixed })
+        for (unsigned threads : { 1u, 4u })
+        {
+            if (threads > 1 && precision != Precision::Double)
+                continue; // the scheduler does not depend on the precision
+            Rng rng(neurons * 7919 + inputsPerNeuron + static_cast<std::uint64_t>(density * 100));
+            const WeightMatrix weights = randomBiuWeights(rng, neurons, inputsPerNeuron);
+            const auto inputs = spikeInputs(rng, inputsPerNeuron, density, 64);
+            BIULayer layer(static_cast<int>(neurons), 0.6, 1.2, 2, 170e-15, 0.6e-15, 5.5e-15, 1e6, weights, &energy);
+            layer.setPrecision(precision);
+            std::unique_ptr<TaskScheduler> scheduler(threads > 1 ? new TaskScheduler(threads) : nullptr);
+            layer.setScheduler(scheduler.get());
+            std::vector<double> vns, spikes, vins;
+            std::size_t cycle = 0;
+
+            bench.run("BIULayer::update", { { "neurons", double(neurons) }, { "inputs", double(inputsPerNeuron) }, { "density", density },
+                                            { "float", precision == Precision::Float ? 1.0 : 0.0 },
+                                            { "fixed", precision == Precision::Fixed ? 1.0 : 0.0 },
+                                            { "threads", double(threads) } },
+                      double(neurons * inputsPerNeuron), "synapse", [&]() {
+                layer.setInputs(inputs[cycle & 63]);
+                std::vector<uint8_t> fired = layer.update();
+                if ((++cycle & 1023) == 0)
+                    for (std::size_t n = 0; n < neurons; ++n)
+                        layer.takeTraces(static_cast<int>(n), vns, spikes, vins);
+                return double(fired.empty() ? 0 : fired[0]);
+            });
+        }
+    }
+}
+
+void benchDs(Bench& bench)
+{
+    for (DS::Mode mode : { DS::ThresholdMode, DS::FrequencyMode })
+    for (unsigned bits : { 4u, 8u })
+    {
+        for (unsigned code : { 1u, 4u, 8u, 15u })
+        {
+            DS ds(10.0, bits, mode);
+            ds.setCode(code);
+            bench.run("DS::tick", { { "mode", double(mode) }, { "bits", double(bits) }, { "code", double(code) } }, 1.0, "tick",
+                      [&]() { return ds.tick() ? 1.0 : 0.0; });
+        }
+    }
+}
+
+void benchEnergyTable(Bench& bench, EnergyTable& energy)
+{
+    Rng rng(42);
+    std::vector<int> weights(4096), spikeRates(4096);
+    std::vector<double> vths(4096), vns(4096);
+    for (std::size_t i = 0; i < 4096; ++i)
+    {
+        weights[i] = rng.below(9);
+        spikeRates[i] = rng.below(2);
+        vths[i] = 0.1 * (1 + rng.below(10));
+        vns[i] = 1.2 * rng.uniform();
+    }
+
+    std::size_t i = 0;
+    bench.run("EnergyTable::getSynapseEnergy", {}, 1.0, "lookup", [&]() {
+        i = (i + 1) & 4095;
+        return energy.getSynapseEnergy(weights[i], spikeRates[i]);
+    });
+    bench.run("EnergyTable::getNeuronEnergy", {}, 1.0, "lookup", [&]() {
+        i = (i + 1) & 4095;
+        return energy.getNeuronEnergy(vths[i], vns[i]);
+    });
+}
+
+// ---------------- Y-Flash / ANN ----------------
+
+const std::size_t kArraySizes[] = { 16, 64, 256, 1024 };
+
+void benchYFlash(Bench& bench)
+{
+    for (std::size_t size : kArraySizes)
+    {
+        for (double density : kDensities)
+        for (Precision precision : { Precision::Double, Precision::Float })
+        {
+            Rng rng(size * 31 + static_cast<std::uint64_t>(density * 100));
+            YFlash array(randomConductances(rng, size, size), 0);
+            array.setPrecision(precision);
+            auto inputs = spikeInputs(rng, size, density, 16);
+            std::size_t k = 0;
+
+            bench.run("YFlash::step", { { "rows", double(size) }, { "cols", double(size) }, { "density", density },
+                                        { "float", precision == Precision::Float ? 1.0 : 0.0 } },
+                      double(size * size), "cell", [&]() {
+                std::vector<double> currents = array.step(inputs[k++ & 15]);
+                return currents[0];
+            });
+        }
+    }
+}
+
+std::vector<std::vector<std::vector<uint8_t>>> activationMasks(Rng& rng, std::size_t rows, std::size_t cols, double density, std::size_t count)
+{
+    std::vector<std::vector<std::vector<uint8_t>>> masks(count, std::vector<std::vector<uint8_t>>(rows, std::vector<uint8_t>(cols, 0)));
+    for (auto& mask : masks)
+        for (auto& row : mask)
+            for (auto& bit : row)
+                bit = rng.uniform() < density ? 1 : 0;
+    return masks;
+}
+
+void benchAnn(Bench& bench)
+{
+    NetworkParameters params;
+    params.annVtcC = 1e-12;
+    params.annVtcIdis = 1e-6;
+    params.annVtcVth = 0.5;
+    params.annVtcT0 = 10e-9;
+    params.annVtcDtLSB = 1e-9;
+    params.annTdcBits = 6;
+
+    for (std::size_t size : kArraySizes)
+    {
+        for (double density : kDensities)
+        {
+            Rng rng(size * 131 + static_cast<std::uint64_t>(density * 100));
+            NetworkParameters::PEBlock block;
+            block.id = 0;
+            block.yflash.rows = static_cast<int>(size);
+            block.yflash.cols = static_cast<int>(size);
+            block.yflash.isSigned = true;
+            block.yflash.Wpos = randomConductances(rng, size, size);
+            block.yflash.Wneg = randomConductances(rng, size, size);
+            const auto masks = activationMasks(rng, size, size, density, 4);
+
+            ANNYFlash array(block.yflash.Wpos, block.yflash.Wneg);
+            std::size_t k = 0;
+            bench.run("ANNYFlash::bitwise_pmac", { { "rows", double(size) }, { "cols", double(size) }, { "density", density } },
+                      double(size * size), "cell", [&]() {
+                std::vector<double> pmac = array.bitwise_pmac(masks[k++ & 3]);
+                return pmac[0];
+            });
+
+            PE pe(block, params);
+            bench.run("PE::computeBitwise", { { "rows", double(size) }, { "cols", double(size) }, { "density", density } },
+                      double(size * size), "cell", [&]() {
+                std::vector<double> codes = pe.computeBitwise(masks[k++ & 3]);
+                return codes[0];
+            });
+        }
+    }
+}
+
+// ---------------- input parsing ----------------
+
+// Lines of DS codes (0..15) as they appear in BIU input files; `density` of them non-zero.
+std::vector<std::string> inputLines(Rng& rng, std::size_t width, double density, std::size_t count)
+{
+    std::vector<std::string> lines(count);
+    for (auto& line : lines)
+    {
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            line += (i ? " " : "");
+            line += std::to_string(rng.uniform() < density ? 1 + rng.below(15) : 0);
+        }
+    }
+    return lines;
+}
+
+void benchParsing(Bench& bench)
+{
+    for (std::size_t width : { 16, 256, 4096 })
+    {
+        for (double density : { 0.1, 0.5 })
+        {
+            Rng rng(width * 17 + static_cast<std::uint64_t>(density * 100));
+            const auto lines = inputLines(rng, width, density, 16);
+            std::vector<double> values;
+            std::size_t k = 0;
+
+            bench.run("BIUNetwork::parseInputLine", { { "values", double(width) }, { "density", density } },
+                      double(width), "value", [&]() {
+                values.clear();
+                const std::size_t lineNumber = ++k;
+                BIUNetwork::parseInputLine(lines[lineNumber & 15], lineNumber, values);
+                return values[0];
+            });
+
+            bench.run("parseNumberRow", { { "values", double(width) }, { "density", density } },
+                      double(width), "value", [&]() {
+                values.clear();
+                parseNumberRow(lines[k++ & 15].c_str(), values);
+                return values[0];
+            });
+        }
+    }
+}
+
+// ---------------- JSON report ----------------
+
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) { char buf[8]; std::snprintf(buf, sizeof buf, "\\u%04x", c); out += buf; }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+std::string jsonNumber(double v)
+{
+    std::ostringstream s;
+    s.precision(9);
+    s << v;
+    return s.str();
+}
+
+void writeReport(std::ostream& out, const Options& options, bool energyTables, const std::vector<Result>& results)
+{
+    char timestamp[32] = "";
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof timestamp, "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n";
+    out << "  \"schema\": \"nemosim-bench/1\",\n";
+    out << "  \"timestamp\": " << jsonString(timestamp) << ",\n";
+#if defined(__VERSION__)
+    out << "  \"compiler\": " << jsonString(__VERSION__) << ",\n";
+#elif defined(_MSC_FULL_VER)
+    out << "  \"compiler\": " << jsonString("MSVC " + std::to_string(_MSC_FULL_VER)) << ",\n";
+#endif
+    out << "  \"build_type\": " << jsonString(NEMOSIM_BENCH_BUILD_TYPE) << ",\n";
+    out << "  \"min_time_s\": " << jsonNumber(options.minTime) << ",\n";
+    out << "  \"energy_tables\": " << (energyTables ? "true" : "false") << ",\n";
+    out << "  \"results\": [";
+    for (std::size_t r = 0; r < results.size(); ++r)
+    {
+        const Result& result = results[r];
+        out << (r ? "," : "") << "\n    { \"benchmark\": " << jsonString(result.benchmark) << ", \"params\": {";
+        for (std::size_t p = 0; p < result.params.size(); ++p)
+            out << (p ? ", " : " ") << jsonString(result.params[p].key) << ": " << jsonNumber(result.params[p].value);
+        out << (result.params.empty() ? "}" : " }");
+        out << ", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": " << jsonNumber(result.nsPerOp)
+            << ", \"items_per_op\": " << jsonNumber(result.itemsPerOp)
+            << ", \"item\": " << jsonString(result.item)
+            << ", \"items_per_second\": " << jsonNumber(result.itemsPerOp * 1e9 / result.nsPerOp) << " }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void usage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [--filter <text>] [--min-time <seconds>] [--out <file>] [--energy-dir <dir>] [--list]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue)          options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue)   options.minTime = std::atof(argv[++i]);
+        else if (arg == "--out" && hasValue)        options.outPath = argv[++i];
+        else if (arg == "--energy-dir" && hasValue) options.energyDir = argv[++i];
+        else if (arg == "--list")                   options.list = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.minTime <= 0.0)
+    {
+        std::cerr << "Error: --min-time must be positive." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        g_ann_imc_trace = false;
+
+        // the real energy tables, so lookups take the same paths as in a simulation
+        EnergyTable energy;
+        bool energyTables = energy.loadSynapseEnergyCSV(options.energyDir + "/Spike-in_vs_Not_spike-in.csv") &&
+                            energy.loadNeuronEnergyCSV(options.energyDir + "/Energy_Neuron_CSV_Content.csv");
+        if (!energyTables && !options.list)
+            std::cerr << "Warning: energy tables not found in " << options.energyDir << "; lookups return 0." << std::endl;
+
+        Bench bench(options);
+        benchBiuNeuron(bench, energy);
+        benchBiuLayer(bench, energy);
+        benchDs(bench);
+        benchEnergyTable(bench, energy);
+        benchYFlash(bench);
+        benchAnn(bench);
+        benchParsing(bench);
+
+        if (bench.listing())
+            return 0;
+
+        if (options.outPath.empty())
+        {
+            writeReport(std::cout, options, energyTables, bench.results());
+        }
+        else
+        {
+            std::ofstream out(options.outPath);
+            if (!out.is_open())
+            {
+                std::cerr << "Error: cannot write " << options.outPath << std::endl;
+                return 1;
+            }
+            writeReport(out, options, energyTables, bench.results());
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Standard exception caught: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
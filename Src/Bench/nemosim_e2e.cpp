@@ -0,0 +1,286 @@
+/**
+ * @file nemosim_e2e.cpp
+ * @brief End-to-end throughput of a whole network run, reported as JSON.
+ *
+ *     nemosim_e2e <config.json> [--repeat N] [--out <file>]
+ *     nemosim_e2e --generate <directory> [generator options] [--repeat N] [--out <file>]
+ *
+ * The network of a run configuration (or a synthetic one written by --generate, see
+ * SyntheticNetwork.hpp) is loaded once into a Session; the input file is read into memory
+ * once and run `repeat` times (default 3), each run from the initial state. The fastest
+ * run is reported as:
+ *
+ *     samples/s          input lines (BIU, LIF) or bit-planes (ANN) per second
+ *     neuron-updates/s   BIU: neurons x simulated cycles; LIF: neurons x lines;
+ *                        ANN: column conversions (columns x bit-planes)
+ *     synaptic-events/s  BIU: spikes arriving at a synapse (spike_ins); LIF: spikes x fan-out
+ *                        of the next layer; ANN: Y-Flash cell evaluations
+ *
+ * together with the load time and the peak resident set size. Sessions keep the traces of
+ * a run in memory, so the peak RSS includes one run's traces (NEMOSIM streams them to files).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "Session.hpp"
+#include "SyntheticNetwork.hpp"
+#include "XMLParser.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::uint64_t peakRssBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters))
+        return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);        // bytes
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+struct Workload
+{
+    const char* sample = "line";
+    double samples = 0.0;
+    double neuronUpdates = 0.0;
+    double synapticEvents = 0.0;
+    double neurons = 0.0;
+    double synapses = 0.0;
+};
+
+std::size_t countInputLines(const std::string& text)
+{
+    std::size_t lines = 0;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first != std::string::npos && line[first] != '#')
+            ++lines;
+    }
+    return lines;
+}
+
+Workload measureWorkload(const NetworkParameters& params, const std::string& input, const RunResult& run)
+{
+    Workload w;
+    auto total = [&](const std::string& key) {
+        auto it = run.totals.find(key);
+        return it == run.totals.end() ? 0.0 : it->second;
+    };
+
+    switch (params.networkType)
+    {
+    case NetworkTypes::BIUNetworkType:
+        w.samples = static_cast<double>(countInputLines(input));
+        for (const auto& layer : layerActivity(run))
+            w.neuronUpdates += static_cast<double>(layer.neurons) * static_cast<double>(layer.cycles);
+        w.synapticEvents = total("spike_ins");
+        for (const auto& W : params.allWeights)
+        {
+            w.neurons += static_cast<double>(W.rows());
+            w.synapses += static_cast<double>(W.rows() * W.cols());
+        }
+        break;
+
+    case NetworkTypes::LIFNetworkType:
+        w.samples = static_cast<double>(countInputLines(input));
+        for (std::size_t l = 0; l < params.layerSizes.size(); ++l)
+        {
+            w.neurons += params.layerSizes[l];
+            if (l + 1 < params.layerSizes.size())
+                w.synapticEvents += total("spikes_L" + std::to_string(l)) * params.layerSizes[l + 1];
+        }
+        w.neuronUpdates = w.samples * w.neurons;
+        for (const auto& W : params.YFlashWeights)
+            w.synapses += static_cast<double>(W.rows() * W.cols());
+        break;
+
+    case NetworkTypes::ANNNetworkType:
+        w.sample = "bitplane";
+        for (const auto& pe : params.annPEs)
+        {
+            w.samples += params.annBitSerialBits;
+            w.neuronUpdates += static_cast<double>(pe.yflash.cols) * params.annBitSerialBits;
+            w.synapticEvents += static_cast<double>(pe.yflash.rows) * pe.yflash.cols * params.annBitSerialBits;
+            w.neurons += pe.yflash.cols;
+            w.synapses += static_cast<double>(pe.yflash.rows) * pe.yflash.cols;
+        }
+        break;
+    }
+    return w;
+}
+
+const char* typeName(NetworkTypes type)
+{
+    switch (type)
+    {
+    case NetworkTypes::BIUNetworkType: return "BIU";
+    case NetworkTypes::LIFNetworkType: return "LIF";
+    case NetworkTypes::ANNNetworkType: return "ANN";
+    }
+    return "unknown";
+}
+
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void usage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " <config.json> [--repeat N] [--out <file>]\n"
+              << "       " << argv0 << " --generate <directory> [generator options] [--repeat N] [--out <file>]\n"
+              << "Generator options:\n" << syntheticOptionsUsage();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::string configPath, generateDir, outPath;
+        int repeat = 3;
+        SyntheticSpec spec;
+        spec.energyDir = NEMOSIM_BENCH_ENERGY_DIR;
+
+        for (int i = 1; i < argc;)
+        {
+            const std::string arg = argv[i];
+            int used = parseSyntheticOption(argc, argv, i, spec);
+            if (used > 0)                                  i += used;
+            else if (arg == "--generate" && i + 1 < argc) { generateDir = argv[i + 1]; i += 2; }
+            else if (arg == "--repeat" && i + 1 < argc)   { repeat = std::atoi(argv[i + 1]); i += 2; }
+            else if (arg == "--out" && i + 1 < argc)      { outPath = argv[i + 1]; i += 2; }
+            else if (arg[0] != '-' && configPath.empty()) { configPath = arg; i += 1; }
+            else
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        if (configPath.empty() == generateDir.empty() || repeat < 1)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (!generateDir.empty())
+        {
+            std::cerr << "Generating network in " << generateDir << std::endl;
+            configPath = writeSyntheticNetwork(spec, generateDir).config;
+        }
+
+        // load: configuration, XML (or network image), energy tables
+        const auto loadStart = std::chrono::steady_clock::now();
+        std::unique_ptr<Session> session;
+        {
+            StdoutMute mute; // parser info; stdout carries the JSON report
+            session.reset(new Session(configPath));
+        }
+        const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        const std::uint64_t rssAfterLoad = peakRssBytes();
+
+        XMLParser parser;
+        const std::string inputPath = parser.parseConfigFromFile(configPath).dataInputPath;
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open())
+            throw std::runtime_error("Input Data Error: Failed to open input data file: " + inputPath);
+        std::ostringstream inputText;
+        inputText << inputFile.rdbuf();
+        const std::string input = inputText.str();
+
+        std::vector<double> runSeconds;
+        RunResult last;
+        for (int r = 0; r < repeat; ++r)
+        {
+            std::cerr << "Run " << (r + 1) << "/" << repeat << "..." << std::flush;
+            last = RunResult(); // release the previous run's traces first
+            const auto start = std::chrono::steady_clock::now();
+            {
+                StdoutMute mute; // progress bars and per-run summaries
+                last = session->runText(input);
+            }
+            runSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            std::cerr << " " << runSeconds.back() << " s" << std::endl;
+        }
+
+        const NetworkParameters& params = session->parameters();
+        const Workload w = measureWorkload(params, input, last);
+        const double best = *std::min_element(runSeconds.begin(), runSeconds.end());
+
+        std::ofstream file;
+        if (!outPath.empty())
+        {
+            file.open(outPath);
+            if (!file.is_open())
+                throw std::runtime_error("cannot write " + outPath);
+        }
+        std::ostream& out = outPath.empty() ? std::cout : file;
+        out.precision(9);
+        out << "{\n"
+            << "  \"schema\": \"nemosim-e2e/1\",\n"
+            << "  \"config\": " << jsonString(configPath) << ",\n"
+            << "  \"network\": { \"type\": \"" << typeName(params.networkType) << "\", \"neurons\": " << w.neurons
+            << ", \"synapses\": " << w.synapses << " },\n"
+            << "  \"load_s\": " << loadSeconds << ",\n"
+            << "  \"run_s\": [";
+        for (std::size_t r = 0; r < runSeconds.size(); ++r)
+            out << (r ? ", " : "") << runSeconds[r];
+        out << "],\n"
+            << "  \"sample\": \"" << w.sample << "\",\n"
+            << "  \"samples\": " << w.samples << ",\n"
+            << "  \"neuron_updates\": " << w.neuronUpdates << ",\n"
+            << "  \"synaptic_events\": " << w.synapticEvents << ",\n"
+            << "  \"samples_per_s\": " << w.samples / best << ",\n"
+            << "  \"neuron_updates_per_s\": " << w.neuronUpdates / best << ",\n"
+            << "  \"synaptic_events_per_s\": " << w.synapticEvents / best << ",\n"
+            << "  \"peak_rss_after_load_bytes\": " << rssAfterLoad << ",\n"
+            << "  \"peak_rss_bytes\": " << peakRssBytes() << "\n"
+            << "}\n";
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Standard exception caught: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file nemosim_gen.cpp
+ * @brief Writes a synthetic network, its stimulus and a run configuration (see SyntheticNetwork.hpp).
+ *
+ *     nemosim_gen <directory> [generator options]
+ *     NEMOSIM <directory>/config.json
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "SyntheticNetwork.hpp"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        std::cerr << "Usage: " << argv[0] << " <directory> [options]\n" << syntheticOptionsUsage();
+        return 1;
+    }
+
+    try
+    {
+        SyntheticSpec spec;
+        spec.energyDir = NEMOSIM_BENCH_ENERGY_DIR;
+        for (int i = 2; i < argc;)
+        {
+            int used = parseSyntheticOption(argc, argv, i, spec);
+            if (used == 0)
+            {
+                std::cerr << "Unknown option " << argv[i] << "\n" << syntheticOptionsUsage();
+                return 1;
+            }
+            i += used;
+        }
+
+        SyntheticFiles files = writeSyntheticNetwork(spec, argv[1]);
+        std::cout << "Wrote " << files.network << "\n"
+                  << "Wrote " << files.input << "\n"
+                  << "Wrote " << files.config << std::endl;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Standard exception caught: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
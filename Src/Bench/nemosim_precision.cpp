@@ -0,0 +1,252 @@
+/**
+ * @file nemosim_precision.cpp
+ * @brief Divergence between the double kernels and the float or fixed-point ones on a
+ *        workload, reported as JSON.
+ *
+ *     nemosim_precision <config.json> [--precision float|fixed] [--input <file>] [--out <file>]
+ *                       [--max-rel-diff <x>]
+ *
+ * The network of a run configuration is loaded once and its input file (or --input) is run
+ * twice in one process, with Precision::Double and the --precision one (default float, see
+ * Precision.hpp); the `precision` key of the configuration is ignored, its fixed_* word
+ * widths are used. Fixed is BIU only. The report compares:
+ *
+ *     totals   every scalar result (energies, spike counts, ...): both values (keyed by
+ *              precision name) and the relative difference
+ *     traces   per trace kind (file name up to the first '_': spikes, vns, vins, vms, ...):
+ *              values compared, values that differ, max and RMS absolute difference,
+ *              the largest reference magnitude and the first differing file and index
+ *
+ * Which traces exist follows the configuration (BIU records Vn and Vin only in Debug
+ * verbosity or through probes). A summary goes to stderr, the JSON document
+ * ("schema": "nemosim-precision/1") to stdout or --out. With --max-rel-diff the exit code
+ * is 2 when a total differs by more than that fraction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Session.hpp"
+#include "XMLParser.hpp"
+
+namespace {
+
+struct TraceDiff
+{
+    std::size_t files = 0;
+    std::size_t values = 0;
+    std::size_t differing = 0;
+    std::size_t lengthMismatches = 0;  // files whose two runs have different lengths
+    double maxAbs = 0.0;
+    double sumSq = 0.0;
+    double maxReference = 0.0;
+    std::string firstFile;             // first differing value, in file-name order
+    std::size_t firstIndex = 0;
+};
+
+std::string traceKind(const std::string& file)
+{
+    const std::size_t underscore = file.find('_');
+    return underscore == std::string::npos ? file : file.substr(0, underscore);
+}
+
+std::map<std::string, TraceDiff> compareTraces(const TraceMap& reference, const TraceMap& other)
+{
+    std::map<std::string, TraceDiff> kinds;
+    const std::vector<double> missing;
+    for (const auto& entry : reference)
+    {
+        TraceDiff& d = kinds[traceKind(entry.first)];
+        ++d.files;
+        auto it = other.find(entry.first);
+        const std::vector<double>& a = entry.second;
+        const std::vector<double>& b = it == other.end() ? missing : it->second;
+        if (a.size() != b.size())
+            ++d.lengthMismatches;
+
+        const std::size_t n = std::min(a.size(), b.size());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double diff = std::fabs(a[i] - b[i]);
+            d.maxReference = std::max(d.maxReference, std::fabs(a[i]));
+            if (diff == 0.0)
+                continue;
+            if (d.differing++ == 0)
+            {
+                d.firstFile = entry.first;
+                d.firstIndex = i;
+            }
+            d.maxAbs = std::max(d.maxAbs, diff);
+            d.sumSq += diff * diff;
+        }
+        d.values += n;
+    }
+    return kinds;
+}
+
+double relativeDiff(double reference, double value)
+{
+    if (reference == value)
+        return 0.0;
+    const double scale = std::max(std::fabs(reference), std::fabs(value));
+    return std::fabs(reference - value) / scale;
+}
+
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void usage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " <config.json> [--precision float|fixed] [--input <file>] [--out <file>] [--max-rel-diff <x>]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string configPath, inputPath, outPath;
+    double maxRelDiff = -1.0;
+    Precision candidate = Precision::Float;
+    for (int i = 1; i < argc;)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc)              { inputPath = argv[i + 1]; i += 2; }
+        else if (arg == "--precision" && i + 1 < argc)
+        {
+            auto it = StringToPrecision.find(argv[i + 1]);
+            if (it == StringToPrecision.end() || it->second == Precision::Double)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            candidate = it->second;
+            i += 2;
+        }
+        else if (arg == "--out" && i + 1 < argc)           { outPath = argv[i + 1]; i += 2; }
+        else if (arg == "--max-rel-diff" && i + 1 < argc)  { maxRelDiff = std::atof(argv[i + 1]); i += 2; }
+        else if (arg[0] != '-' && configPath.empty())      { configPath = arg; i += 1; }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (configPath.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        NetworkParameters params;
+        {
+            StdoutMute mute; // parser info; stdout carries the JSON report
+            params = Session(configPath).parameters();
+        }
+        if (params.networkType == NetworkTypes::ANNNetworkType)
+            throw std::runtime_error("ANN networks run in double only; nothing to compare");
+        if (candidate == Precision::Fixed && params.networkType != NetworkTypes::BIUNetworkType)
+            throw std::runtime_error("fixed precision is only supported by BIU networks");
+
+        if (inputPath.empty())
+        {
+            XMLParser parser;
+            inputPath = parser.parseConfigFromFile(configPath).dataInputPath;
+        }
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open())
+            throw std::runtime_error("Input Data Error: Failed to open input data file: " + inputPath);
+        std::ostringstream inputText;
+        inputText << inputFile.rdbuf();
+        const std::string input = inputText.str();
+
+        RunResult runs[2];
+        const Precision precisions[2] = { Precision::Double, candidate };
+        for (int r = 0; r < 2; ++r)
+        {
+            std::cerr << "Running in " << precisionName(precisions[r]) << "..." << std::endl;
+            params.precision = precisions[r];
+            StdoutMute mute; // progress and per-run summaries
+            runs[r] = Session(params).runText(input);
+        }
+
+        const auto traces = compareTraces(runs[0].traces, runs[1].traces);
+        double worstTotal = 0.0;
+
+        std::ofstream file;
+        if (!outPath.empty())
+        {
+            file.open(outPath);
+            if (!file.is_open())
+                throw std::runtime_error("cannot write " + outPath);
+        }
+        std::ostream& out = outPath.empty() ? std::cout : file;
+        out.precision(9);
+        out << "{\n"
+            << "  \"schema\": \"nemosim-precision/1\",\n"
+            << "  \"config\": " << jsonString(configPath) << ",\n"
+            << "  \"input\": " << jsonString(inputPath) << ",\n"
+            << "  \"precision\": " << jsonString(precisionName(candidate)) << ",\n"
+            << "  \"totals\": {";
+        bool first = true;
+        for (const auto& total : runs[0].totals)
+        {
+            auto it = runs[1].totals.find(total.first);
+            const double other = it == runs[1].totals.end() ? 0.0 : it->second;
+            const double rel = relativeDiff(total.second, other);
+            worstTotal = std::max(worstTotal, rel);
+            out << (first ? "\n" : ",\n") << "    " << jsonString(total.first) << ": { \"double\": " << total.second
+                << ", " << jsonString(precisionName(candidate)) << ": " << other << ", \"rel_diff\": " << rel << " }";
+            std::cerr << "  " << total.first << ": " << total.second << " vs " << other << " (rel. diff " << rel << ")\n";
+            first = false;
+        }
+        out << "\n  },\n  \"traces\": {";
+        first = true;
+        for (const auto& kind : traces)
+        {
+            const TraceDiff& d = kind.second;
+            const double rms = d.values ? std::sqrt(d.sumSq / static_cast<double>(d.values)) : 0.0;
+            out << (first ? "\n" : ",\n") << "    " << jsonString(kind.first) << ": { \"files\": " << d.files
+                << ", \"values\": " << d.values << ", \"differing\": " << d.differing
+                << ", \"length_mismatches\": " << d.lengthMismatches
+                << ", \"max_abs_diff\": " << d.maxAbs << ", \"rms_diff\": " << rms
+                << ", \"max_abs_reference\": " << d.maxReference;
+            if (d.differing)
+                out << ", \"first_diff\": { \"file\": " << jsonString(d.firstFile) << ", \"index\": " << d.firstIndex << " }";
+            out << " }";
+            std::cerr << "  " << kind.first << " traces: " << d.differing << " of " << d.values
+                      << " values differ, max abs diff " << d.maxAbs << "\n";
+            first = false;
+        }
+        out << "\n  },\n  \"max_total_rel_diff\": " << worstTotal << "\n}\n";
+
+        if (maxRelDiff >= 0.0 && worstTotal > maxRelDiff)
+        {
+            std::cerr << "Totals differ by up to " << worstTotal << ", more than " << maxRelDiff << std::endl;
+            return 2;
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Standard exception caught: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,52 +2,195 @@
 #include <iostream>
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <algorithm> // std::min
+#include <cstdio>    // std::rename
+#include <stdexcept>
 
-void BaseNetwork::showProgressBar(std::size_t current, std::size_t total) const
+// ---------------- spike statistics ----------------
+
+void BaseNetwork::startSpikeStats_(const std::vector<std::size_t>& layerSizes, double cycleSeconds)
 {
-    if (total == 0) return;
+    m_spikeStats.reset();
+    if (m_spikeStatsOptions.enabled)
+        m_spikeStats.reset(new SpikeStats(m_spikeStatsOptions, layerSizes, cycleSeconds));
+}
 
-    // Clamp current to total
-    if (current > total) current = total;
+void BaseNetwork::finishSpikeStats_()
+{
+    if (!m_spikeStats)
+        return;
+    if (m_spikeStatsCapture)
+    {
+        std::ostringstream json;
+        m_spikeStats->writeJson(json);
+        *m_spikeStatsCapture = json.str();
+        return;
+    }
+    std::ofstream out(m_spikeStatsOptions.file);
+    if (!out.is_open())
+        throw std::runtime_error("Spike Stats Error: cannot write " + m_spikeStatsOptions.file);
+    m_spikeStats->writeJson(out);
+    std::cout << "Wrote " << m_spikeStatsOptions.file << std::endl;
+}
 
-    // Only redraw when the percentage changes (biggest win)
-    static int lastPercent = -1;
+// ---------------- readout ----------------
 
-    const int barWidth = 50;
-    const double progress = static_cast<double>(current) / static_cast<double>(total);
-    const int percent = static_cast<int>(progress * 100.0);
+void BaseNetwork::setReadoutOptions(const ReadoutOptions& options)
+{
+    m_readoutOptions = options;
+    if (!m_readoutOptions.labelsPath.empty()) m_readoutOptions.labelsPath = absolutePath(m_readoutOptions.labelsPath);
+}
 
-    if (percent == lastPercent) return;
-    lastPercent = percent;
+void BaseNetwork::startReadout_(std::size_t outputs)
+{
+    m_readout.reset();
+    if (m_readoutOptions.mode == ReadoutMode::Off)
+        return;
+    m_readout.reset(new Readout(m_readoutOptions, outputs));
+    m_readout->open(m_traceWriter);
+}
+
+void BaseNetwork::finishReadout_()
+{
+    if (!m_readout)
+        return;
+    m_readout->printSummary(std::cout);
+}
 
-    const int pos = static_cast<int>(barWidth * progress);
+// ---------------- checkpoint / resume ----------------
 
-    std::string bar;
-    bar.reserve(barWidth);
+static const char     kSnapshotMagic[8] = { 'N', 'E', 'M', 'O', 'S', 'N', 'A', 'P' };
+static const uint32_t kSnapshotVersion = 4;
+static const uint32_t kSnapshotEnd = 0x444E4521; // "!END"
 
-    for (int i = 0; i < barWidth; ++i)
-        bar += (i < pos) ? '=' : (i == pos) ? '>' : ' ';
+void BaseNetwork::setCheckpointOptions(const CheckpointOptions& options)
+{
+    m_checkpoint = options;
+    if (!m_checkpoint.path.empty())       m_checkpoint.path = absolutePath(m_checkpoint.path);
+    if (!m_checkpoint.resumeFrom.empty()) m_checkpoint.resumeFrom = absolutePath(m_checkpoint.resumeFrom);
+}
 
-    // Print once (no per-character streaming)
-    std::cout << "\r[" << bar << "] " << percent << " %";
+void BaseNetwork::captureTraces(TraceMap* traces)
+{
+    m_capturesTraces = (traces != nullptr);
+    m_traceWriter.captureTo(traces);
+}
 
-    // Flush only at the end (or if you really need live updates, add std::flush here)
-    if (current == total) {
-        std::cout << "\n";
-        std::cout.flush();
-        lastPercent = -1; // reset for next run
-    }
+void BaseNetwork::discardTraces()
+{
+    m_capturesTraces = true; // streamed per line, then dropped by the writer
+    m_traceWriter.discard();
 }
 
+void BaseNetwork::redirectTraces(const std::string& outputDirectory, const std::string& spoolPrefix)
+{
+    m_redirectsTraces = true;
+    m_traceWriter.setDirectory(absolutePath(outputDirectory));
+    if (!spoolPrefix.empty()) m_traceWriter.spoolTo(absolutePath(spoolPrefix));
+}
 
-std::size_t BaseNetwork::countLines(std::istream& in) const
+bool BaseNetwork::streamsTraces_() const
 {
-    std::size_t lines = 0;
-    std::string tmp;
-    while (std::getline(in, tmp)) ++lines;
+    return m_pipeline.enabled || m_capturesTraces || m_redirectsTraces || !m_checkpoint.path.empty() || !m_checkpoint.resumeFrom.empty();
+}
+
+void BaseNetwork::saveState(SnapshotWriter&) const
+{
+    throw std::runtime_error("Checkpoint Error: this network type does not support checkpointing");
+}
+
+void BaseNetwork::loadState(SnapshotReader&)
+{
+    throw std::runtime_error("Checkpoint Error: this network type does not support checkpointing");
+}
+
+std::size_t BaseNetwork::resumeFromCheckpoint_(std::istream& in)
+{
+    m_linesSinceCheckpoint = 0;
+    m_lastCheckpoint = std::chrono::steady_clock::now();
+    if (m_checkpoint.resumeFrom.empty()) return m_lineOffset;
+
+    std::ifstream file(m_checkpoint.resumeFrom, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Checkpoint Error: cannot open snapshot " + m_checkpoint.resumeFrom);
+
+    SnapshotReader reader(file);
+    char magic[sizeof(kSnapshotMagic)];
+    for (char& c : magic) c = reader.get<char>();
+    if (!std::equal(magic, magic + sizeof(magic), kSnapshotMagic) || reader.get<uint32_t>() != kSnapshotVersion)
+        throw std::runtime_error("Checkpoint Error: " + m_checkpoint.resumeFrom + " is not a snapshot of this version");
+
+    const uint64_t lines = reader.get<uint64_t>();
+    const int64_t offset = reader.get<int64_t>();
+    std::vector<uint64_t> traceSizes;
+    reader.getVector(traceSizes);
+    loadState(reader);
+    if ((reader.get<uint8_t>() != 0) != static_cast<bool>(m_spikeStats))
+        throw std::runtime_error("Checkpoint Error: spike_stats must be set as in the run that wrote " + m_checkpoint.resumeFrom);
+    if (m_spikeStats) m_spikeStats->loadState(reader);
+    if ((reader.get<uint8_t>() != 0) != static_cast<bool>(m_readout))
+        throw std::runtime_error("Checkpoint Error: readout must be set as in the run that wrote " + m_checkpoint.resumeFrom);
+    if (m_readout) m_readout->loadState(reader);
+    if (reader.get<uint32_t>() != kSnapshotEnd)
+        throw std::runtime_error("Checkpoint Error: snapshot " + m_checkpoint.resumeFrom + " is corrupt");
+
     in.clear();
-    in.seekg(0);
-    return lines;
+    if (offset < 0)
+        in.seekg(0, std::ios::end);
+    else
+        in.seekg(static_cast<std::streamoff>(offset));
+    if (!in)
+        throw std::runtime_error("Checkpoint Error: input file is shorter than recorded in the snapshot");
+
+    m_traceWriter.resumeAt(traceSizes);
+    std::cout << "Resuming after input line " << lines << " from " << m_checkpoint.resumeFrom << "\n";
+    return static_cast<std::size_t>(lines);
+}
+
+void BaseNetwork::checkpointIfDue_(const InputLine& line)
+{
+    if (m_checkpoint.path.empty()) return;
+
+    ++m_linesSinceCheckpoint;
+    const auto now = std::chrono::steady_clock::now();
+    const bool dueByLines = m_checkpoint.everyLines > 0 && m_linesSinceCheckpoint >= m_checkpoint.everyLines;
+    const bool dueByTime = m_checkpoint.everySeconds > 0.0 &&
+        std::chrono::duration<double>(now - m_lastCheckpoint).count() >= m_checkpoint.everySeconds;
+    if (!dueByLines && !dueByTime) return;
+
+    // Everything up to this line must be on disk before its sizes are recorded.
+    m_traceWriter.sync();
+
+    // Write next to the old snapshot and swap, so a crash mid-write keeps the previous one.
+    const std::string tmpPath = m_checkpoint.path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("Checkpoint Error: cannot write snapshot " + tmpPath);
+
+        SnapshotWriter writer(file);
+        for (char c : kSnapshotMagic) writer.put(c);
+        writer.put(kSnapshotVersion);
+        writer.put<uint64_t>(line.number);
+        writer.put<int64_t>(line.offset);
+        writer.putVector(m_traceWriter.fileSizes());
+        saveState(writer);
+        writer.put<uint8_t>(m_spikeStats ? 1 : 0);
+        if (m_spikeStats) m_spikeStats->saveState(writer);
+        writer.put<uint8_t>(m_readout ? 1 : 0);
+        if (m_readout) m_readout->saveState(writer);
+        writer.put(kSnapshotEnd);
+        if (!writer.good())
+            throw std::runtime_error("Checkpoint Error: failed writing snapshot " + tmpPath);
+    }
+#ifdef _WIN32
+    std::remove(m_checkpoint.path.c_str());
+#endif
+    if (std::rename(tmpPath.c_str(), m_checkpoint.path.c_str()) != 0)
+        throw std::runtime_error("Checkpoint Error: cannot replace snapshot " + m_checkpoint.path);
+
+    m_linesSinceCheckpoint = 0;
+    m_lastCheckpoint = now;
 }
@@ -1,18 +1,140 @@
 #pragma once
+#include <chrono>
 #include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
 #include <string>
+#include "Pipeline.hpp"
+#include "Checkpoint.hpp"
+#include "Progress.hpp"
+#include "SpikeStats.hpp"
+#include "Readout.hpp"
 
 class BaseNetwork
 {
 public:
     virtual ~BaseNetwork() {}
-    virtual void run(std::ifstream& inputFile) = 0;
+    virtual void run(std::istream& inputFile) = 0;
     virtual void printNetworkToFile() = 0;
 
+    // Named scalar results of the last run (energies, MAC values, ...) for in-process callers.
+    virtual void collectTotals(std::map<std::string, double>& totals) { (void)totals; }
+
+    // Reader -> simulator -> writer stages (see Pipeline.hpp). Set before run().
+    void setPipelineOptions(const PipelineOptions& options) { m_pipeline = options; }
+
+    // Periodic snapshots / resume (see Checkpoint.hpp). Set before run(); relative paths
+    // are resolved against the current directory at this point.
+    void setCheckpointOptions(const CheckpointOptions& options);
+
+    // Periodic progress report (see Progress.hpp). Set before run(); off by default.
+    void setProgressOptions(const ProgressOptions& options) { m_progress = options; }
+
+    // Online spike statistics written as one summary file (see SpikeStats.hpp). Set before
+    // run(); BIU networks then record no traces unless probes ask for them.
+    void setSpikeStatsOptions(const SpikeStatsOptions& options) { m_spikeStatsOptions = options; }
+
+    // Per-line output readout for classification runs (see Readout.hpp). Set before run();
+    // a relative labels path is resolved against the current directory at this point.
+    void setReadoutOptions(const ReadoutOptions& options);
+
+    // Keeps all trace files in `traces` instead of writing them (see TraceWriter::captureTo).
+    // Set before run(); traces are then streamed line by line, as in a pipelined run.
+    void captureTraces(TraceMap* traces);
+
+    // Keeps the spike statistics summary in `json` instead of writing the statistics file.
+    // Set before run().
+    void captureSpikeStats(std::string* json) { m_spikeStatsCapture = json; }
+
+    // Drops every trace as it is produced instead of writing or capturing it (callers that
+    // only need totals and spike statistics). Set before run().
+    void discardTraces();
+
+    // The spike statistics of the last run, or null when they were off.
+    const SpikeStats* spikeStats() const { return m_spikeStats.get(); }
+
+    // Sharded runs: trace paths opened from now on resolve against `outputDirectory`, as after
+    // the change of directory of an unsharded run (files the constructor opened, the DS_<i>
+    // traces, keep theirs), and unless `spoolPrefix` is empty every file is written to
+    // `<spoolPrefix><id>` instead (see TraceWriter::spoolTo). Traces are then streamed line by
+    // line. Set before run().
+    void redirectTraces(const std::string& outputDirectory, const std::string& spoolPrefix);
+
+    // Where the trace files of the last run were written, in the writer's file order.
+    std::vector<std::string> tracePaths() const { return m_traceWriter.paths(); }
+
+    // The readout of the last run, or null when it was off.
+    const Readout* readout() const { return m_readout.get(); }
+
+    // Sharded runs: the stream starts after `lines` lines of the input file, so line numbers
+    // (readout rows and labels, resets) continue from there. Set before run().
+    void setLineOffset(std::size_t lines) { m_lineOffset = lines; }
+
 protected:
     BaseNetwork() = default;
 
-    // ---- Shared utilities for derived classes ----
-    void showProgressBar(std::size_t current, std::size_t total) const;
-    std::size_t countLines(std::istream& in) const;
+    PipelineOptions m_pipeline;  // pipelined run: traces are streamed per input line
+    TraceWriter m_traceWriter;   // all trace files of the network go through here
+    CheckpointOptions m_checkpoint;
+    ProgressOptions m_progress;
+    SpikeStatsOptions m_spikeStatsOptions;
+    std::unique_ptr<SpikeStats> m_spikeStats; // set by startSpikeStats_() when enabled
+
+    ReadoutOptions m_readoutOptions;
+    std::unique_ptr<Readout> m_readout;       // set by startReadout_() when enabled
+
+    // reset_every_lines: the network returns to its initial state before input lines
+    // K+1, 2K+1, ... (0 = never); set by the networks that support it.
+    std::size_t m_resetEveryLines = 0;
+    bool resetDue_(const InputLine& line) const
+    {
+        return m_resetEveryLines > 0 && line.number > 1 && (line.number - 1) % m_resetEveryLines == 0;
+    }
+
+    // How often the LineReader reports input offsets: every line for checkpoints, sampled for
+    // the progress percentage, never otherwise.
+    std::size_t inputOffsetEvery_() const
+    {
+        if (!m_checkpoint.path.empty()) return 1;
+        return m_progress.intervalSeconds > 0.0 ? ProgressReporter::kOffsetEveryLines : 0;
+    }
+
+    // Creates m_spikeStats for a run when the options enable it.
+    void startSpikeStats_(const std::vector<std::size_t>& layerSizes, double cycleSeconds);
+    // Writes the summary of the run (relative to the working directory); m_spikeStats is
+    // kept for spikeStats().
+    void finishSpikeStats_();
+
+    // Creates m_readout for a run when enabled and registers its file; call before the
+    // trace writer starts.
+    void startReadout_(std::size_t outputs);
+    // Prints the accuracy, if labelled; m_readout is kept for collectTotals().
+    void finishReadout_();
+
+    // Traces are streamed line by line (pipelined, checkpointed, captured or sharded runs)
+    // instead of being written by printNetworkToFile().
+    bool streamsTraces_() const;
+
+    // Restores the snapshot named in the options, if any: loads the network state, the spike
+    // statistics and the readout counts, cuts the trace files back and positions `in` after
+    // the last line it covers. Call after startSpikeStats_() and startReadout_(), before the
+    // trace writer starts.
+    // @return number of input lines already consumed (the line offset for a fresh run).
+    std::size_t resumeFromCheckpoint_(std::istream& in);
+
+    // Call after each fully processed (and streamed) input line; writes a snapshot when due.
+    void checkpointIfDue_(const InputLine& line);
+
+    // Network state for snapshots; networks that support checkpointing override both.
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
+
+private:
+    std::size_t m_linesSinceCheckpoint = 0;
+    std::chrono::steady_clock::time_point m_lastCheckpoint;
+    bool m_capturesTraces = false;
+    bool m_redirectsTraces = false;
+    std::string* m_spikeStatsCapture = nullptr;
+    std::size_t m_lineOffset = 0;
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+/**
+ * @file Checkpoint.hpp
+ * @brief Binary simulation snapshots for checkpoint / resume.
+ *
+ * A snapshot holds everything a network needs to continue a run as if it had never
+ * stopped: the number of input lines consumed and the input offset after them, the
+ * size of every trace file at that point, the network state (written by the network's
+ * saveState()) and, if enabled, the spike statistics and the readout counts of the run. Values are stored raw, in host byte order, so a snapshot is
+ * only meant to be resumed on the machine type that wrote it.
+ *
+ * Layout:  "NEMOSNAP" | u32 version | u64 lines | i64 offset | u64[] trace sizes |
+ *          network payload | u8 spike stats flag [+ SpikeStats state] |
+ *          u8 readout flag [+ Readout state] | u32 end marker
+ */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct CheckpointOptions
+{
+    std::string path;               // snapshot file; empty = checkpointing off
+    std::size_t everyLines = 0;     // write a snapshot every N input lines (0 = off)
+    double      everySeconds = 0.0; // ... and/or every N seconds of wall time (0 = off)
+    std::string resumeFrom;         // snapshot to resume from; empty = fresh run
+};
+
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(std::ostream& out) : m_out(out) {}
+
+    template <typename T>
+    void put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SnapshotWriter::put needs a trivially copyable type");
+        m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SnapshotWriter::putVector needs a trivially copyable type");
+        put<std::uint64_t>(values.size());
+        if (!values.empty())
+            m_out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    bool good() const { return m_out.good(); }
+
+private:
+    std::ostream& m_out;
+};
+
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(std::istream& in) : m_in(in) {}
+
+    template <typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SnapshotReader::get needs a trivially copyable type");
+        T value;
+        read_(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void get(T& value) { value = get<T>(); }
+
+    template <typename T>
+    void getVector(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SnapshotReader::getVector needs a trivially copyable type");
+        const std::uint64_t count = get<std::uint64_t>();
+        values.resize(static_cast<std::size_t>(count));
+        if (count > 0)
+            read_(values.data(), static_cast<std::size_t>(count) * sizeof(T));
+    }
+
+    /// Reads a count written by the network and checks it against the network being resumed.
+    void expectCount(std::uint64_t expected, const std::string& what)
+    {
+        const std::uint64_t count = get<std::uint64_t>();
+        if (count != expected)
+        {
+            throw std::runtime_error("Checkpoint Error: snapshot does not match the network (" + what + ": " +
+                                     std::to_string(count) + " in snapshot, " + std::to_string(expected) + " in network)");
+        }
+    }
+
+private:
+    std::istream& m_in;
+
+    void read_(void* data, std::size_t bytes)
+    {
+        m_in.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if (!m_in)
+            throw std::runtime_error("Checkpoint Error: snapshot is truncated or unreadable");
+    }
+};
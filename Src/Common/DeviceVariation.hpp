@@ -0,0 +1,75 @@
+#pragma once
+/**
+ * @file DeviceVariation.hpp
+ * @brief Seeded per-device variation of one Monte Carlo trial.
+ *
+ * A trial is described by its seed and the relative spread of every varied quantity; the
+ * networks turn it into per-device factors while they are built (BIU neuron constants,
+ * Y-Flash cell conductances). The nominal parameters are never changed.
+ *
+ * Every factor is a pure function of (seed, quantity, group, index): a counter-based
+ * hash drawn through Box-Muller, so a device gets the same value whatever else is varied
+ * and in whatever order the network is built. std:: distributions are not used: their
+ * output differs between standard libraries.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+struct DeviceVariation
+{
+    enum class Distribution
+    {
+        Gaussian,   // factor = 1 + sigma * z, redrawn until positive
+        LogNormal   // factor = exp(sigma * z - sigma^2 / 2), mean 1
+    };
+
+    enum Quantity : std::uint64_t { VTh = 1, RLeak, Cu, Cn, YFlashConductance };
+
+    std::uint64_t seed = 0;
+    Distribution distribution = Distribution::Gaussian;
+
+    // relative standard deviations; 0 = nominal
+    double sigmaVTh = 0.0;
+    double sigmaRLeak = 0.0;
+    double sigmaCu = 0.0;
+    double sigmaCn = 0.0;
+    double sigmaYFlash = 0.0;
+
+    bool enabled() const
+    {
+        return sigmaVTh > 0.0 || sigmaRLeak > 0.0 || sigmaCu > 0.0 || sigmaCn > 0.0 || sigmaYFlash > 0.0;
+    }
+
+    /// Multiplier of device `index` in `group` (layer, array, ...) for `quantity`.
+    double factor(Quantity quantity, double sigma, std::uint64_t group, std::uint64_t index) const
+    {
+        if (sigma <= 0.0)
+            return 1.0;
+
+        const double kUnit = 1.0 / 9007199254740992.0; // 2^-53
+        const std::uint64_t key = mix(mix(mix(seed ^ mix(quantity)) ^ group) ^ index);
+        for (std::uint64_t draw = 0;; ++draw)
+        {
+            // u1 in (0, 1], u2 in [0, 1)
+            const double u1 = (static_cast<double>(mix(key + 2 * draw) >> 11) + 1.0) * kUnit;
+            const double u2 = static_cast<double>(mix(key + 2 * draw + 1) >> 11) * kUnit;
+            const double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+
+            if (distribution == Distribution::LogNormal)
+                return std::exp(sigma * z - 0.5 * sigma * sigma);
+            const double f = 1.0 + sigma * z;
+            if (f > 0.0)
+                return f;
+        }
+    }
+
+    /// splitmix64 finalizer
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+};
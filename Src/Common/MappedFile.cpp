@@ -0,0 +1,91 @@
+#include "MappedFile.hpp"
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Unable to open file: " + path);
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL)
+        {
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view != NULL)
+            {
+                m_mapping = mapping;
+                m_data = static_cast<const unsigned char*>(view);
+                m_size = static_cast<std::size_t>(size.QuadPart);
+                m_mapped = true;
+            }
+            else
+            {
+                CloseHandle(mapping);
+            }
+        }
+    }
+    CloseHandle(file); // the mapping keeps its own reference
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Unable to open file: " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED)
+        {
+            m_data = static_cast<const unsigned char*>(view);
+            m_size = static_cast<std::size_t>(info.st_size);
+            m_mapped = true;
+        }
+    }
+    close(fd); // the mapping stays valid after the descriptor is closed
+#endif
+
+    if (!m_mapped)
+        readIntoBuffer_(path);
+}
+
+MappedFile::~MappedFile()
+{
+    if (!m_mapped)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+}
+
+void MappedFile::readIntoBuffer_(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        throw std::runtime_error("Unable to open file: " + path);
+
+    const std::streamoff size = in.tellg();
+    m_buffer.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+    in.seekg(0);
+    if (!m_buffer.empty() && !in.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size())))
+        throw std::runtime_error("Unable to read file: " + path);
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
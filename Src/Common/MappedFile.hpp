@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file MappedFile.hpp
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ * Pages are loaded on demand by the OS, so opening a large file is cheap and values
+ * can be used in place (see WeightMatrix::view). When mapping is not possible the file
+ * is read into memory instead; callers see the same interface either way.
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class MappedFile
+{
+public:
+    /// Maps `path`; throws std::runtime_error if it cannot be opened or read.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool isMapped() const { return m_mapped; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::vector<unsigned char> m_buffer; // fallback when the file cannot be mapped
+#ifdef _WIN32
+    void* m_mapping = nullptr;           // HANDLE of the file mapping object
+#endif
+
+    void readIntoBuffer_(const std::string& path);
+};
@@ -0,0 +1,400 @@
+#include "NetworkImage.hpp"
+#include "MappedFile.hpp"
+#include <cstdio>    // std::rename
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+const char          kMagic[8] = { 'N', 'E', 'M', 'O', 'I', 'M', 'G', '\0' };
+const std::uint32_t kVersion = 3;
+const std::uint32_t kByteOrderMark = 0x01020304u;
+const std::uint32_t kEndMarker = 0x474D4921u;       // "!IMG"
+const std::size_t   kHeaderSize = 8 + 4 + 4 + 8 + 8; // magic, version, byte order, hash, payload size
+const std::size_t   kPayloadSizeOffset = 8 + 4 + 4 + 8;
+
+class ImageWriter
+{
+public:
+    explicit ImageWriter(std::ostream& out) : m_out(out) {}
+
+    template <typename T>
+    void field(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ImageWriter::field needs a trivially copyable type");
+        write_(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void array(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ImageWriter::array needs a trivially copyable type");
+        field<std::uint64_t>(values.size());
+        align_();
+        write_(values.data(), values.size() * sizeof(T));
+    }
+
+    void matrix(const WeightMatrix& m)
+    {
+        field<std::uint64_t>(m.rows());
+        field<std::uint64_t>(m.cols());
+        align_();
+        write_(m.data(), m.rows() * m.cols() * sizeof(double));
+    }
+
+    void text(const std::string& value)
+    {
+        field<std::uint64_t>(value.size());
+        write_(value.data(), value.size());
+    }
+
+    template <typename T, typename Each>
+    void list(const std::vector<T>& items, Each each)
+    {
+        field<std::uint64_t>(items.size());
+        for (const auto& item : items)
+            each(item);
+    }
+
+    std::uint64_t written() const { return m_offset; }
+
+private:
+    std::ostream& m_out;
+    std::uint64_t m_offset = 0; // payload bytes written so far
+
+    void align_()
+    {
+        static const char zeros[8] = {};
+        write_(zeros, static_cast<std::size_t>((8 - m_offset % 8) % 8));
+    }
+
+    void write_(const void* data, std::size_t bytes)
+    {
+        if (bytes == 0) return;
+        m_out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        m_offset += bytes;
+    }
+};
+
+class ImageReader
+{
+public:
+    ImageReader(std::shared_ptr<const MappedFile> file, std::size_t begin, std::size_t end)
+        : m_file(std::move(file)), m_pos(begin), m_end(end) {}
+
+    template <typename T>
+    void field(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ImageReader::field needs a trivially copyable type");
+        std::memcpy(&value, take_(sizeof(T)), sizeof(T));
+    }
+
+    template <typename T>
+    void array(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ImageReader::array needs a trivially copyable type");
+        const std::size_t count = count_(sizeof(T));
+        const unsigned char* data = take_(count * sizeof(T));
+        values.resize(count);
+        if (count > 0)
+            std::memcpy(values.data(), data, count * sizeof(T));
+    }
+
+    void matrix(WeightMatrix& m)
+    {
+        std::uint64_t rows = 0, cols = 0;
+        field(rows);
+        field(cols);
+        align_();
+        if (cols != 0 && rows > (m_end - m_pos) / sizeof(double) / cols)
+            throw std::runtime_error("matrix larger than the file");
+        const std::size_t count = static_cast<std::size_t>(rows * cols);
+        const unsigned char* data = take_(count * sizeof(double));
+
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(double) == 0)
+        {
+            // zero copy: the matrix keeps the mapping alive
+            m = WeightMatrix::view(reinterpret_cast<const double*>(data), static_cast<std::size_t>(rows),
+                                   static_cast<std::size_t>(cols), m_file);
+        }
+        else
+        {
+            std::vector<double> values(count);
+            if (count > 0)
+                std::memcpy(values.data(), data, count * sizeof(double));
+            m = WeightMatrix(static_cast<std::size_t>(rows), static_cast<std::size_t>(cols), std::move(values));
+        }
+    }
+
+    void text(std::string& value)
+    {
+        std::uint64_t length = 0;
+        field(length);
+        if (length > m_end - m_pos)
+            throw std::runtime_error("string longer than the file");
+        const unsigned char* data = take_(static_cast<std::size_t>(length));
+        value.assign(reinterpret_cast<const char*>(data), static_cast<std::size_t>(length));
+    }
+
+    template <typename T, typename Each>
+    void list(std::vector<T>& items, Each each)
+    {
+        std::uint64_t count = 0;
+        field(count);
+        if (count > m_end - m_pos) // every item takes at least one byte
+            throw std::runtime_error("list longer than the file");
+        items.clear();
+        items.resize(static_cast<std::size_t>(count));
+        for (auto& item : items)
+            each(item);
+    }
+
+    bool atEnd() const { return m_pos == m_end; }
+
+private:
+    std::shared_ptr<const MappedFile> m_file;
+    std::size_t m_pos;
+    std::size_t m_end;
+
+    std::size_t count_(std::size_t elementSize)
+    {
+        std::uint64_t count = 0;
+        field(count);
+        align_();
+        if (count > (m_end - m_pos) / elementSize)
+            throw std::runtime_error("array larger than the file");
+        return static_cast<std::size_t>(count);
+    }
+
+    void align_()
+    {
+        take_(static_cast<std::size_t>((8 - m_pos % 8) % 8));
+    }
+
+    const unsigned char* take_(std::size_t bytes)
+    {
+        if (bytes > m_end - m_pos)
+            throw std::runtime_error("unexpected end of payload");
+        const unsigned char* data = m_file->data() + m_pos;
+        m_pos += bytes;
+        return data;
+    }
+};
+
+// The single list of image fields, shared by writing (const params) and loading.
+template <typename Io, typename Params>
+void transferFields(Io& io, Params& p)
+{
+    io.field(p.networkType);
+
+    // LIF / BIU constants
+    io.field(p.Cm);
+    io.field(p.Cf);
+    io.field(p.VDD);
+    io.field(p.VTh);
+    io.field(p.dt);
+    io.field(p.IR);
+    io.field(p.CPara);
+    io.field(p.fclk);
+    io.field(p.Rleak);
+    io.field(p.Cn);
+    io.field(p.Cu);
+    io.field(p.refractory);
+    io.field(p.DSBitWidth);
+    io.field(p.DSClockMHz);
+    io.field(p.DSMode);
+
+    // Topology, per-neuron overrides and synapses
+    io.array(p.layerSizes);
+    io.list(p.biuNeuronVTh, [&](decltype(p.biuNeuronVTh[0]) v) { io.array(v); });
+    io.list(p.biuNeuronRefractory, [&](decltype(p.biuNeuronRefractory[0]) v) { io.array(v); });
+    io.list(p.biuNeuronRLeak, [&](decltype(p.biuNeuronRLeak[0]) v) { io.array(v); });
+    io.list(p.allWeights, [&](decltype(p.allWeights[0]) m) { io.matrix(m); });
+    io.list(p.YFlashWeights, [&](decltype(p.YFlashWeights[0]) m) { io.matrix(m); });
+    io.list(p.weightFiles, [&](decltype(p.weightFiles[0]) path) { io.text(path); });
+
+    // ANN
+    io.field(p.annVDD);
+    io.field(p.annClockHz);
+    io.field(p.annBitSerialBits);
+    io.field(p.annMuxShareAcrossColumns);
+    io.field(p.annMuxFanIn);
+    io.field(p.annVtcC);
+    io.field(p.annVtcIdis);
+    io.field(p.annVtcVth);
+    io.field(p.annVtcT0);
+    io.field(p.annVtcDtLSB);
+    io.field(p.annTdcBits);
+    io.field(p.annDsaOutBits);
+    io.list(p.annPEs, [&](decltype(p.annPEs[0]) pe) {
+        io.field(pe.id);
+        io.field(pe.yflash.rows);
+        io.field(pe.yflash.cols);
+        io.field(pe.yflash.isSigned);
+        io.matrix(pe.yflash.Wpos);
+        io.matrix(pe.yflash.Wneg);
+    });
+}
+
+template <typename T>
+T readRaw(const unsigned char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+// ---------------- source hash ----------------
+
+bool hashNetworkSources(const std::vector<std::string>& paths, std::uint64_t& hash)
+{
+    const std::uint64_t prime = 1099511628211ull;
+    std::uint64_t h = 14695981039346656037ull;
+    std::vector<char> buffer(1 << 20);
+
+    for (const auto& path : paths)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        std::uint64_t length = 0;
+        while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0)
+        {
+            const std::size_t n = static_cast<std::size_t>(in.gcount());
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                h ^= static_cast<unsigned char>(buffer[i]);
+                h *= prime;
+            }
+            length += n;
+        }
+        // fold in the length so bytes moving from one file to the next change the hash
+        for (int i = 0; i < 8; ++i)
+        {
+            h ^= (length >> (8 * i)) & 0xFFu;
+            h *= prime;
+        }
+    }
+
+    hash = h;
+    return true;
+}
+
+// ---------------- write ----------------
+
+void writeNetworkImage(const std::string& path, const NetworkParameters& params, std::uint64_t sourceHash)
+{
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            throw std::runtime_error("Network Image Error: cannot write " + tmpPath);
+
+        const std::uint64_t payloadPlaceholder = 0;
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        out.write(reinterpret_cast<const char*>(&kByteOrderMark), sizeof(kByteOrderMark));
+        out.write(reinterpret_cast<const char*>(&sourceHash), sizeof(sourceHash));
+        out.write(reinterpret_cast<const char*>(&payloadPlaceholder), sizeof(payloadPlaceholder));
+
+        // weight files are only known once the XML is parsed, so their hash lives in the payload
+        std::uint64_t weightFilesHash = 0;
+        if (!hashNetworkSources(params.weightFiles, weightFilesHash))
+            throw std::runtime_error("Network Image Error: cannot read the weight files referenced by the XML");
+
+        ImageWriter writer(out);
+        writer.field(weightFilesHash);
+        transferFields(writer, params);
+        const std::uint64_t payloadSize = writer.written();
+        out.write(reinterpret_cast<const char*>(&kEndMarker), sizeof(kEndMarker));
+
+        out.seekp(static_cast<std::streamoff>(kPayloadSizeOffset));
+        out.write(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+        out.flush();
+        if (!out)
+            throw std::runtime_error("Network Image Error: failed writing " + tmpPath);
+    }
+#ifdef _WIN32
+    std::remove(path.c_str()); // rename() does not replace an existing file on Windows
+#endif
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Network Image Error: cannot replace " + path);
+}
+
+// ---------------- load ----------------
+
+bool loadNetworkImage(const std::string& path, std::uint64_t sourceHash, NetworkParameters& params, std::string& whyNot)
+{
+    std::shared_ptr<const MappedFile> file;
+    try
+    {
+        file = std::make_shared<const MappedFile>(path);
+    }
+    catch (const std::exception&)
+    {
+        whyNot = "does not exist or cannot be read";
+        return false;
+    }
+
+    const unsigned char* data = file->data();
+    const std::size_t size = file->size();
+    if (size < kHeaderSize + sizeof(kEndMarker) || std::memcmp(data, kMagic, sizeof(kMagic)) != 0)
+    {
+        whyNot = "is not a network image";
+        return false;
+    }
+    if (readRaw<std::uint32_t>(data + 8) != kVersion)
+    {
+        whyNot = "was written by a different image format version";
+        return false;
+    }
+    if (readRaw<std::uint32_t>(data + 12) != kByteOrderMark)
+    {
+        whyNot = "was written on a machine with a different byte order";
+        return false;
+    }
+    if (readRaw<std::uint64_t>(data + 16) != sourceHash)
+    {
+        whyNot = "is out of date (the XML configuration changed)";
+        return false;
+    }
+    const std::uint64_t payloadSize = readRaw<std::uint64_t>(data + kPayloadSizeOffset);
+    if (payloadSize != size - kHeaderSize - sizeof(kEndMarker) ||
+        readRaw<std::uint32_t>(data + size - sizeof(kEndMarker)) != kEndMarker)
+    {
+        whyNot = "is truncated";
+        return false;
+    }
+
+    NetworkParameters loaded = params;
+    std::uint64_t weightFilesHash = 0;
+    try
+    {
+        ImageReader reader(file, kHeaderSize, kHeaderSize + static_cast<std::size_t>(payloadSize));
+        reader.field(weightFilesHash);
+        transferFields(reader, loaded);
+        if (!reader.atEnd())
+            throw std::runtime_error("trailing payload bytes");
+    }
+    catch (const std::exception& ex)
+    {
+        whyNot = std::string("is corrupt (") + ex.what() + ")";
+        return false;
+    }
+
+    std::uint64_t currentHash = 0;
+    if (!hashNetworkSources(loaded.weightFiles, currentHash) || currentHash != weightFilesHash)
+    {
+        whyNot = "is out of date (a weight file changed or is missing)";
+        return false;
+    }
+
+    params = std::move(loaded);
+    return true;
+}
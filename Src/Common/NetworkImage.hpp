@@ -0,0 +1,37 @@
+#pragma once
+/**
+ * @file NetworkImage.hpp
+ * @brief Precompiled binary image of the network parameters parsed from the XML files.
+ *
+ * An image holds every NetworkParameters field that comes from the XML (network
+ * constants, topology, per-neuron VTh/refractory/RLeak, BIU weights, YFlash matrices and
+ * ANN PE blocks), already validated by XMLParser. It is keyed by a hash of the source
+ * XML bytes and stores a hash of the binary weight files the XML references, so a stale
+ * image is detected and rebuilt instead of being used.
+ *
+ * Loading maps the file and hands out the weight matrices as views into the mapping
+ * (WeightMatrix::view); nothing is parsed and the weights are not copied. Values are
+ * stored raw, in host byte order, so an image is only valid on the machine type that
+ * wrote it (other byte orders are reported as stale).
+ *
+ * Layout:  "NEMOIMG" | u32 version | u32 byte-order mark | u64 source hash |
+ *          u64 payload size | payload | u32 end marker
+ * The payload starts with the u64 weight-file hash. Arrays in the payload are a u64
+ * count followed by the values, starting on an 8-byte boundary.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../NemoSimEngine/networkParams.hpp"
+
+/// FNV-1a hash over the contents of `paths` (in order). Returns false if a file cannot be read.
+bool hashNetworkSources(const std::vector<std::string>& paths, std::uint64_t& hash);
+
+/// Writes the XML-derived part of `params` to `path` (through a temporary file, then renamed).
+/// Throws std::runtime_error on I/O errors.
+void writeNetworkImage(const std::string& path, const NetworkParameters& params, std::uint64_t sourceHash);
+
+/// Loads `path` into the XML-derived fields of `params` if it is a valid image of `sourceHash`.
+/// Returns false and leaves `params` untouched otherwise, with the reason in `whyNot`.
+bool loadNetworkImage(const std::string& path, std::uint64_t sourceHash, NetworkParameters& params, std::string& whyNot);
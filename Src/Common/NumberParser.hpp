@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * @file NumberParser.hpp
+ * @brief Fast in-place parsing of whitespace-separated decimal numbers (XML <row> text).
+ *
+ * parseNumber() converts one token without copying it. Tokens whose significant digits,
+ * read as an integer mantissa, fit in 2^53 (so the mantissa is an exact double) and whose
+ * decimal exponent is within +-22 (so 10^|exp| is an exact double) are converted with a
+ * single IEEE multiply or divide, which is correctly rounded; every other token (longer
+ * mantissas, larger exponents) goes through strtod.
+ * Either way the result is the correctly rounded value, the same one std::istream >> double
+ * produces, so switching a parser over does not change any weight.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+enum class NumberStatus { Ok, NonFinite, NotANumber };
+
+namespace numberparser_detail {
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool isNonFiniteWord(const char* begin, const char* end)
+{
+    if (begin != end && (*begin == '+' || *begin == '-')) ++begin;
+    std::string word(begin, end);
+    for (auto& c : word) c = static_cast<char>(c | 0x20); // ASCII lower case
+    return word == "nan" || word == "inf" || word == "infinity";
+}
+
+} // namespace numberparser_detail
+
+/// Parses the token starting at `p` (no leading whitespace) and advances `p` past it.
+/// A token must end at whitespace or at the end of the text.
+inline NumberStatus parseNumber(const char*& p, double& out)
+{
+    using namespace numberparser_detail;
+    static const double kPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* const start = p;
+    const char* s = p;
+    const bool negative = (*s == '-');
+    if (*s == '+' || *s == '-') ++s;
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;        // significant digits kept in mantissa
+    int exponent = 0;      // decimal exponent applied to mantissa
+    bool anyDigit = false;
+    bool exact = true;     // false once a significant digit did not fit
+
+    for (; isDigit(*s); ++s)
+    {
+        anyDigit = true;
+        if (mantissa == 0 && *s == '0') continue;
+        if (digits < 19) { mantissa = mantissa * 10 + static_cast<unsigned>(*s - '0'); ++digits; }
+        else { ++exponent; exact = false; }
+    }
+    if (*s == '.')
+    {
+        for (++s; isDigit(*s); ++s)
+        {
+            anyDigit = true;
+            if (mantissa == 0 && *s == '0') { --exponent; continue; }
+            if (digits < 19) { mantissa = mantissa * 10 + static_cast<unsigned>(*s - '0'); ++digits; --exponent; }
+            else exact = false;
+        }
+    }
+    if (anyDigit && (*s == 'e' || *s == 'E'))
+    {
+        const char* e = s + 1;
+        const bool negativeExp = (*e == '-');
+        if (*e == '+' || *e == '-') ++e;
+        if (isDigit(*e))
+        {
+            int value = 0;
+            for (; isDigit(*e); ++e)
+                if (value < 100000) value = value * 10 + (*e - '0');
+            exponent += negativeExp ? -value : value;
+            s = e;
+        }
+        else
+        {
+            anyDigit = false; // "1e" / "1e+" is not a number
+        }
+    }
+
+    const char* end = s;
+    while (*end && !isSpace(*end)) ++end;
+    p = end;
+    if (!anyDigit || end != s)
+        return isNonFiniteWord(start, end) ? NumberStatus::NonFinite : NumberStatus::NotANumber;
+
+    double value;
+    if (mantissa == 0)
+        value = 0.0;
+    else if (exact && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+        value = exponent < 0 ? static_cast<double>(mantissa) / kPow10[-exponent]
+                             : static_cast<double>(mantissa) * kPow10[exponent];
+    else
+        value = std::abs(std::strtod(start, nullptr));
+
+    out = negative ? -value : value;
+    return std::isfinite(out) ? NumberStatus::Ok : NumberStatus::NonFinite;
+}
+
+struct NumberRowResult
+{
+    NumberStatus status = NumberStatus::Ok;
+    std::size_t  count = 0;   // numbers appended
+    std::string  badToken;    // first rejected token (status != Ok)
+};
+
+/// Appends every number in `text` to `out`, stopping at the first token that is not a
+/// finite number (reported in the result).
+inline NumberRowResult parseNumberRow(const char* text, std::vector<double>& out)
+{
+    NumberRowResult result;
+    const char* p = text;
+    for (;;)
+    {
+        while (numberparser_detail::isSpace(*p)) ++p;
+        if (!*p) break;
+
+        const char* token = p;
+        double value = 0.0;
+        result.status = parseNumber(p, value);
+        if (result.status != NumberStatus::Ok)
+        {
+            result.badToken.assign(token, p);
+            break;
+        }
+        out.push_back(value);
+        ++result.count;
+    }
+    return result;
+}
@@ -0,0 +1,362 @@
+#include "Pipeline.hpp"
+#include "Profiler.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#define getcwd _getcwd
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// ---------------- helpers ----------------
+
+static bool isAbsolutePath(const std::string& path)
+{
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+std::string absolutePath(const std::string& path)
+{
+    if (isAbsolutePath(path)) return path;
+
+    char buffer[4096];
+    if (!getcwd(buffer, sizeof(buffer))) return path;
+    return std::string(buffer) + "/" + path;
+}
+
+// Cuts `path` back to `size` bytes; the file must be at least that long.
+static void truncateFile(const std::string& path, std::uint64_t size)
+{
+    std::ifstream probe(path, std::ios::binary | std::ios::ate);
+    const std::streamoff current = probe.is_open() ? static_cast<std::streamoff>(probe.tellg()) : -1;
+    probe.close();
+    if (current < 0 || static_cast<std::uint64_t>(current) < size)
+        throw std::runtime_error("Checkpoint Error: trace file " + path + " is shorter than recorded in the snapshot");
+
+#ifdef _WIN32
+    int fd = -1;
+    bool ok = _sopen_s(&fd, path.c_str(), _O_RDWR | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) == 0 &&
+              _chsize_s(fd, static_cast<__int64>(size)) == 0;
+    if (fd >= 0) _close(fd);
+#else
+    bool ok = ::truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+    if (!ok)
+        throw std::runtime_error("Checkpoint Error: cannot truncate trace file " + path);
+}
+
+// ================= LineReader =================
+
+LineReader::LineReader(std::istream& in, Parser parser, const PipelineOptions& options, std::size_t linesBefore,
+                       std::size_t offsetEvery)
+    : m_in(in), m_parser(std::move(parser)), m_lineNumber(linesBefore), m_offsetEvery(offsetEvery)
+{
+    if (options.enabled)
+    {
+        m_ring.reset(new SpscRing<InputLine>(options.depth));
+        m_thread = std::thread(&LineReader::readerLoop_, this);
+    }
+}
+
+LineReader::~LineReader()
+{
+    m_stop.store(true, std::memory_order_release);
+    if (m_ring) m_ring->interrupt();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool LineReader::readOne_(InputLine& line)
+{
+    std::string text;
+    if (!std::getline(m_in, text))
+    {
+        line.last = true;
+        return false;
+    }
+    line.number = ++m_lineNumber;
+    // -1 once the last line hit end of file; tellg() is not free, so only on sampled lines
+    const bool sampled = m_offsetEvery > 0 && line.number % m_offsetEvery == 0;
+    line.offset = sampled ? static_cast<std::streamoff>(m_in.tellg()) : -1;
+    line.values.clear();
+    line.last = false;
+    try
+    {
+        Profiler::Scope timer(Profiler::InputParse);
+        m_parser(text, line.number, line.values);
+    }
+    catch (...)
+    {
+        line.error = std::current_exception();
+    }
+    return true;
+}
+
+void LineReader::readerLoop_()
+{
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        InputLine line;
+        const bool more = readOne_(line);
+        const bool failed = static_cast<bool>(line.error);
+        if (!m_ring->push(std::move(line), m_stop) || !more || failed)
+            return; // consumer gone, end of input, or first error delivered
+    }
+}
+
+bool LineReader::next(InputLine& line)
+{
+    if (m_done) return false;
+
+    if (m_ring)
+        m_ring->pop(line);
+    else
+        readOne_(line);
+
+    if (line.last)
+    {
+        m_done = true;
+        return false;
+    }
+    if (line.error)
+    {
+        m_done = true;
+        std::rethrow_exception(line.error);
+    }
+    return true;
+}
+
+// ================= TraceWriter =================
+
+TraceWriter::~TraceWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void TraceWriter::start(const PipelineOptions& options)
+{
+    if (m_started) return;
+    if (!m_created) create_();
+    m_started = true;
+    m_threaded = options.enabled;
+    if (m_threaded)
+    {
+        m_stop.store(false, std::memory_order_relaxed);
+        m_ring.reset(new SpscRing<Batch>(options.depth));
+        m_thread = std::thread(&TraceWriter::writerLoop_, this);
+    }
+}
+
+int TraceWriter::open(const std::string& path, std::size_t columns, const std::string& header)
+{
+    if (m_thread.joinable())
+        throw std::logic_error("TraceWriter::open: files must be opened before the writer thread starts");
+
+    File file;
+    file.name = path;
+    file.path = (m_directory.empty() || isAbsolutePath(path)) ? absolutePath(path) : m_directory + "/" + path;
+    file.columns = columns > 0 ? columns : 1;
+    file.header = header.empty() ? header : header + '\n';
+    m_files.push_back(std::move(file));
+    return static_cast<int>(m_files.size()) - 1;
+}
+
+void TraceWriter::create_()
+{
+    if (!m_resumeSizes.empty() && m_resumeSizes.size() != m_files.size())
+    {
+        throw std::runtime_error("Checkpoint Error: snapshot records " + std::to_string(m_resumeSizes.size()) +
+                                 " trace files, this run writes " + std::to_string(m_files.size()));
+    }
+    for (std::size_t i = 0; i < m_files.size(); ++i)
+    {
+        File& file = m_files[i];
+        if (m_discard)
+        {
+            file.writable = false;
+            continue;
+        }
+        if (m_capture)
+        {
+            file.captured = &(*m_capture)[file.name];
+            file.captured->clear();
+            continue;
+        }
+        if (!m_spoolPrefix.empty())
+        {
+            file.path = m_spoolPrefix + std::to_string(i);
+            file.header.clear();
+        }
+        file.size = m_resumeSizes.empty() ? 0 : m_resumeSizes[i];
+        if (file.size != 0)
+        {
+            truncateFile(file.path, file.size);
+        }
+        else
+        {
+            std::ofstream out(file.path, std::ios::out | std::ios::trunc);
+            if (!out.is_open())
+            {
+                std::cerr << "Warning: could not open " << file.name << " for writing.\n";
+                file.writable = false;
+                continue;
+            }
+            out << file.header;
+            file.size = file.header.size();
+        }
+    }
+    m_created = true;
+}
+
+std::vector<std::string> TraceWriter::paths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(m_files.size());
+    for (const auto& file : m_files) paths.push_back(file.path);
+    return paths;
+}
+
+std::vector<std::uint64_t> TraceWriter::fileSizes() const
+{
+    std::vector<std::uint64_t> sizes;
+    sizes.reserve(m_files.size());
+    for (const auto& file : m_files) sizes.push_back(file.size);
+    return sizes;
+}
+
+void TraceWriter::submit(Batch&& batch)
+{
+    if (!m_started) start(PipelineOptions());
+
+    if (m_threaded)
+        m_ring->push(std::move(batch), m_stop);
+    else
+        write_(batch);
+}
+
+void TraceWriter::sync()
+{
+    if (!m_started) return;
+
+    if (m_thread.joinable())
+    {
+        m_flushRequested.store(true, std::memory_order_release);
+        m_ring->interrupt();
+        std::unique_lock<std::mutex> lock(m_syncMutex);
+        m_synced.wait(lock, [this] { return !m_flushRequested.load(std::memory_order_acquire); });
+    }
+    else
+    {
+        flush_();
+    }
+}
+
+void TraceWriter::close()
+{
+    if (!m_started) return;
+
+    if (m_thread.joinable())
+    {
+        m_stop.store(true, std::memory_order_release);
+        m_ring->interrupt();
+        m_thread.join();
+    }
+    flush_();
+    m_started = false;
+    m_threaded = false;
+}
+
+void TraceWriter::write_(Batch& batch)
+{
+    {
+        Profiler::Scope timer(Profiler::OutputWrite);
+        std::ostringstream oss;
+        for (auto& chunk : batch)
+        {
+            if (chunk.fileId < 0 || chunk.fileId >= static_cast<int>(m_files.size())) continue;
+            File& file = m_files[chunk.fileId];
+            if (file.captured)
+            {
+                file.captured->insert(file.captured->end(), chunk.values.begin(), chunk.values.end());
+                continue;
+            }
+            if (!file.writable) continue;
+
+            oss.str(std::string());
+            if (file.columns == 1)
+                for (double v : chunk.values) oss << v << '\n';
+            else
+            {
+                oss.precision(15); // tables hold counts and line numbers: print them in full
+                for (std::size_t i = 0; i < chunk.values.size(); ++i)
+                    oss << chunk.values[i] << ((i + 1) % file.columns ? ',' : '\n');
+                oss.precision(6);
+            }
+            const std::string text = oss.str();
+            file.pending += text;
+            m_pendingBytes += text.size();
+        }
+    }
+    if (m_pendingBytes >= kPendingBudget) flush_();
+}
+
+void TraceWriter::flush_()
+{
+    Profiler::Scope timer(Profiler::OutputWrite);
+    for (auto& file : m_files)
+    {
+        if (file.pending.empty()) continue;
+        std::ofstream out(file.path, std::ios::out | std::ios::app);
+        out.write(file.pending.data(), static_cast<std::streamsize>(file.pending.size()));
+        out.flush();
+        file.size = static_cast<std::uint64_t>(out.tellp());
+        file.pending.clear();
+    }
+    m_pendingBytes = 0;
+}
+
+void TraceWriter::writerLoop_()
+{
+    // sleeps in pop() while there is nothing to write and nothing was asked for
+    const auto signalled = [this] {
+        return m_flushRequested.load(std::memory_order_acquire) || m_stop.load(std::memory_order_acquire);
+    };
+    Batch batch;
+    while (true)
+    {
+        if (m_ring->pop(batch, signalled))
+        {
+            write_(batch);
+            continue;
+        }
+        if (m_flushRequested.load(std::memory_order_acquire))
+        {
+            while (m_ring->tryPop(batch)) write_(batch);
+            flush_();
+            std::lock_guard<std::mutex> lock(m_syncMutex);
+            m_flushRequested.store(false, std::memory_order_release);
+            m_synced.notify_all();
+            continue;
+        }
+        if (m_stop.load(std::memory_order_acquire))
+        {
+            // producer is done: everything it submitted is visible now
+            while (m_ring->tryPop(batch)) write_(batch);
+            return;
+        }
+    }
+}
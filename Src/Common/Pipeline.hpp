@@ -0,0 +1,188 @@
+#pragma once
+/**
+ * @file Pipeline.hpp
+ * @brief Reader -> simulator -> writer execution stages shared by all networks.
+ *
+ *  - LineReader:  yields parsed input lines. In pipelined mode a reader thread reads and
+ *                 pre-encodes lines into an SpscRing while the simulation consumes them.
+ *  - TraceWriter: formats numeric trace chunks and appends them to their files. In
+ *                 pipelined mode a writer thread drains the chunks, so neither reading
+ *                 nor writing runs on the simulation thread.
+ *
+ * Both stages are bounded (ring depth), so a slow disk throttles the simulation
+ * instead of growing memory. With pipelining off everything runs inline.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SpscRing.hpp"
+
+struct PipelineOptions
+{
+    bool        enabled = false;
+    std::size_t depth = 256;   // input lines / trace batches in flight per stage
+};
+
+/// One pre-encoded input line.
+struct InputLine
+{
+    std::size_t         number = 0;   // 1-based line number in the input file
+    std::vector<double> values;
+    std::streamoff      offset = -1;  // input position after this line (-1 = end of input or not sampled)
+    std::exception_ptr  error;        // parse error raised on the reader thread
+    bool                last = false; // end-of-input marker
+};
+
+class LineReader
+{
+public:
+    /// Parses one text line into values; throws on malformed input.
+    using Parser = std::function<void(const std::string& line, std::size_t lineNumber, std::vector<double>& values)>;
+
+    /// @param linesBefore   Lines already consumed before the current stream position (resume).
+    /// @param offsetEvery   Fill InputLine::offset on every Nth line (one tellg() each); 1 for
+    ///                      checkpoints, which may snapshot any line, larger for the progress
+    ///                      report. 0 = never; other lines keep -1.
+    LineReader(std::istream& in, Parser parser, const PipelineOptions& options, std::size_t linesBefore = 0,
+               std::size_t offsetEvery = 0);
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    /// Fetches the next line in file order. Rethrows the parser's exception for that line.
+    /// @return false at end of input.
+    bool next(InputLine& line);
+
+private:
+    std::istream& m_in;
+    Parser m_parser;
+    std::size_t m_lineNumber = 0;
+    std::size_t m_offsetEvery = 0;
+    bool m_done = false;
+
+    // pipelined mode
+    std::unique_ptr<SpscRing<InputLine>> m_ring;
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+
+    bool readOne_(InputLine& line);
+    void readerLoop_();
+};
+
+/// Trace files kept in memory instead of on disk: file name -> the values the file would
+/// hold, one per line.
+using TraceMap = std::map<std::string, std::vector<double>>;
+
+class TraceWriter
+{
+public:
+    struct Chunk
+    {
+        int fileId = -1;
+        std::vector<double> values; // written one value per line, like `out << v << '\n'`
+    };
+    using Batch = std::vector<Chunk>;
+
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /// Starts the writer stage (threaded when options.enabled). Idempotent.
+    void start(const PipelineOptions& options);
+
+    /// Registers `path` (relative to the current directory at this call) and returns its id.
+    /// The file is created, or emptied, when the writer starts; a file that cannot be created
+    /// then is reported and skipped. A table file takes `columns` values per line, separated
+    /// by commas, below an optional `header` line.
+    int open(const std::string& path, std::size_t columns = 1, const std::string& header = std::string());
+
+    /// Resolves the relative paths of later open() calls against `dir` instead of the current
+    /// directory, as after a change of directory (which a worker thread cannot make alone).
+    void setDirectory(const std::string& dir) { m_directory = dir; }
+
+    /// Writes file `id` to `<prefix><id>` instead of its path, without the header: a part of
+    /// the file for the caller to append to it later (sharded runs). Call before the start.
+    void spoolTo(const std::string& prefix) { m_spoolPrefix = prefix; }
+
+    /// Absolute path every file is written to, in open() order.
+    std::vector<std::string> paths() const;
+
+    /// Keeps every trace in `traces` (keyed by the name given to open()) instead of writing
+    /// files. Call before the writer starts; applies to files opened before and after.
+    void captureTo(TraceMap* traces) { m_capture = traces; }
+
+    /// Drops every trace instead of writing it; no file is created. Call before the start.
+    void discard() { m_discard = true; }
+
+    /// Resume: at start, cut every file back to the given size instead of emptying it.
+    void resumeAt(const std::vector<std::uint64_t>& sizes) { m_resumeSizes = sizes; }
+
+    /// Hands a batch of chunks to the writer; blocks while the writer queue is full.
+    void submit(Batch&& batch);
+
+    /// Blocks until everything submitted so far is on disk (writer thread keeps running).
+    void sync();
+
+    /// Drains all pending chunks to disk and stops the writer thread.
+    void close();
+
+    /// On-disk size per file, in open() order, as of the last flush (exact after sync()).
+    std::vector<std::uint64_t> fileSizes() const;
+
+    bool isOpen() const { return m_started; }
+
+private:
+    struct File
+    {
+        std::string name;      // as passed to open()
+        std::string path;      // absolute, so later appends survive a change of directory
+        std::size_t columns = 1;
+        std::string header;    // first line of a fresh file (tables)
+        std::string pending;   // formatted, not yet written
+        std::uint64_t size = 0; // bytes on disk
+        bool writable = true;
+        std::vector<double>* captured = nullptr; // in-memory mode
+    };
+
+    std::vector<File> m_files;
+    TraceMap* m_capture = nullptr;
+    bool m_discard = false;
+    std::string m_directory;   // for relative paths; empty = the current directory
+    std::string m_spoolPrefix;
+    std::vector<std::uint64_t> m_resumeSizes;
+    bool m_created = false;    // files emptied / cut back (first start only)
+    std::size_t m_pendingBytes = 0;
+    bool m_started = false;
+    bool m_threaded = false;
+
+    std::unique_ptr<SpscRing<Batch>> m_ring;
+    std::atomic<bool> m_stop{ false };
+    std::atomic<bool> m_flushRequested{ false };
+    std::mutex m_syncMutex;              // sync() sleeps until the writer has flushed
+    std::condition_variable m_synced;
+    std::thread m_thread;
+
+    void create_();
+    void write_(Batch& batch);
+    void flush_();
+    void writerLoop_();
+
+    static const std::size_t kPendingBudget = 32u << 20; // bytes buffered before a flush
+};
+
+/// Resolves `path` against the current directory (unchanged if already absolute).
+std::string absolutePath(const std::string& path);
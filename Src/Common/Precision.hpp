@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file Precision.hpp
+ * @brief Numeric type of the neuron and crossbar kernels.
+ *
+ * BIU and LIF neurons and the LIF Y-Flash crossbar are templates on their state type
+ * (BasicBIUNeuron<Real>, BasicLIFNeuron<Real>); both float and double are compiled in and a
+ * layer picks one at run time:
+ *
+ *   Double  every state variable and weight in double (reference results)
+ *   Float   membrane state, constants and weights in float; energy accumulators, traces
+ *           and everything reported stay double (mixed precision)
+ *   Fixed   BIU only: the integer datapath of FixedBIUNeuron (Vn as a signed code,
+ *           capacitance ratios from a table, no division); see FixedPointFormat
+ *
+ * Float halves the bytes read per synapse and doubles the SIMD width of the inner loops.
+ * nemosim_precision reports how far a workload's results move from the double ones.
+ */
+
+enum class Precision { Double, Float, Fixed };
+
+inline const char* precisionName(Precision precision)
+{
+    switch (precision)
+    {
+    case Precision::Float: return "float";
+    case Precision::Fixed: return "fixed";
+    default:               return "double";
+    }
+}
+
+// Word widths of Precision::Fixed. Vn is a signed code of vnBits magnitude bits with
+// LSB = VDD / 2^vnBits (saturating at +-(2^vnBits - 1)); the decay ratio of a cycle is a
+// fixed-point number with ratioBits fractional bits. Both are limited to 4..30 bits.
+struct FixedPointFormat
+{
+    int vnBits = 16;
+    int ratioBits = 16;
+};
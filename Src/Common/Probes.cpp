@@ -0,0 +1,164 @@
+#include "Probes.hpp"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::runtime_error probeError(const std::string& probe, const std::string& what)
+{
+    return std::runtime_error("Configuration Error: probe \"" + probe + "\": " + what);
+}
+
+std::uint64_t parseIndex(const std::string& probe, const std::string& text)
+{
+    if (text.empty() || !std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }))
+        throw probeError(probe, "'" + text + "' is not a non-negative integer");
+    try
+    {
+        return std::stoull(text);
+    }
+    catch (const std::exception&)
+    {
+        throw probeError(probe, "'" + text + "' is out of range");
+    }
+}
+
+// "a" or "a-b"
+void parseRange(const std::string& probe, const std::string& text, std::uint64_t& first, std::uint64_t& last)
+{
+    const size_t dash = text.find('-');
+    first = parseIndex(probe, text.substr(0, dash));
+    last = (dash == std::string::npos) ? first : parseIndex(probe, text.substr(dash + 1));
+    if (last < first)
+        throw probeError(probe, "range " + text + " is empty");
+}
+
+NeuronProbe parseProbe(const std::string& probe)
+{
+    NeuronProbe result;
+    result.recording = ProbeRecording::spikesOnly();
+
+    std::istringstream fields(probe);
+    std::string field;
+    while (fields >> field)
+    {
+        const size_t eq = field.find('=');
+        if (eq == std::string::npos)
+            throw probeError(probe, "expected key=value, got '" + field + "'");
+        const std::string key = field.substr(0, eq);
+        const std::string value = field.substr(eq + 1);
+        std::uint64_t first = 0, last = 0;
+
+        if (key == "layer")
+        {
+            parseRange(probe, value, first, last);
+            result.firstLayer = static_cast<int>(first);
+            result.lastLayer = static_cast<int>(last);
+        }
+        else if (key == "neurons")
+        {
+            parseRange(probe, value, first, last);
+            result.firstNeuron = static_cast<int>(first);
+            result.lastNeuron = static_cast<int>(last);
+        }
+        else if (key == "record")
+        {
+            ProbeRecording& r = result.recording;
+            r.vn = r.spikes = r.vin = false;
+            std::istringstream list(value);
+            std::string quantity;
+            while (std::getline(list, quantity, ','))
+            {
+                if (quantity == "spikes")  r.spikes = true;
+                else if (quantity == "vn") r.vn = true;
+                else if (quantity == "vin") r.vin = true;
+                else throw probeError(probe, "unknown quantity '" + quantity + "' (use spikes, vn, vin)");
+            }
+            if (!r.any())
+                throw probeError(probe, "record lists no quantity");
+        }
+        else if (key == "stride")
+        {
+            result.recording.stride = parseIndex(probe, value);
+            if (result.recording.stride == 0)
+                throw probeError(probe, "stride must be at least 1");
+        }
+        else if (key == "cycles")
+        {
+            const size_t dash = value.find('-');
+            if (dash == std::string::npos)
+                throw probeError(probe, "cycles needs a window a-b");
+            result.recording.firstCycle = parseIndex(probe, value.substr(0, dash));
+            result.recording.endCycle = parseIndex(probe, value.substr(dash + 1));
+            if (result.recording.endCycle <= result.recording.firstCycle)
+                throw probeError(probe, "cycle window " + value + " is empty");
+        }
+        else
+        {
+            throw probeError(probe, "unknown key '" + key + "' (use layer, neurons, record, stride, cycles)");
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<NeuronProbe> parseProbeSpec(const std::string& spec)
+{
+    std::vector<NeuronProbe> probes;
+    std::istringstream in(spec);
+    std::string probe;
+    while (std::getline(in, probe, ';'))
+    {
+        if (probe.find_first_not_of(" \t") == std::string::npos)
+            continue;
+        probes.push_back(parseProbe(probe));
+    }
+    return probes;
+}
+
+std::vector<std::vector<ProbeRecording>> resolveProbes(const std::vector<NeuronProbe>& probes,
+                                                       const std::vector<int>& layerSizes,
+                                                       const ProbeRecording& fallback)
+{
+    std::vector<std::vector<ProbeRecording>> recordings;
+    for (int size : layerSizes)
+        recordings.emplace_back(static_cast<size_t>(size), probes.empty() ? fallback : ProbeRecording());
+
+    const int layers = static_cast<int>(layerSizes.size());
+    for (size_t p = 0; p < probes.size(); ++p)
+    {
+        const NeuronProbe& probe = probes[p];
+        const int lastLayer = probe.lastLayer < 0 ? layers - 1 : probe.lastLayer;
+        if (lastLayer >= layers)
+            throw std::runtime_error("Configuration Error: probe " + std::to_string(p + 1) + " names layer " +
+                                     std::to_string(lastLayer) + ", the network has " + std::to_string(layers) + " layers");
+
+        for (int l = probe.firstLayer; l <= lastLayer; ++l)
+        {
+            const int neurons = layerSizes[l];
+            const int lastNeuron = probe.lastNeuron < 0 ? neurons - 1 : probe.lastNeuron;
+            if (lastNeuron >= neurons)
+                throw std::runtime_error("Configuration Error: probe " + std::to_string(p + 1) + " names neuron " +
+                                         std::to_string(lastNeuron) + ", layer " + std::to_string(l) + " has " +
+                                         std::to_string(neurons) + " neurons");
+
+            for (int n = probe.firstNeuron; n <= lastNeuron; ++n)
+            {
+                ProbeRecording& r = recordings[l][n];
+                if (r.any() && !r.sameSampling(probe.recording))
+                    throw std::runtime_error("Configuration Error: probe " + std::to_string(p + 1) + " samples neuron " +
+                                             std::to_string(l) + ":" + std::to_string(n) +
+                                             " with a different stride or window than an earlier probe");
+                const bool vn = r.vn, spikes = r.spikes, vin = r.vin;
+                r = probe.recording;
+                r.vn |= vn;
+                r.spikes |= spikes;
+                r.vin |= vin;
+            }
+        }
+    }
+    return recordings;
+}
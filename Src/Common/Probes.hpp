@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * @file Probes.hpp
+ * @brief Selective neuron probes: which neurons keep which traces, and when.
+ *
+ * Without probes a BIU network records the spikes of every neuron (plus Vn and Vin in
+ * Debug verbosity). With a probe spec only the probed neurons keep any history; every other
+ * neuron records nothing, so trace memory and output scale with what is probed.
+ *
+ * Spec ("probes" in the JSON run configuration): probes separated by ';', each a list of
+ * key=value fields separated by spaces:
+ *
+ *     "probes": "layer=0 neurons=0-99 record=spikes,vn stride=4; layer=2 record=spikes cycles=1000-2000"
+ *
+ *     layer    layer index or range a-b (inclusive); default: all layers
+ *     neurons  neuron index or range a-b (inclusive); default: all neurons of the layer
+ *     record   comma-separated quantities: spikes, vn, vin; default: spikes
+ *     stride   keep every n-th cycle; default 1
+ *     cycles   window a-b of simulated cycles, a included, b excluded; default: the whole run
+ *
+ * A neuron matched by several probes records the union of their quantities; the probes must
+ * then sample it the same way (stride and window).
+ */
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/// What one neuron records, and at which cycles.
+struct ProbeRecording
+{
+    bool vn = false;
+    bool spikes = false;
+    bool vin = false;
+    std::uint64_t stride = 1;
+    std::uint64_t firstCycle = 0;
+    std::uint64_t endCycle = std::numeric_limits<std::uint64_t>::max();
+
+    static ProbeRecording all() { ProbeRecording r; r.vn = r.spikes = r.vin = true; return r; }
+    static ProbeRecording spikesOnly() { ProbeRecording r; r.spikes = true; return r; }
+
+    bool any() const { return vn || spikes || vin; }
+
+    /// True if the cycle (0-based) is sampled.
+    bool samples(std::uint64_t cycle) const
+    {
+        return cycle >= firstCycle && cycle < endCycle && (stride == 1 || (cycle - firstCycle) % stride == 0);
+    }
+
+    bool sameSampling(const ProbeRecording& other) const
+    {
+        return stride == other.stride && firstCycle == other.firstCycle && endCycle == other.endCycle;
+    }
+};
+
+struct NeuronProbe
+{
+    int firstLayer = 0;
+    int lastLayer = -1;   // -1 = last layer of the network
+    int firstNeuron = 0;
+    int lastNeuron = -1;  // -1 = last neuron of the layer
+    ProbeRecording recording;
+};
+
+/// Parses a probe spec (see above). Throws std::runtime_error("Configuration Error: ...").
+std::vector<NeuronProbe> parseProbeSpec(const std::string& spec);
+
+/// Recording of every neuron of a network with the given layer sizes: `probes` applied in
+/// order, or `fallback` for all neurons when there are no probes. Throws on a probe that
+/// names a layer or neuron the network does not have.
+std::vector<std::vector<ProbeRecording>> resolveProbes(const std::vector<NeuronProbe>& probes,
+                                                       const std::vector<int>& layerSizes,
+                                                       const ProbeRecording& fallback);
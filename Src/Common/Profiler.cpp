@@ -0,0 +1,189 @@
+#include "Profiler.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool Profiler::s_enabled = false;
+
+namespace {
+
+const char* const kPhaseNames[Profiler::PhaseCount] = {
+    "config_parse", "xml_parse", "construction", "input_parse", "ds_tick", "layer_update", "energy_accounting", "output_write"
+};
+const char* const kCounterNames[Profiler::CounterCount] = {
+    "input_lines", "cycles", "spikes", "synaptic_events", "refractory_skips"
+};
+
+struct HardwareCounter
+{
+    const char* name;
+    std::uint32_t config;
+    int fd;
+};
+
+struct ProfileState
+{
+    std::atomic<std::uint64_t> phaseNs[Profiler::PhaseCount];
+    std::atomic<std::uint64_t> counts[Profiler::CounterCount];
+    std::uint64_t startNs = 0;
+
+    std::mutex layerMutex;
+    std::vector<std::uint64_t> layerNs;
+
+    bool hardwareRequested = false;
+    std::string hardwareError;
+    std::vector<HardwareCounter> hardware;
+
+    ProfileState()
+    {
+        for (auto& ns : phaseNs) ns.store(0);
+        for (auto& n : counts) n.store(0);
+    }
+};
+
+ProfileState& state()
+{
+    static ProfileState s;
+    return s;
+}
+
+#ifdef __linux__
+// Process-wide counter (this thread and the threads it creates later), user space only.
+int openHardwareCounter(std::uint32_t config)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof attr;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+void startHardwareCounters(ProfileState& s)
+{
+    s.hardwareRequested = true;
+#ifdef __linux__
+    const HardwareCounter wanted[] = {
+        { "cpu_cycles", PERF_COUNT_HW_CPU_CYCLES, -1 },
+        { "instructions", PERF_COUNT_HW_INSTRUCTIONS, -1 },
+        { "cache_misses", PERF_COUNT_HW_CACHE_MISSES, -1 },
+        { "branch_misses", PERF_COUNT_HW_BRANCH_MISSES, -1 },
+    };
+    for (HardwareCounter counter : wanted)
+    {
+        counter.fd = openHardwareCounter(counter.config);
+        if (counter.fd < 0)
+        {
+            s.hardwareError = std::string("perf_event_open(") + counter.name + "): " + std::strerror(errno);
+            continue;
+        }
+        s.hardware.push_back(counter);
+    }
+#else
+    s.hardwareError = "hardware counters need perf_event_open (Linux)";
+#endif
+}
+
+void writeSeconds(std::ostream& out, std::uint64_t ns)
+{
+    out << static_cast<double>(ns) * 1e-9;
+}
+
+} // namespace
+
+void Profiler::enable(bool hardwareCounters)
+{
+    ProfileState& s = state();
+    s.startNs = now();
+    if (hardwareCounters && !s.hardwareRequested)
+        startHardwareCounters(s);
+    s_enabled = true;
+}
+
+void Profiler::addTime(Phase phase, std::uint64_t ns)
+{
+    state().phaseNs[phase].fetch_add(ns, std::memory_order_relaxed);
+}
+
+void Profiler::addCount(Counter counter, std::uint64_t n)
+{
+    state().counts[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+void Profiler::addLayerTimes(const std::vector<std::uint64_t>& ns)
+{
+    ProfileState& s = state();
+    std::lock_guard<std::mutex> lock(s.layerMutex);
+    if (s.layerNs.size() < ns.size())
+        s.layerNs.resize(ns.size(), 0);
+    for (std::size_t l = 0; l < ns.size(); ++l)
+        s.layerNs[l] += ns[l];
+}
+
+void Profiler::writeReport(std::ostream& out)
+{
+    ProfileState& s = state();
+    const auto precision = out.precision(9);
+
+    out << "{\n"
+        << "  \"schema\": \"nemosim-profile/1\",\n"
+        << "  \"wall_s\": ";
+    writeSeconds(out, s.startNs ? now() - s.startNs : 0);
+    out << ",\n  \"phases_s\": {";
+    for (int p = 0; p < PhaseCount; ++p)
+    {
+        out << (p ? "," : "") << "\n    \"" << kPhaseNames[p] << "\": ";
+        writeSeconds(out, s.phaseNs[p].load());
+    }
+    out << "\n  },\n  \"layer_update_s\": [";
+    {
+        std::lock_guard<std::mutex> lock(s.layerMutex);
+        for (std::size_t l = 0; l < s.layerNs.size(); ++l)
+        {
+            out << (l ? ", " : "");
+            writeSeconds(out, s.layerNs[l]);
+        }
+    }
+    out << "],\n  \"counters\": {";
+    for (int c = 0; c < CounterCount; ++c)
+        out << (c ? "," : "") << "\n    \"" << kCounterNames[c] << "\": " << s.counts[c].load();
+    out << "\n  }";
+
+    if (s.hardwareRequested)
+    {
+        out << ",\n  \"hardware_counters\": {";
+        bool first = true;
+#ifdef __linux__
+        for (const HardwareCounter& counter : s.hardware)
+        {
+            std::uint64_t value = 0;
+            if (read(counter.fd, &value, sizeof value) != static_cast<ssize_t>(sizeof value))
+                continue;
+            out << (first ? "" : ",") << "\n    \"" << counter.name << "\": " << value;
+            first = false;
+        }
+#endif
+        if (!s.hardwareError.empty())
+        {
+            out << (first ? "" : ",") << "\n    \"error\": \"";
+            for (char c : s.hardwareError)
+                out << ((c == '"' || c == '\\') ? "\\" : "") << c;
+            out << "\"";
+        }
+        out << "\n  }";
+    }
+    out << "\n}\n";
+    out.precision(precision);
+}
@@ -0,0 +1,77 @@
+#pragma once
+/**
+ * @file Profiler.hpp
+ * @brief Per-phase wall time and event counters of a run, off unless the configuration asks.
+ *
+ * Enabled with "profile": true in the JSON run configuration; NEMOSIM then writes a JSON
+ * report ("profile_report", default profile.json in the output directory) after the run.
+ * When disabled, every probe is a single test of a flag.
+ *
+ * Phases (seconds, summed over all threads):
+ *   config_parse, xml_parse, construction   loading, on the main thread
+ *   input_parse                             LineReader parser (reader thread when pipelined)
+ *   ds_tick                                 BIU digital-to-spike front-end
+ *   layer_update                            all layers / PEs; also split per layer
+ *   energy_accounting                       BIU synaptic energy lookups, part of layer_update
+ *   output_write                            trace formatting and file writes (writer thread
+ *                                           when pipelined, so it overlaps the simulation)
+ *
+ * Counters: input lines, simulated cycles, output spikes, synaptic events (spikes arriving
+ * at a synapse; Y-Flash cells hit by a 1 bit for ANN) and refractory skips (BIU neuron
+ * updates cut short by the refractory period).
+ *
+ * With "profile_hardware_counters": true, Linux builds also count CPU cycles, instructions,
+ * cache misses and branch misses of the process with perf_event_open (user space only).
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+class Profiler
+{
+public:
+    enum Phase { ConfigParse, XmlParse, Construction, InputParse, DsTick, LayerUpdate, EnergyAccounting, OutputWrite, PhaseCount };
+    enum Counter { InputLines, Cycles, Spikes, SynapticEvents, RefractorySkips, CounterCount };
+
+    static bool enabled() { return s_enabled; }
+
+    /// Turns profiling on for the rest of the process; call before the network is built.
+    static void enable(bool hardwareCounters);
+
+    static std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void addTime(Phase phase, std::uint64_t ns);
+    static void addCount(Counter counter, std::uint64_t n);
+
+    /// Adds per-layer (per-PE) update times; index = layer. Networks sum locally and call
+    /// this once per run.
+    static void addLayerTimes(const std::vector<std::uint64_t>& ns);
+
+    /// Writes the report (JSON) of everything recorded so far.
+    static void writeReport(std::ostream& out);
+
+    /// Times its scope into `phase` when profiling is enabled.
+    class Scope
+    {
+    public:
+        explicit Scope(Phase phase) : m_phase(phase), m_active(s_enabled), m_start(m_active ? now() : 0) {}
+        ~Scope() { if (m_active) addTime(m_phase, now() - m_start); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Phase m_phase;
+        bool m_active;
+        std::uint64_t m_start;
+    };
+
+private:
+    static bool s_enabled;
+};
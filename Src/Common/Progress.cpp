@@ -0,0 +1,150 @@
+#include "Progress.hpp"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Current resident set size; peak RSS where the current one is not available.
+std::uint64_t residentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters))
+        return static_cast<std::uint64_t>(counters.WorkingSetSize);
+    return 0;
+#elif defined(__linux__)
+    unsigned long long size = 0, resident = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    const int fields = std::fscanf(statm, "%llu %llu", &size, &resident);
+    std::fclose(statm);
+    return fields == 2 ? static_cast<std::uint64_t>(resident) * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<std::uint64_t>(usage.ru_maxrss); // bytes on macOS
+#endif
+}
+
+std::string formatDuration(double seconds)
+{
+    const long long s = static_cast<long long>(seconds + 0.5);
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%lld:%02lld:%02lld", s / 3600, (s / 60) % 60, s % 60);
+    return buf;
+}
+
+double secondsBetween(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+} // namespace
+
+ProgressReporter::ProgressReporter(const ProgressOptions& options, std::istream& in)
+    : m_enabled(options.intervalSeconds > 0.0),
+      m_interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.intervalSeconds))),
+      m_start(std::chrono::steady_clock::now())
+{
+    if (!m_enabled) return;
+
+    // input size for the ETA, without reading it
+    const std::streampos start = in.tellg();
+    if (start != std::streampos(-1) && in.seekg(0, std::ios::end))
+    {
+        m_inputEnd = static_cast<std::int64_t>(in.tellg());
+        m_inputStart = static_cast<std::int64_t>(start);
+        in.seekg(start);
+    }
+    in.clear();
+    if (m_inputEnd < 0) m_inputStart = -1;
+    m_offset.store(m_inputStart, std::memory_order_relaxed);
+
+    m_thread = std::thread(&ProgressReporter::reporterLoop_, this);
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    stop_();
+}
+
+void ProgressReporter::stop_()
+{
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+void ProgressReporter::finish()
+{
+    if (!m_enabled) return;
+    stop_();
+
+    const double elapsed = secondsBetween(m_start, std::chrono::steady_clock::now());
+    const std::uint64_t lines = m_lines.load(std::memory_order_relaxed);
+    const std::uint64_t cycles = lines + static_cast<std::uint64_t>(m_extraCycles.load(std::memory_order_relaxed));
+    std::ostringstream report;
+    report << "Processed " << lines << " lines (" << cycles << " cycles) in " << formatDuration(elapsed);
+    if (elapsed > 0.0)
+        report << ": " << static_cast<std::uint64_t>(lines / elapsed) << " lines/s, "
+               << static_cast<std::uint64_t>(cycles / elapsed) << " cycles/s";
+    report << '\n';
+    std::cout << report.str() << std::flush;
+    m_enabled = false;
+}
+
+void ProgressReporter::reporterLoop_()
+{
+    std::uint64_t lastLines = 0, lastCycles = 0;
+    auto last = m_start;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_interval, [this] { return m_stop; }))
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const std::uint64_t lines = m_lines.load(std::memory_order_relaxed);
+        const std::uint64_t cycles = lines + static_cast<std::uint64_t>(m_extraCycles.load(std::memory_order_relaxed));
+        const std::int64_t offset = m_offset.load(std::memory_order_relaxed);
+        const double interval = secondsBetween(last, now);
+
+        std::ostringstream report;
+        report.setf(std::ios::fixed);
+        report.precision(1);
+        report << "Progress: ";
+        if (m_inputEnd > m_inputStart && offset >= m_inputStart)
+        {
+            const double done = static_cast<double>(offset - m_inputStart);
+            const double total = static_cast<double>(m_inputEnd - m_inputStart);
+            report << 100.0 * done / total << " % | ";
+        }
+        report << lines << " lines, " << static_cast<std::uint64_t>((lines - lastLines) / interval) << " lines/s | "
+               << cycles << " cycles, " << static_cast<std::uint64_t>((cycles - lastCycles) / interval) << " cycles/s";
+        if (m_inputEnd > m_inputStart && offset > m_inputStart)
+        {
+            // bytes per second over the whole run so far
+            const double rate = static_cast<double>(offset - m_inputStart) / secondsBetween(m_start, now);
+            report << " | ETA " << formatDuration(static_cast<double>(m_inputEnd - offset) / rate);
+        }
+        report << " | RSS " << static_cast<double>(residentBytes()) / (1024.0 * 1024.0) << " MB\n";
+        std::cout << report.str() << std::flush;
+
+        lastLines = lines;
+        lastCycles = cycles;
+        last = now;
+    }
+}
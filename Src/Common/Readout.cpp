@@ -0,0 +1,114 @@
+#include "Readout.hpp"
+#include "Checkpoint.hpp"
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+Readout::Readout(const ReadoutOptions& options, std::size_t outputs)
+    : m_mode(options.mode), m_file(options.file), m_values(outputs)
+{
+    resetLine_();
+    if (options.labelsPath.empty())
+        return;
+
+    std::ifstream in(options.labelsPath);
+    if (!in.is_open())
+        throw std::runtime_error("Readout Error: unable to open labels file: " + options.labelsPath);
+    std::string line;
+    std::size_t number = 0;
+    while (std::getline(in, line))
+    {
+        ++number;
+        const std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        std::istringstream iss(line);
+        int label;
+        if (!(iss >> label))
+            throw std::runtime_error("Readout Error: line " + std::to_string(number) + " of " + options.labelsPath +
+                                     " is not an integer label");
+        m_labels.push_back(label);
+    }
+}
+
+int Readout::open(TraceWriter& writer)
+{
+    std::string header = hasLabels() ? "line,label,predicted" : "line,predicted";
+    for (std::size_t n = 0; n < m_values.size(); ++n)
+        header += ",out_" + std::to_string(n);
+    const std::size_t columns = m_values.size() + (hasLabels() ? 3 : 2);
+    m_fileId = writer.open(m_file, columns, header);
+    return m_fileId;
+}
+
+void Readout::resetLine_()
+{
+    for (double& v : m_values)
+        v = (m_mode == ReadoutMode::Latency) ? -1.0 : 0.0;
+    m_cycle = 0;
+}
+
+int Readout::predict_() const
+{
+    int best = -1;
+    for (std::size_t n = 0; n < m_values.size(); ++n)
+    {
+        const double v = m_values[n];
+        const bool better = (m_mode == ReadoutMode::Counts)
+            ? v > 0.0 && (best < 0 || v > m_values[best])
+            : v >= 0.0 && (best < 0 || v < m_values[best]);
+        if (better) best = static_cast<int>(n);
+    }
+    return best;
+}
+
+void Readout::endLine(std::size_t lineNumber, TraceWriter::Batch& batch)
+{
+    TraceWriter::Chunk row;
+    row.fileId = m_fileId;
+    row.values.reserve(m_values.size() + 3);
+    row.values.push_back(static_cast<double>(lineNumber));
+
+    const int predicted = predict_();
+    if (hasLabels())
+    {
+        if (lineNumber == 0 || lineNumber > m_labels.size())
+            throw std::runtime_error("Readout Error: no label for input line " + std::to_string(lineNumber) +
+                                     " (labels file has " + std::to_string(m_labels.size()) + ")");
+        const int label = m_labels[lineNumber - 1];
+        row.values.push_back(label);
+        ++m_labelled;
+        if (predicted == label) ++m_correct;
+    }
+    row.values.push_back(predicted);
+    row.values.insert(row.values.end(), m_values.begin(), m_values.end());
+    batch.push_back(std::move(row));
+    resetLine_();
+}
+
+void Readout::saveState(SnapshotWriter& out) const
+{
+    out.putVector(m_values);
+    out.put(m_cycle);
+    out.put(m_labelled);
+    out.put(m_correct);
+}
+
+void Readout::loadState(SnapshotReader& in)
+{
+    const std::size_t outputs = m_values.size();
+    in.getVector(m_values);
+    if (m_values.size() != outputs)
+        throw std::runtime_error("Checkpoint Error: snapshot does not match the network (readout outputs)");
+    in.get(m_cycle);
+    in.get(m_labelled);
+    in.get(m_correct);
+}
+
+void Readout::printSummary(std::ostream& out) const
+{
+    if (!hasLabels() || m_labelled == 0)
+        return;
+    out << "Readout accuracy: " << accuracy() << " (" << m_correct << "/" << m_labelled << " lines)" << '\n';
+}
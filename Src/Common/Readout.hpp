@@ -0,0 +1,89 @@
+#pragma once
+/**
+ * @file Readout.hpp
+ * @brief Classification readout: one row per input line with the output layer's response.
+ *
+ * For every input line the output-layer neurons are summarised by their spike count
+ * (ReadoutMode::Counts) or by the cycle of their first spike within the line, -1 if they
+ * stay silent (ReadoutMode::Latency). The predicted class is the neuron with the most
+ * spikes, or the earliest first spike (lowest index on ties, -1 if no neuron fired).
+ *
+ * Rows are streamed through the network's TraceWriter as the run goes, so they follow the
+ * pipeline, checkpoint and in-memory capture modes like any trace:
+ *
+ *     line,label,predicted,out_0,out_1,...
+ *
+ * The label column is present when a labels file is given (one integer class per input
+ * line, '#' comments and blank lines skipped); the accuracy is then printed after the run.
+ * Snapshots keep the labelled and correct counts, so a resumed run reports the accuracy
+ * over the whole input.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "Pipeline.hpp"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+enum class ReadoutMode { Off, Counts, Latency };
+
+struct ReadoutOptions
+{
+    ReadoutMode mode = ReadoutMode::Off;
+    std::string file = "readout.csv";  // relative to the working (output) directory
+    std::string labelsPath;            // empty = no label column
+};
+
+class Readout
+{
+public:
+    /// Loads the labels, if any. Throws std::runtime_error("Readout Error: ...").
+    Readout(const ReadoutOptions& options, std::size_t outputs);
+
+    /// Registers the results file; call before the writer starts.
+    /// @return its file id in `writer`.
+    int open(TraceWriter& writer);
+
+    /// Output neuron `neuron` fired in the current cycle.
+    void recordSpike(std::size_t neuron)
+    {
+        if (m_mode == ReadoutMode::Counts)
+            m_values[neuron] += 1.0;
+        else if (m_values[neuron] < 0.0)
+            m_values[neuron] = static_cast<double>(m_cycle);
+    }
+
+    void endCycle(std::uint64_t cycles = 1) { m_cycle += cycles; }
+
+    /// Closes input line `lineNumber` (1-based) and adds its row to `batch`.
+    void endLine(std::size_t lineNumber, TraceWriter::Batch& batch);
+
+    /// Prints the accuracy over the labelled lines of this run (nothing without labels).
+    void printSummary(std::ostream& out) const;
+
+    // Checkpoint / resume (see Checkpoint.hpp): the open line and the accuracy counts.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+    bool hasLabels() const { return !m_labels.empty(); }
+    std::uint64_t labelled() const { return m_labelled; }
+    std::uint64_t correct() const { return m_correct; }
+    double accuracy() const { return m_labelled ? static_cast<double>(m_correct) / static_cast<double>(m_labelled) : 0.0; }
+
+private:
+    ReadoutMode m_mode;
+    std::string m_file;
+    std::vector<int> m_labels;      // by input line, 0-based
+    std::vector<double> m_values;   // current line, per output neuron
+    std::uint64_t m_cycle = 0;      // cycle within the current line
+    int m_fileId = -1;
+    std::uint64_t m_labelled = 0;
+    std::uint64_t m_correct = 0;
+
+    void resetLine_();
+    int predict_() const;
+};
@@ -0,0 +1,176 @@
+#include "SpikeStats.hpp"
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <cmath>
+
+SpikeStats::SpikeStats(const SpikeStatsOptions& options, const std::vector<std::size_t>& layerSizes, double cycleSeconds)
+    : m_options(options), m_cycleSeconds(cycleSeconds)
+{
+    if (m_options.binLines == 0)
+        m_options.binLines = 1;
+    for (std::size_t size : layerSizes)
+    {
+        Layer layer;
+        layer.neurons.resize(size);
+        layer.isiHistogram.assign(kIsiBins, 0);
+        m_layers.push_back(std::move(layer));
+    }
+}
+
+void SpikeStats::recordCycle(const std::vector<std::vector<std::uint8_t>>& spikes)
+{
+    for (std::size_t l = 0; l < spikes.size() && l < m_layers.size(); ++l)
+    {
+        const std::vector<std::uint8_t>& layer = spikes[l];
+        for (std::size_t n = 0; n < layer.size(); ++n)
+            if (layer[n]) recordSpike(l, n);
+    }
+    endCycle();
+}
+
+void SpikeStats::endLine()
+{
+    ++m_lines;
+    if (m_lines % m_options.binLines != 0)
+        return;
+
+    for (Layer& layer : m_layers)
+    {
+        layer.activity.push_back(layer.binSpikes);
+        layer.binSpikes = 0;
+    }
+    if (!m_layers.empty() && m_layers.front().activity.size() == kMaxActivityBins)
+    {
+        // every bin is closed on a multiple of twice the width, so the next ones line up
+        for (Layer& layer : m_layers)
+        {
+            for (std::size_t i = 0; i < kMaxActivityBins / 2; ++i)
+                layer.activity[i] = layer.activity[2 * i] + layer.activity[2 * i + 1];
+            layer.activity.resize(kMaxActivityBins / 2);
+        }
+        m_options.binLines *= 2;
+    }
+}
+
+std::uint64_t SpikeStats::layerSpikes(std::size_t layer) const
+{
+    std::uint64_t total = 0;
+    for (const Neuron& n : m_layers[layer].neurons)
+        total += n.count;
+    return total;
+}
+
+void SpikeStats::saveState(SnapshotWriter& out) const
+{
+    out.put(m_cycle);
+    out.put(m_lines);
+    out.put<std::uint64_t>(m_options.binLines);
+    out.put<std::uint64_t>(m_layers.size());
+    for (const Layer& layer : m_layers)
+    {
+        out.putVector(layer.neurons);
+        out.putVector(layer.isiHistogram);
+        out.put(layer.binSpikes);
+        out.putVector(layer.activity);
+    }
+}
+
+void SpikeStats::loadState(SnapshotReader& in)
+{
+    in.get(m_cycle);
+    in.get(m_lines);
+    m_options.binLines = static_cast<std::size_t>(in.get<std::uint64_t>());
+    if (m_options.binLines == 0)
+        throw std::runtime_error("Checkpoint Error: corrupt spike statistics (activity bin width 0)");
+    in.expectCount(m_layers.size(), "spike statistics layers");
+    for (Layer& layer : m_layers)
+    {
+        const std::size_t neurons = layer.neurons.size();
+        in.getVector(layer.neurons);
+        if (layer.neurons.size() != neurons)
+            throw std::runtime_error("Checkpoint Error: snapshot does not match the network (spike statistics neurons)");
+        in.getVector(layer.isiHistogram);
+        in.get(layer.binSpikes);
+        in.getVector(layer.activity);
+        if (layer.activity.size() >= kMaxActivityBins)
+            throw std::runtime_error("Checkpoint Error: corrupt spike statistics (activity bins)");
+    }
+}
+
+namespace {
+
+template <typename T>
+void writeArray(std::ostream& out, const std::vector<T>& values)
+{
+    out << '[';
+    for (std::size_t i = 0; i < values.size(); ++i)
+        out << (i ? ", " : "") << values[i];
+    out << ']';
+}
+
+} // namespace
+
+void SpikeStats::writeJson(std::ostream& out) const
+{
+    const auto precision = out.precision(9);
+    const double seconds = static_cast<double>(m_cycle) * m_cycleSeconds;
+
+    out << "{\n"
+        << "  \"schema\": \"nemosim-spike-stats/2\",\n"
+        << "  \"cycles\": " << m_cycle << ",\n"
+        << "  \"lines\": " << m_lines << ",\n"
+        << "  \"cycle_s\": " << m_cycleSeconds << ",\n"
+        << "  \"activity_bin_lines\": " << m_options.binLines << ",\n"
+        << "  \"isi_bins\": \"log2: bin k counts intervals of 2^k to 2^(k+1)-1 cycles\",\n"
+        << "  \"layers\": [";
+
+    for (std::size_t l = 0; l < m_layers.size(); ++l)
+    {
+        const Layer& layer = m_layers[l];
+        std::vector<std::uint64_t> counts;
+        std::vector<double> ratePerCycle, rateHz, isiMean, isiCv;
+        std::uint64_t total = 0;
+        for (const Neuron& n : layer.neurons)
+        {
+            counts.push_back(n.count);
+            total += n.count;
+            ratePerCycle.push_back(m_cycle ? static_cast<double>(n.count) / static_cast<double>(m_cycle) : 0.0);
+            rateHz.push_back(seconds > 0.0 ? static_cast<double>(n.count) / seconds : 0.0);
+
+            // ISIs of a neuron: count - 1 intervals; CV needs at least two of them
+            const double intervals = n.count > 1 ? static_cast<double>(n.count - 1) : 0.0;
+            const double mean = intervals > 0.0 ? n.isiSum / intervals : 0.0;
+            double cv = 0.0;
+            if (intervals > 1.0 && mean > 0.0)
+                cv = std::sqrt(std::max(0.0, n.isiSumSq / intervals - mean * mean)) / mean;
+            isiMean.push_back(mean);
+            isiCv.push_back(cv);
+        }
+
+        // trailing empty ISI bins are left out
+        std::vector<std::uint64_t> histogram = layer.isiHistogram;
+        while (!histogram.empty() && histogram.back() == 0) histogram.pop_back();
+
+        std::vector<std::uint64_t> activity = layer.activity;
+        if (m_lines % m_options.binLines != 0)
+            activity.push_back(layer.binSpikes); // last, partial bin
+
+        out << (l ? "," : "") << "\n    {\n"
+            << "      \"neurons\": " << layer.neurons.size() << ",\n"
+            << "      \"spikes\": " << total << ",\n"
+            << "      \"isi_histogram\": "; writeArray(out, histogram);
+        out << ",\n      \"activity\": "; writeArray(out, activity);
+        out << ",\n      \"neuron_spikes\": "; writeArray(out, counts);
+        out << ",\n      \"neuron_rate_per_cycle\": "; writeArray(out, ratePerCycle);
+        if (m_cycleSeconds > 0.0)
+        {
+            out << ",\n      \"neuron_rate_hz\": "; writeArray(out, rateHz);
+        }
+        out << ",\n      \"neuron_isi_mean_cycles\": "; writeArray(out, isiMean);
+        out << ",\n      \"neuron_isi_cv\": "; writeArray(out, isiCv);
+        out << "\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+    out.precision(precision);
+}
@@ -0,0 +1,112 @@
+#pragma once
+/**
+ * @file SpikeStats.hpp
+ * @brief Online spike statistics of a run, kept in fixed memory per neuron and written as
+ *        one JSON summary instead of the raw spike traces.
+ *
+ * Updated as the network runs (BIU: once per simulated cycle, LIF: once per input line):
+ *
+ *   per neuron   spike count, firing rate, mean and coefficient of variation of the
+ *                inter-spike interval (ISI)
+ *   per layer    spike count, ISI histogram in log2 bins (bin k: 2^k <= ISI < 2^(k+1) cycles),
+ *                activity over time: spikes per bin of `binLines` input lines
+ *
+ * Memory is constant: at most kMaxActivityBins activity bins are kept per layer; when they
+ * are full, adjacent bins are merged pairwise and the bin width doubles. The output layer's
+ * spike counts of every input line are the readout's (ReadoutMode::Counts), which streams
+ * them. Snapshots hold the statistics, so a resumed run reports the whole input, as an
+ * uninterrupted one does.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+struct SpikeStatsOptions
+{
+    bool        enabled = false;
+    std::string file = "spike_stats.json"; // relative to the working (output) directory
+    std::size_t binLines = 1;              // input lines per activity bin (doubles when the bins are full)
+};
+
+class SpikeStats
+{
+public:
+    /// @param cycleSeconds  duration of one cycle, for rates in Hz (0 = rates per cycle only)
+    SpikeStats(const SpikeStatsOptions& options, const std::vector<std::size_t>& layerSizes, double cycleSeconds);
+
+    /// Neuron `neuron` of `layer` fired in the current cycle.
+    void recordSpike(std::size_t layer, std::size_t neuron)
+    {
+        Layer& l = m_layers[layer];
+        Neuron& n = l.neurons[neuron];
+        if (n.count > 0)
+        {
+            const std::uint64_t isi = m_cycle - n.lastSpike;
+            n.isiSum += static_cast<double>(isi);
+            n.isiSumSq += static_cast<double>(isi) * static_cast<double>(isi);
+            ++l.isiHistogram[log2Bin_(isi)];
+        }
+        n.lastSpike = m_cycle;
+        ++n.count;
+        ++l.binSpikes;
+    }
+
+    /// Every layer's spikes of a cycle, as BIUNetwork::update() returns them.
+    void recordCycle(const std::vector<std::vector<std::uint8_t>>& spikes);
+
+    /// Closes the current cycle; `cycles` > 1 also accounts for silent cycles that were skipped.
+    void endCycle(std::uint64_t cycles = 1) { m_cycle += cycles; }
+
+    /// Closes the current input line.
+    void endLine();
+
+    void writeJson(std::ostream& out) const;
+
+    // Totals for in-process callers (see Session): cycles so far, and per layer its size
+    // and the spikes of all its neurons.
+    std::uint64_t cycles() const { return m_cycle; }
+    std::size_t layerCount() const { return m_layers.size(); }
+    std::size_t layerSize(std::size_t layer) const { return m_layers[layer].neurons.size(); }
+    std::uint64_t layerSpikes(std::size_t layer) const;
+
+    // Checkpoint / resume (see Checkpoint.hpp): counters, histograms and open bins.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    struct Neuron
+    {
+        std::uint64_t count = 0;
+        std::uint64_t lastSpike = 0;
+        double isiSum = 0.0;
+        double isiSumSq = 0.0;
+    };
+    struct Layer
+    {
+        std::vector<Neuron> neurons;
+        std::vector<std::uint64_t> isiHistogram;
+        std::uint64_t binSpikes = 0;           // spikes in the current activity bin
+        std::vector<std::uint64_t> activity;   // spikes per closed activity bin
+    };
+    static const std::size_t kIsiBins = 64;
+    static const std::size_t kMaxActivityBins = 1024; // even, see endLine()
+
+    SpikeStatsOptions m_options;               // binLines: current width of the activity bins
+    double m_cycleSeconds;
+    std::vector<Layer> m_layers;
+    std::uint64_t m_cycle = 0;
+    std::uint64_t m_lines = 0;
+
+    static std::size_t log2Bin_(std::uint64_t isi)
+    {
+        std::size_t bin = 0;
+        while (isi >>= 1) ++bin;
+        return bin;
+    }
+};
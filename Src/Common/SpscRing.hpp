@@ -0,0 +1,156 @@
+#pragma once
+/**
+ * @file SpscRing.hpp
+ * @brief Bounded lock-free single-producer / single-consumer ring buffer.
+ *
+ * Exactly one thread may call push()/tryPush() and exactly one (other) thread may
+ * call pop()/tryPop(). The blocking variants retry briefly and then sleep on a
+ * condition variable until the other side makes room / delivers an item, which is
+ * what bounds the pipeline stages (backpressure). The mutex is only taken on that
+ * sleep/wake transition: a side that did not find the other one asleep stays lock-free.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscRing
+{
+public:
+    /// @param capacity  Maximum number of items in flight (rounded up to a power of two).
+    explicit SpscRing(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return m_slots.size(); }
+
+    bool tryPush(T&& item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= m_slots.size())
+            return false; // full
+        m_slots[tail & m_mask] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        wakeIfWaiting_(m_consumerWaiting);
+        return true;
+    }
+
+    bool tryPop(T& item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false; // empty
+        item = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        wakeIfWaiting_(m_producerWaiting);
+        return true;
+    }
+
+    /// Blocks while the ring is full. Returns false if `stop` becomes true first; whoever
+    /// sets `stop` from another thread calls interrupt() afterwards.
+    bool push(T&& item, const std::atomic<bool>& stop)
+    {
+        const auto stopped = [&] { return stop.load(std::memory_order_acquire); };
+        while (!tryPush(std::move(item)))
+        {
+            if (stopped()) return false;
+            wait_(m_producerWaiting, [&] { return !full_() || stopped(); });
+        }
+        return true;
+    }
+
+    /// Blocks while the ring is empty.
+    void pop(T& item)
+    {
+        while (!tryPop(item))
+            wait_(m_consumerWaiting, [&] { return !empty_(); });
+    }
+
+    /// Blocks while the ring is empty and `stop()` is false; returns false if stopped with
+    /// the ring empty. Whoever makes `stop()` true calls interrupt() afterwards.
+    template <typename Stop>
+    bool pop(T& item, Stop stop)
+    {
+        while (!tryPop(item))
+        {
+            if (stop()) return false;
+            wait_(m_consumerWaiting, [&] { return !empty_() || stop(); });
+        }
+        return true;
+    }
+
+    /// Wakes a sleeping push()/pop() so it re-checks its stop condition.
+    void interrupt()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_all();
+    }
+
+private:
+    static const int kSpinTries = 256; // retries before a blocking side goes to sleep
+
+    std::vector<T> m_slots;
+    std::size_t m_mask = 0;
+
+    // Head and tail are written by different threads: keep them on separate cache lines.
+    // Plain padding rather than alignas(64), so the ring needs no over-aligned allocation.
+    char m_pad0[64];
+    std::atomic<std::size_t> m_head{ 0 }; // next slot to read  (consumer-owned)
+    char m_pad1[64];
+    std::atomic<std::size_t> m_tail{ 0 }; // next slot to write (producer-owned)
+    char m_pad2[64];
+
+    std::atomic<bool> m_producerWaiting{ false };
+    std::atomic<bool> m_consumerWaiting{ false };
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+
+    bool full_() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire) >= m_slots.size();
+    }
+    bool empty_() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    // Spins a little, then sleeps until `ready()`. The waiting flag is raised before the
+    // final check and the other side looks at it after publishing (both behind a full
+    // fence), so one of them always sees the other and no wake-up is lost.
+    template <typename Ready>
+    void wait_(std::atomic<bool>& waiting, Ready ready)
+    {
+        for (int i = 0; i < kSpinTries; ++i)
+        {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_wake.wait(lock, ready);
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    void wakeIfWaiting_(std::atomic<bool>& waiting)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake.notify_all();
+        }
+    }
+};
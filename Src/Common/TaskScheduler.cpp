@@ -0,0 +1,217 @@
+#include "TaskScheduler.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace {
+
+// Rounds (a look at the queues and a yield) an idle thread spends before it sleeps; layer
+// updates come every few microseconds, so a short spin still saves most wake-ups.
+constexpr int kSpinRounds = 256;
+
+} // namespace
+
+void ParallelGrain::record_(std::size_t items, std::uint64_t ns)
+{
+    if (items == 0)
+        return;
+    const double sample = static_cast<double>(ns) / static_cast<double>(items);
+    m_nsPerItem = m_nsPerItem == 0.0 ? sample : 0.75 * m_nsPerItem + 0.25 * sample;
+}
+
+TaskScheduler::TaskScheduler(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 0; t < threads; ++t)
+        m_queues.emplace_back(new Queue());
+    for (unsigned t = 0; t + 1 < threads; ++t)
+        m_workers.emplace_back(&TaskScheduler::work_, this, static_cast<std::size_t>(t));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop.store(true);
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void TaskScheduler::parallelFor(std::size_t count, std::size_t chunk, const RangeBody& body)
+{
+    if (count == 0)
+        return;
+    chunk = std::max<std::size_t>(1, chunk);
+    if (m_workers.empty())
+    {
+        for (std::size_t begin = 0; begin < count; begin += chunk)
+            body(begin, std::min(count, begin + chunk));
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    dispatch_(job, count, chunk);
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+void TaskScheduler::parallelFor(std::size_t count, ParallelGrain& grain, const RangeBody& body)
+{
+    if (count == 0)
+        return;
+    const double cost = grain.m_nsPerItem;
+    const std::size_t threads = m_queues.size();
+    if (threads == 1 || count < 2 || cost * static_cast<double>(count) < static_cast<double>(kMinParallelNs))
+    {
+        const std::uint64_t start = Profiler::now();
+        body(0, count);
+        grain.record_(count, Profiler::now() - start);
+        return;
+    }
+
+    std::size_t chunk = static_cast<std::size_t>(static_cast<double>(kTaskNs) / cost);
+    chunk = std::min(chunk, std::max<std::size_t>(1, count / (4 * threads)));
+    chunk = std::max(chunk, static_cast<std::size_t>(static_cast<double>(kMinTaskNs) / cost));
+    chunk = std::min(std::max<std::size_t>(1, chunk), count);
+
+    Job job;
+    job.body = &body;
+    job.timed = true;
+    dispatch_(job, count, chunk);
+    grain.record_(count, job.busyNs.load());
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+void TaskScheduler::dispatch_(Job& job, std::size_t count, std::size_t chunk)
+{
+    const std::size_t queues = m_queues.size();
+    const std::size_t tasks = (count + chunk - 1) / chunk;
+    const std::size_t first = m_next.fetch_add(1) % queues;
+    job.pending.store(tasks);
+    m_queued.fetch_add(tasks); // before the chunks can be taken, so the count never wraps
+
+    // Task k goes to queue (first + k) % queues, one lock per queue.
+    for (std::size_t q = 0; q < queues && q < tasks; ++q)
+    {
+        Queue& queue = *m_queues[(first + q) % queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (std::size_t k = q; k < tasks; k += queues)
+            queue.tasks.push_back(Task{ &job, k * chunk, std::min(count, (k + 1) * chunk) });
+    }
+    // m_queued was raised before m_sleepers is read and a worker raises m_sleepers before it
+    // checks m_queued (all sequentially consistent), so a worker going to sleep either sees
+    // these chunks or is woken here. Busy workers are not disturbed.
+    if (m_sleepers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_all();
+    }
+
+    // The caller helps while there are chunks to run (other jobs' chunks as well), then
+    // sleeps until the last of its own chunks, running on a worker, is finished.
+    for (int idle = 0; idle < kSpinRounds && job.pending.load(std::memory_order_acquire) > 0;)
+    {
+        if (tryRunOne_(queues - 1))
+            idle = 0;
+        else
+        {
+            ++idle;
+            std::this_thread::yield();
+        }
+    }
+    std::unique_lock<std::mutex> lock(job.doneMutex);
+    job.finished.wait(lock, [&] { return job.done; });
+}
+
+bool TaskScheduler::tryRunOne_(std::size_t self)
+{
+    const std::size_t queues = m_queues.size();
+    const bool caller = self + 1 == queues;
+    for (std::size_t i = 0; i < queues; ++i)
+    {
+        Queue& queue = *m_queues[(self + i) % queues];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        // own work from the back, stolen work (and the callers' shared queue) from the front
+        Task task;
+        if (i == 0 && !caller)
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        m_queued.fetch_sub(1);
+        lock.unlock();
+        run_(task);
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::run_(Task task)
+{
+    Job& job = *task.job;
+    if (!job.failed.load(std::memory_order_relaxed))
+    {
+        const std::uint64_t start = job.timed ? Profiler::now() : 0;
+        try
+        {
+            (*job.body)(task.begin, task.end);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) job.error = std::current_exception();
+            job.failed.store(true);
+        }
+        if (job.timed)
+            job.busyNs.fetch_add(Profiler::now() - start, std::memory_order_relaxed);
+    }
+    // The owner returns (and destroys the job) only once it has seen `done` under doneMutex,
+    // so the last chunk may still signal it here.
+    if (job.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard<std::mutex> lock(job.doneMutex);
+        job.done = true;
+        job.finished.notify_one();
+    }
+}
+
+void TaskScheduler::work_(std::size_t self)
+{
+    const auto ready = [this] { return m_stop.load() || m_queued.load() > 0; };
+    while (!m_stop.load())
+    {
+        if (tryRunOne_(self))
+            continue;
+
+        // Nothing to run: watch the queued count (no lock) for a short while, then sleep.
+        bool found = false;
+        for (int i = 0; i < kSpinRounds && !found; ++i)
+        {
+            std::this_thread::yield();
+            found = ready();
+        }
+        if (found)
+            continue;
+
+        m_sleepers.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, ready);
+        }
+        m_sleepers.fetch_sub(1);
+    }
+}
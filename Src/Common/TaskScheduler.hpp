@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file TaskScheduler.hpp
+ * @brief Work-stealing thread pool shared by the layer kernels and the batch drivers.
+ *
+ * parallelFor() cuts [0, count) into chunks and deals them round-robin into one deque per
+ * thread. A worker pops its own deque from the back and, once it runs dry, steals from the
+ * front of the others, so a layer whose neurons cost very different amounts (fan-in,
+ * refractory neurons, probes) still keeps every thread busy. The calling thread runs
+ * chunks too and returns when all of them are done; several threads may call parallelFor()
+ * at the same time (e.g. the workers of BIULayerPipeline).
+ *
+ * The tuned overload picks the chunk size from a ParallelGrain, the measured cost per item
+ * of one call site:
+ *
+ *   count * cost < kMinParallelNs   run inline on the caller (and measure again)
+ *   otherwise                       chunks of ~kTaskNs, but at least kMinTaskNs, and no
+ *                                   larger than count / (4 * threads) so there is
+ *                                   something left to steal
+ *
+ * Chunks only split the index range; every item is computed exactly as in a serial loop,
+ * so results do not depend on the number of threads.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Measured cost per item of one parallelFor() call site (see TaskScheduler).
+class ParallelGrain
+{
+public:
+    double nsPerItem() const { return m_nsPerItem; } // 0 until the first measurement
+
+private:
+    friend class TaskScheduler;
+    double m_nsPerItem = 0.0;
+    void record_(std::size_t items, std::uint64_t ns);
+};
+
+class TaskScheduler
+{
+public:
+    using RangeBody = std::function<void(std::size_t begin, std::size_t end)>;
+
+    static constexpr std::uint64_t kMinParallelNs = 20000; // below: not worth waking anyone
+    static constexpr std::uint64_t kTaskNs = 10000;        // target chunk duration
+    static constexpr std::uint64_t kMinTaskNs = 2000;      // a chunk pays for its own dispatch
+
+    /// @param threads  Threads that run chunks, the calling thread included (0 = one per core).
+    explicit TaskScheduler(unsigned threads);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned threads() const { return static_cast<unsigned>(m_queues.size()); }
+
+    /// body(begin, end) over [0, count) in chunks of `chunk` items. The first exception
+    /// thrown by a chunk is rethrown once every chunk has finished; the chunks not yet
+    /// started are skipped.
+    void parallelFor(std::size_t count, std::size_t chunk, const RangeBody& body);
+    /// Same, with the chunk size tuned from (and fed back into) `grain`.
+    void parallelFor(std::size_t count, ParallelGrain& grain, const RangeBody& body);
+
+private:
+    struct Job
+    {
+        const RangeBody* body;
+        std::atomic<std::size_t> pending{ 0 };   // chunks not finished
+        std::atomic<std::uint64_t> busyNs{ 0 };  // summed chunk run time (tuned calls only)
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        bool timed = false;
+        std::mutex doneMutex;                    // the owner waits here for the last chunk
+        std::condition_variable finished;
+        bool done = false;
+    };
+    struct Task
+    {
+        Job* job;
+        std::size_t begin, end;
+    };
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        char padding[64]; // keeps the next queue off this cache line (padding, not alignas: plain new)
+    };
+
+    // m_queues[0 .. threads-2] belong to the workers; the last one is shared by the callers.
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<std::size_t> m_next{ 0 };     // round-robin start of the next job
+    std::atomic<bool> m_stop{ false };
+    std::atomic<std::size_t> m_queued{ 0 };   // chunks in the queues (counted before they are pushed)
+    std::atomic<unsigned> m_sleepers{ 0 };    // workers about to sleep or asleep
+    std::mutex m_sleepMutex;                  // only taken to sleep and to wake sleepers
+    std::condition_variable m_wake;
+
+    void work_(std::size_t self);
+    bool tryRunOne_(std::size_t self);
+    void run_(Task task);
+    void dispatch_(Job& job, std::size_t count, std::size_t chunk);
+};
+
+/// parallelFor() on `scheduler`, or a plain body(0, count) when it is null.
+template <typename Body>
+void parallelFor(TaskScheduler* scheduler, std::size_t count, ParallelGrain& grain, Body&& body)
+{
+    if (!scheduler)
+    {
+        body(std::size_t(0), count);
+        return;
+    }
+    scheduler->parallelFor(count, grain, TaskScheduler::RangeBody(std::ref(body)));
+}
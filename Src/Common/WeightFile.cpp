@@ -0,0 +1,218 @@
+#include "WeightFile.hpp"
+#include "MappedFile.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+enum class ElementType { Float64, Float32, Int8 };
+
+struct Layout
+{
+    ElementType type = ElementType::Float64;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    bool fortranOrder = false;  // column-major (.npy only)
+    std::size_t offset = 0;     // first value
+};
+
+[[noreturn]] void fail(const std::string& path, const std::string& what)
+{
+    throw std::runtime_error("Weight file '" + path + "': " + what);
+}
+
+bool hostIsLittleEndian()
+{
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+template <typename T>
+T readLittleEndian(const unsigned char* data)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, data, sizeof(T));
+    if (!hostIsLittleEndian())
+    {
+        for (std::size_t i = 0; i < sizeof(T) / 2; ++i)
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+std::size_t elementSize(ElementType type)
+{
+    switch (type)
+    {
+    case ElementType::Float64: return 8;
+    case ElementType::Float32: return 4;
+    default:                   return 1;
+    }
+}
+
+// ---------------- .npy ----------------
+
+// Value of `key` in the header dictionary, e.g. 'descr': '<f8' -> "'<f8'".
+std::string npyField(const std::string& header, const std::string& key, const std::string& path)
+{
+    const std::size_t k = header.find("'" + key + "'");
+    if (k == std::string::npos) fail(path, "missing '" + key + "' in the .npy header");
+    std::size_t v = header.find(':', k);
+    if (v == std::string::npos) fail(path, "malformed .npy header");
+    ++v;
+    while (v < header.size() && header[v] == ' ') ++v;
+
+    std::size_t end = v;
+    if (v < header.size() && header[v] == '(')
+        end = header.find(')', v) + 1;
+    else if (v < header.size() && (header[v] == '\'' || header[v] == '"'))
+        end = header.find(header[v], v + 1) + 1;
+    else
+        while (end < header.size() && header[end] != ',' && header[end] != '}') ++end;
+    if (end == 0 || end > header.size()) fail(path, "malformed .npy header");
+    return header.substr(v, end - v);
+}
+
+Layout parseNpy(const unsigned char* data, std::size_t size, const std::string& path)
+{
+    if (size < 10) fail(path, "truncated .npy header");
+    const unsigned major = data[6];
+    std::size_t headerLen, headerStart;
+    if (major == 1)
+    {
+        headerLen = readLittleEndian<std::uint16_t>(data + 8);
+        headerStart = 10;
+    }
+    else if (major == 2 || major == 3)
+    {
+        if (size < 12) fail(path, "truncated .npy header");
+        headerLen = readLittleEndian<std::uint32_t>(data + 8);
+        headerStart = 12;
+    }
+    else
+    {
+        fail(path, "unsupported .npy format version " + std::to_string(major));
+    }
+    if (headerStart + headerLen > size) fail(path, "truncated .npy header");
+
+    const std::string header(reinterpret_cast<const char*>(data + headerStart), headerLen);
+    Layout layout;
+    layout.offset = headerStart + headerLen;
+
+    const std::string descr = npyField(header, "descr", path);
+    if (descr == "'<f8'")      layout.type = ElementType::Float64;
+    else if (descr == "'<f4'") layout.type = ElementType::Float32;
+    else if (descr == "'|i1'" || descr == "'<i1'") layout.type = ElementType::Int8;
+    else fail(path, "unsupported dtype " + descr + " (use little-endian float64, float32 or int8)");
+
+    layout.fortranOrder = (npyField(header, "fortran_order", path) == "True");
+
+    const std::string shape = npyField(header, "shape", path); // "(rows, cols)"
+    char* end = nullptr;
+    const char* p = shape.c_str() + 1;
+    const unsigned long long rows = std::strtoull(p, &end, 10);
+    if (end == p || *end != ',') fail(path, "weights must be a 2-D array, got shape " + shape);
+    p = end + 1;
+    const unsigned long long cols = std::strtoull(p, &end, 10);
+    while (*end == ' ') ++end;
+    if (end == p || *end != ')') fail(path, "weights must be a 2-D array, got shape " + shape);
+    layout.rows = static_cast<std::size_t>(rows);
+    layout.cols = static_cast<std::size_t>(cols);
+    return layout;
+}
+
+// ---------------- NemoSim raw ----------------
+
+Layout parseRaw(const unsigned char* data, std::size_t size, const std::string& path)
+{
+    if (size < 32) fail(path, "truncated header");
+    if (readLittleEndian<std::uint32_t>(data + 8) != 1)
+        fail(path, "unsupported version " + std::to_string(readLittleEndian<std::uint32_t>(data + 8)));
+
+    Layout layout;
+    switch (readLittleEndian<std::uint32_t>(data + 12))
+    {
+    case 0: layout.type = ElementType::Float64; break;
+    case 1: layout.type = ElementType::Float32; break;
+    case 2: layout.type = ElementType::Int8;    break;
+    default: fail(path, "unknown dtype code " + std::to_string(readLittleEndian<std::uint32_t>(data + 12)));
+    }
+    layout.rows = static_cast<std::size_t>(readLittleEndian<std::uint64_t>(data + 16));
+    layout.cols = static_cast<std::size_t>(readLittleEndian<std::uint64_t>(data + 24));
+    layout.offset = 32;
+    return layout;
+}
+
+double valueAt(const unsigned char* values, ElementType type, std::size_t index)
+{
+    switch (type)
+    {
+    case ElementType::Float64: return readLittleEndian<double>(values + index * 8);
+    case ElementType::Float32: return static_cast<double>(readLittleEndian<float>(values + index * 4));
+    default:                   return static_cast<double>(static_cast<std::int8_t>(values[index]));
+    }
+}
+
+} // namespace
+
+WeightMatrix loadWeightFile(const std::string& path)
+{
+    std::shared_ptr<const MappedFile> file;
+    try
+    {
+        file = std::make_shared<const MappedFile>(path);
+    }
+    catch (const std::exception&)
+    {
+        fail(path, "cannot open the file");
+    }
+
+    const unsigned char* data = file->data();
+    const std::size_t size = file->size();
+    Layout layout;
+    if (size >= 6 && std::memcmp(data, "\x93NUMPY", 6) == 0)
+        layout = parseNpy(data, size, path);
+    else if (size >= 8 && std::memcmp(data, "NEMOWGT\0", 8) == 0)
+        layout = parseRaw(data, size, path);
+    else
+        fail(path, "not a .npy or NemoSim weight file");
+
+    const std::size_t width = elementSize(layout.type);
+    if (layout.cols != 0 && layout.rows > (size - layout.offset) / width / layout.cols)
+        fail(path, "shape " + std::to_string(layout.rows) + "x" + std::to_string(layout.cols) + " is larger than the file");
+    const std::size_t count = layout.rows * layout.cols;
+    const unsigned char* values = data + layout.offset;
+
+    // every weight must be finite (same rule as inline <row> weights)
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!std::isfinite(valueAt(values, layout.type, i)))
+        {
+            const std::size_t r = layout.fortranOrder ? i % layout.rows : i / layout.cols;
+            const std::size_t c = layout.fortranOrder ? i / layout.rows : i % layout.cols;
+            fail(path, "invalid weight value (NaN or Inf) at row " + std::to_string(r) + ", column " + std::to_string(c));
+        }
+    }
+
+    if (layout.type == ElementType::Float64 && !layout.fortranOrder && hostIsLittleEndian() &&
+        reinterpret_cast<std::uintptr_t>(values) % alignof(double) == 0)
+    {
+        return WeightMatrix::view(reinterpret_cast<const double*>(values), layout.rows, layout.cols, file);
+    }
+
+    std::vector<double> converted(count);
+    for (std::size_t r = 0; r < layout.rows; ++r)
+        for (std::size_t c = 0; c < layout.cols; ++c)
+            converted[r * layout.cols + c] =
+                valueAt(values, layout.type, layout.fortranOrder ? c * layout.rows + r : r * layout.cols + c);
+    return WeightMatrix(layout.rows, layout.cols, std::move(converted));
+}
@@ -0,0 +1,23 @@
+#pragma once
+/**
+ * @file WeightFile.hpp
+ * @brief Binary weight matrices stored next to the network XML (<weights file="...">).
+ *
+ * Two formats are accepted, told apart by their magic bytes:
+ *
+ *  - NumPy .npy (format 1.0-3.0), 2-D, C or Fortran order, dtype '<f8', '<f4' or '|i1'.
+ *  - NemoSim raw weights, little-endian:
+ *      "NEMOWGT\0" | u32 version (1) | u32 dtype (0 = float64, 1 = float32, 2 = int8) |
+ *      u64 rows | u64 cols | rows * cols values, row-major, starting at byte 32
+ *
+ * The file is memory-mapped. Little-endian float64 data in C order is used in place (the
+ * matrix keeps the mapping alive); other element types are converted to double. Every
+ * value must be finite.
+ */
+
+#include <string>
+#include "WeightMatrix.hpp"
+
+/// Loads the [rows][cols] matrix stored in `path`.
+/// Throws std::runtime_error("Weight file '<path>': <problem>") if it cannot be used.
+WeightMatrix loadWeightFile(const std::string& path);
@@ -0,0 +1,105 @@
+#pragma once
+/**
+ * @file WeightMatrix.hpp
+ * @brief Dense row-major weight matrix shared between the parser, a network image and
+ *        the networks that read it.
+ *
+ * The values either live in a vector the matrix owns, or in memory owned by someone
+ * else (e.g. a memory-mapped network image), kept alive through a shared owner handle.
+ * Copies are cheap and share the same values, so a network built from the parameters
+ * does not duplicate its weights.
+ *
+ * Row access mirrors the std::vector<std::vector<double>> it replaces:
+ * m.size() is the row count, m[r].size() the column count and m[r][c] a value.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Row view of row-major values of type T; WeightMatrix::Row is the double one, single
+/// precision kernels (see Precision.hpp) read float copies through the same interface.
+template <typename T>
+class BasicWeightRow
+{
+public:
+    BasicWeightRow(const T* data, std::size_t size) : m_data(data), m_size(size) {}
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T* data() const { return m_data; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    T operator[](std::size_t c) const { return m_data[c]; }
+
+private:
+    const T* m_data;
+    std::size_t m_size;
+};
+
+class WeightMatrix
+{
+public:
+    /// One row of a WeightMatrix; valid while the matrix (or a copy of it) is alive.
+    using Row = BasicWeightRow<double>;
+
+    WeightMatrix() = default;
+
+    /// Takes ownership of `values` (row-major, rows * cols entries).
+    WeightMatrix(std::size_t rows, std::size_t cols, std::vector<double>&& values)
+    {
+        if (values.size() != rows * cols)
+            throw std::invalid_argument("WeightMatrix: value count does not match rows * cols.");
+        auto owned = std::make_shared<std::vector<double>>(std::move(values));
+        m_data = owned->data();
+        m_owner = std::move(owned);
+        m_rows = rows;
+        m_cols = cols;
+    }
+
+    /// Copies nested rows; throws "<name> is not rectangular." if their lengths differ.
+    static WeightMatrix fromRows(const std::vector<std::vector<double>>& rows,
+                                 const std::string& name = "WeightMatrix")
+    {
+        const std::size_t cols = rows.empty() ? 0 : rows.front().size();
+        std::vector<double> values;
+        values.reserve(rows.size() * cols);
+        for (const auto& row : rows)
+        {
+            if (row.size() != cols)
+                throw std::invalid_argument(name + " is not rectangular.");
+            values.insert(values.end(), row.begin(), row.end());
+        }
+        return WeightMatrix(rows.size(), cols, std::move(values));
+    }
+
+    /// Non-owning view of `rows * cols` values; `owner` keeps the memory alive.
+    static WeightMatrix view(const double* data, std::size_t rows, std::size_t cols,
+                             std::shared_ptr<const void> owner)
+    {
+        WeightMatrix m;
+        m.m_data = data;
+        m.m_rows = rows;
+        m.m_cols = cols;
+        m.m_owner = std::move(owner);
+        return m;
+    }
+
+    std::size_t rows() const { return m_rows; }
+    std::size_t cols() const { return m_cols; }
+    std::size_t size() const { return m_rows; }
+    bool empty() const { return m_rows == 0; }
+    const double* data() const { return m_data; }
+
+    Row operator[](std::size_t r) const { return Row(m_data + r * m_cols, m_cols); }
+    Row front() const { return (*this)[0]; }
+    double operator()(std::size_t r, std::size_t c) const { return m_data[r * m_cols + c]; }
+
+private:
+    std::shared_ptr<const void> m_owner;
+    const double* m_data = nullptr;
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+};
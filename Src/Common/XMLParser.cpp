@@ -5,6 +5,10 @@
 #include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include "NumberParser.hpp"
+#include "XmlPullReader.hpp"
+#include "WeightFile.hpp"
 
 using namespace tinyxml2;
 
@@ -16,6 +20,13 @@ static Verbosity parseVerbosityValue(const std::string& v) {
     return Verbosity::Info;
 }
 
+// helper to parse boolean switches ("true"/"1"/"yes")
+static bool parseBoolValue(const std::string& v) {
+    std::string s = v;
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return (s == "true" || s == "1" || s == "yes");
+}
+
 // ---------------- utils ----------------
 
 static std::string trim(const std::string& str)
@@ -37,7 +48,35 @@ static ConfigKey getConfigKey(const std::string& key)
         {"neuron_energy_table_path", ConfigKey::NeuronEnergyCsvPath},
         {"synapses_energy_table_path", ConfigKey::SynapsesEnergyCsvPath},
         {"progress_interval_seconds", ConfigKey::ProgressIntervalSeconds},
-        {"verbosity", ConfigKey::Verbosity} // NEW (lowercase key for sidecar file)
+        {"verbosity", ConfigKey::Verbosity}, // NEW (lowercase key for sidecar file)
+        {"quiescent_fast_forward", ConfigKey::QuiescentFastForward},
+        {"early_exit_mode", ConfigKey::EarlyExitMode},
+        {"early_exit_tolerance", ConfigKey::EarlyExitTolerance},
+        {"pipeline", ConfigKey::Pipeline},
+        {"pipeline_depth", ConfigKey::PipelineDepth},
+        {"checkpoint_path", ConfigKey::CheckpointPath},
+        {"checkpoint_every_lines", ConfigKey::CheckpointEveryLines},
+        {"checkpoint_every_seconds", ConfigKey::CheckpointEverySeconds},
+        {"network_image", ConfigKey::NetworkImage},
+        {"xml_streaming", ConfigKey::XmlStreaming},
+        {"profile", ConfigKey::Profile},
+        {"profile_report", ConfigKey::ProfileReport},
+        {"profile_hardware_counters", ConfigKey::ProfileHardwareCounters},
+        {"probes", ConfigKey::Probes},
+        {"spike_stats", ConfigKey::SpikeStats},
+        {"spike_stats_file", ConfigKey::SpikeStatsFile},
+        {"spike_stats_bin_lines", ConfigKey::SpikeStatsBinLines},
+        {"readout", ConfigKey::Readout},
+        {"readout_file", ConfigKey::ReadoutFile},
+        {"readout_labels", ConfigKey::ReadoutLabels},
+        {"precision", ConfigKey::Precision},
+        {"fixed_vn_bits", ConfigKey::FixedVnBits},
+        {"fixed_ratio_bits", ConfigKey::FixedRatioBits},
+        {"biu_pattern_lut", ConfigKey::BiuPatternLut},
+        {"biu_layer_pipeline", ConfigKey::BiuLayerPipeline},
+        {"compute_threads", ConfigKey::ComputeThreads},
+        {"reset_every_lines", ConfigKey::ResetEveryLines},
+        {"shards", ConfigKey::Shards}
     };
 
     auto it = keyMap.find(key);
@@ -121,7 +160,16 @@ void XMLParser::applyNeuronRanges(XMLElement* layer, int size,
 bool XMLParser::parse(const std::string& filename, NetworkParameters& params)
 {
     XMLDocument doc;
-    if (doc.LoadFile(filename.c_str()) != XML_SUCCESS)
+    m_preparsed.clear();
+    m_weightFiles.clear();
+    const size_t slash = filename.find_last_of("/\\");
+    m_baseDir = (slash == std::string::npos) ? std::string() : filename.substr(0, slash + 1);
+    if (m_streaming)
+    {
+        if (!loadStreaming_(filename, doc))
+            return false;
+    }
+    else if (doc.LoadFile(filename.c_str()) != XML_SUCCESS)
     {
         std::cerr << "Error loading XML file '" << filename << "': " << doc.ErrorStr() << std::endl;
         return false;
@@ -195,9 +243,228 @@ bool XMLParser::parse(const std::string& filename, NetworkParameters& params)
         std::cout << "ANN: PEs parsed = " << params.annPEs.size() << "\n";
     }
 
+    params.weightFiles = m_weightFiles;
+    m_preparsed.clear();
     return true;
 }
 
+// ---------------- streaming mode ----------------
+
+// Marks a <weights> element of the skeleton document whose rows were parsed while streaming.
+static const char* const kPreparsedAttribute = "nemosim-preparsed";
+
+static void appendEscaped(std::string& out, const std::string& text)
+{
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default:  out += c; break;
+        }
+    }
+}
+
+// Walks the file once with a pull parser. The numbers of every <row> under a <weights>
+// element go straight into that element's weight buffer (reserved from the rows/cols
+// attributes of its parent); everything else is copied into a small skeleton document,
+// which is what the regular parsers then walk. Peak memory is the weights plus one row.
+bool XMLParser::loadStreaming_(const std::string& filename, XMLDocument& doc)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Error loading XML file '" << filename << "': cannot open the file" << std::endl;
+        return false;
+    }
+
+    std::string skeleton;
+    try
+    {
+        XmlPullReader reader(in);
+        XmlPullReader::Event ev;
+        std::vector<std::pair<long long, long long>> dims; // rows/cols attributes of the open elements
+        PreparsedWeights* weights = nullptr;               // <weights> element being read
+        size_t depth = 0, weightsDepth = 0;                // open elements; depth inside <weights>
+        bool inRow = false, rowFirstNode = false, rowHasText = false;
+        std::string rowText;
+
+        while (reader.next(ev))
+        {
+            switch (ev.type)
+            {
+            case XmlPullReader::EventType::StartElement:
+                if (inRow)
+                {
+                    rowFirstNode = true; // an element first: GetText() would be null
+                    ++depth;
+                    continue;
+                }
+                if (weights && depth == weightsDepth && ev.name == "row")
+                {
+                    inRow = true;
+                    rowFirstNode = false;
+                    rowHasText = false;
+                    rowText.clear();
+                    ++depth;
+                    continue;
+                }
+                if (!weights && ev.name == "weights")
+                {
+                    m_preparsed.emplace_back();
+                    weights = &m_preparsed.back();
+                    weightsDepth = depth + 1;
+                    if (!dims.empty() && dims.back().first > 0 && dims.back().second > 0 &&
+                        dims.back().first < (1LL << 24) && dims.back().second < (1LL << 24))
+                        weights->values.reserve(static_cast<size_t>(dims.back().first * dims.back().second));
+                    ev.attributes.push_back({ kPreparsedAttribute, std::to_string(m_preparsed.size() - 1) });
+                }
+                {
+                    std::pair<long long, long long> d(0, 0);
+                    skeleton += '<';
+                    skeleton += ev.name;
+                    for (const auto& attr : ev.attributes)
+                    {
+                        if (attr.name == "rows") d.first = std::atoll(attr.value.c_str());
+                        if (attr.name == "cols") d.second = std::atoll(attr.value.c_str());
+                        skeleton += ' ';
+                        skeleton += attr.name;
+                        skeleton += "=\"";
+                        appendEscaped(skeleton, attr.value);
+                        skeleton += '"';
+                    }
+                    skeleton += '>';
+                    dims.push_back(d);
+                }
+                ++depth;
+                break;
+
+            case XmlPullReader::EventType::EndElement:
+                --depth;
+                if (inRow)
+                {
+                    if (depth == weightsDepth) // </row>
+                    {
+                        inRow = false;
+                        if (weights->failed)
+                            continue;
+                        PreparsedRow row;
+                        row.hasText = rowHasText;
+                        if (rowHasText)
+                            row.numbers = parseNumberRow(rowText.c_str(), weights->values);
+                        weights->failed = !row.hasText || row.numbers.status != NumberStatus::Ok;
+                        weights->rows.push_back(std::move(row));
+                    }
+                    continue;
+                }
+                if (weights && depth < weightsDepth)
+                    weights = nullptr;
+                skeleton += "</";
+                skeleton += ev.name;
+                skeleton += '>';
+                dims.pop_back();
+                break;
+
+            case XmlPullReader::EventType::Text:
+                if (inRow)
+                {
+                    if (!rowFirstNode)
+                    {
+                        rowFirstNode = true;
+                        rowHasText = true;
+                        rowText.swap(ev.text);
+                    }
+                    continue;
+                }
+                appendEscaped(skeleton, ev.text);
+                break;
+
+            case XmlPullReader::EventType::Comment:
+                if (inRow)
+                    continue; // GetText() skips leading comments too
+                skeleton += "<!--";
+                skeleton += ev.text;
+                skeleton += "-->";
+                break;
+            }
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error loading XML file '" << filename << "': " << ex.what() << std::endl;
+        return false;
+    }
+
+    if (doc.Parse(skeleton.data(), skeleton.size()) != XML_SUCCESS)
+    {
+        std::cerr << "Error loading XML file '" << filename << "': " << doc.ErrorStr() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Walks the <row>s of one <weights> element, collecting their numbers row-major in values().
+// The rows come from the DOM, or were already parsed by loadStreaming_().
+class XMLParser::WeightRowCursor
+{
+public:
+    WeightRowCursor(XMLElement* weightsElem, std::vector<PreparsedWeights>& preparsed, size_t reserveHint)
+    {
+        int index = -1;
+        if (weightsElem->QueryIntAttribute(kPreparsedAttribute, &index) == XML_SUCCESS &&
+            index >= 0 && static_cast<size_t>(index) < preparsed.size())
+        {
+            m_preparsed = &preparsed[index];
+            m_values.swap(m_preparsed->values);
+        }
+        else
+        {
+            m_values.reserve(reserveHint);
+            m_rowElem = weightsElem->FirstChildElement("row");
+        }
+    }
+
+    /// Advances to the next <row>; false when there are no more.
+    bool next()
+    {
+        m_rowBegin += m_row.count;
+        if (m_preparsed)
+        {
+            if (m_index >= m_preparsed->rows.size())
+                return false;
+            const PreparsedRow& row = m_preparsed->rows[m_index++];
+            m_hasText = row.hasText;
+            m_row = row.numbers;
+            return true;
+        }
+
+        if (!m_rowElem)
+            return false;
+        const char* text = m_rowElem->GetText();
+        m_rowElem = m_rowElem->NextSiblingElement("row");
+        m_hasText = (text != nullptr);
+        m_row = m_hasText ? parseNumberRow(text, m_values) : NumberRowResult();
+        return true;
+    }
+
+    bool hasText() const { return m_hasText; }                 // false for an empty <row>
+    const NumberRowResult& row() const { return m_row; }       // numbers of the current row
+    size_t rowBegin() const { return m_rowBegin; }             // first number of the row in values()
+    std::vector<double>& values() { return m_values; }
+
+private:
+    PreparsedWeights* m_preparsed = nullptr;
+    size_t m_index = 0;
+    XMLElement* m_rowElem = nullptr;
+    std::vector<double> m_values;
+    NumberRowResult m_row;
+    size_t m_rowBegin = 0;
+    bool m_hasText = false;
+};
+
 // ---------------- public: CFG entry ----------------
 
 Config XMLParser::parseConfigFromFile(const std::string& filePath)
@@ -260,6 +527,155 @@ Config XMLParser::parseConfigFromFile(const std::string& filePath)
         case ConfigKey::Verbosity:
             config.verbosity = parseVerbosityValue(value);
             break;
+        case ConfigKey::QuiescentFastForward:
+            config.quiescentFastForward = parseBoolValue(value);
+            break;
+        case ConfigKey::EarlyExitMode:
+        {
+            std::string mode = value;
+            std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+            auto it = StringToEarlyExitMode.find(mode);
+            if (it == StringToEarlyExitMode.end())
+            {
+                throw std::runtime_error("Configuration Error: Unknown early_exit_mode '" + value + "'. Valid values are: off, strict, tolerance");
+            }
+            config.earlyExitMode = it->second;
+            break;
+        }
+        case ConfigKey::EarlyExitTolerance:
+            config.earlyExitTolerance = std::stod(value);
+            if (config.earlyExitTolerance <= 0.0)
+            {
+                throw std::runtime_error("Configuration Error: early_exit_tolerance must be positive, got: " + value);
+            }
+            break;
+        case ConfigKey::Pipeline:
+            config.pipeline = parseBoolValue(value);
+            break;
+        case ConfigKey::PipelineDepth:
+            config.pipelineDepth = std::stoi(value);
+            if (config.pipelineDepth <= 0)
+            {
+                throw std::runtime_error("Configuration Error: pipeline_depth must be positive, got: " + value);
+            }
+            break;
+        case ConfigKey::CheckpointPath:
+            config.checkpointPath = value;
+            break;
+        case ConfigKey::CheckpointEveryLines:
+            config.checkpointEveryLines = std::stoi(value);
+            if (config.checkpointEveryLines < 0)
+            {
+                throw std::runtime_error("Configuration Error: checkpoint_every_lines must not be negative, got: " + value);
+            }
+            break;
+        case ConfigKey::CheckpointEverySeconds:
+            config.checkpointEverySeconds = std::stod(value);
+            if (config.checkpointEverySeconds < 0.0)
+            {
+                throw std::runtime_error("Configuration Error: checkpoint_every_seconds must not be negative, got: " + value);
+            }
+            break;
+        case ConfigKey::NetworkImage:
+            config.networkImagePath = value;
+            break;
+        case ConfigKey::XmlStreaming:
+            config.xmlStreaming = parseBoolValue(value);
+            break;
+        case ConfigKey::Profile:
+            config.profile = parseBoolValue(value);
+            break;
+        case ConfigKey::ProfileReport:
+            if (value.empty())
+            {
+                throw std::runtime_error("Configuration Error: profile_report must not be empty");
+            }
+            config.profileReport = value;
+            break;
+        case ConfigKey::ProfileHardwareCounters:
+            config.profileHardwareCounters = parseBoolValue(value);
+            break;
+        case ConfigKey::Probes:
+            config.probes = parseProbeSpec(value);
+            break;
+        case ConfigKey::SpikeStats:
+            config.spikeStats = parseBoolValue(value);
+            break;
+        case ConfigKey::SpikeStatsFile:
+            if (value.empty())
+                throw std::runtime_error("Configuration Error: spike_stats_file must not be empty");
+            config.spikeStatsFile = value;
+            break;
+        case ConfigKey::SpikeStatsBinLines:
+            config.spikeStatsBinLines = std::stoi(value);
+            if (config.spikeStatsBinLines < 1)
+                throw std::runtime_error("Configuration Error: spike_stats_bin_lines must be at least 1");
+            break;
+        case ConfigKey::Readout:
+        {
+            std::string mode = value;
+            std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+            auto it = StringToReadoutMode.find(mode);
+            if (it == StringToReadoutMode.end())
+            {
+                throw std::runtime_error("Configuration Error: Unknown readout '" + value + "'. Valid values are: off, counts, latency");
+            }
+            config.readoutMode = it->second;
+            break;
+        }
+        case ConfigKey::ReadoutFile:
+            if (value.empty())
+                throw std::runtime_error("Configuration Error: readout_file must not be empty");
+            config.readoutFile = value;
+            break;
+        case ConfigKey::ReadoutLabels:
+            config.readoutLabelsPath = value;
+            break;
+        case ConfigKey::Precision:
+        {
+            std::string precision = value;
+            std::transform(precision.begin(), precision.end(), precision.begin(), ::tolower);
+            auto it = StringToPrecision.find(precision);
+            if (it == StringToPrecision.end())
+            {
+                throw std::runtime_error("Configuration Error: Unknown precision '" + value + "'. Valid values are: double, float, fixed");
+            }
+            config.precision = it->second;
+            break;
+        }
+        case ConfigKey::FixedVnBits:
+            config.fixedPoint.vnBits = std::stoi(value);
+            if (config.fixedPoint.vnBits < 4 || config.fixedPoint.vnBits > 30)
+                throw std::runtime_error("Configuration Error: fixed_vn_bits must be between 4 and 30");
+            break;
+        case ConfigKey::FixedRatioBits:
+            config.fixedPoint.ratioBits = std::stoi(value);
+            if (config.fixedPoint.ratioBits < 4 || config.fixedPoint.ratioBits > 30)
+                throw std::runtime_error("Configuration Error: fixed_ratio_bits must be between 4 and 30");
+            break;
+        case ConfigKey::BiuPatternLut:
+            config.biuPatternLutInputs = std::stoi(value);
+            if (config.biuPatternLutInputs < 0 || config.biuPatternLutInputs > 16)
+                throw std::runtime_error("Configuration Error: biu_pattern_lut must be between 0 and 16");
+            break;
+        case ConfigKey::BiuLayerPipeline:
+            config.biuLayerPipeline = parseBoolValue(value);
+            break;
+        case ConfigKey::ComputeThreads:
+            config.computeThreads = std::stoi(value);
+            if (config.computeThreads < 0)
+                throw std::runtime_error("Configuration Error: compute_threads must be >= 0 (0 = one per core)");
+            break;
+        case ConfigKey::ResetEveryLines:
+            config.resetEveryLines = std::stoi(value);
+            if (config.resetEveryLines < 0)
+                throw std::runtime_error("Configuration Error: reset_every_lines must be >= 0 (0 = never)");
+            break;
+        case ConfigKey::Shards:
+            config.shards = std::stoi(value);
+            if (config.shards < 0)
+                throw std::runtime_error("Configuration Error: shards must be >= 0 (0 = one per core)");
+            break;
         default:
             std::cerr << "Unknown config key: " << key << std::endl;
             break;
@@ -271,6 +687,45 @@ Config XMLParser::parseConfigFromFile(const std::string& filePath)
 
 // ---------------- legacy parsers (kept, minimal but safe) ----------------
 
+// <weights file="..."> : the matrix comes from a binary sidecar file (see WeightFile.hpp)
+// instead of <row> elements. A relative path is relative to the XML file. When `shapeElem`
+// declares rows/cols they must match the file.
+WeightMatrix XMLParser::loadWeightFile_(XMLElement* weightsElem, XMLElement* shapeElem, const std::string& context)
+{
+    const std::string file = weightsElem->Attribute("file");
+    const bool absolute = !file.empty() && (file[0] == '/' || file[0] == '\\' || (file.size() > 1 && file[1] == ':'));
+    const std::string path = absolute ? file : m_baseDir + file;
+
+    WeightRowCursor rows(weightsElem, m_preparsed, 0);
+    if (rows.next())
+        throw std::runtime_error(context + ": <weights file=\"" + file + "\"> cannot also contain <row> elements");
+
+    WeightMatrix W;
+    try
+    {
+        W = loadWeightFile(path);
+    }
+    catch (const std::exception& ex)
+    {
+        throw std::runtime_error(context + ": " + ex.what());
+    }
+
+    int declaredRows = -1, declaredCols = -1;
+    shapeElem->QueryIntAttribute("rows", &declaredRows);
+    shapeElem->QueryIntAttribute("cols", &declaredCols);
+    if ((declaredRows >= 0 && static_cast<size_t>(declaredRows) != W.rows()) ||
+        (declaredCols >= 0 && static_cast<size_t>(declaredCols) != W.cols()))
+    {
+        std::ostringstream oss;
+        oss << context << ": weight file '" << path << "' holds a " << W.rows() << "x" << W.cols()
+            << " matrix but <" << shapeElem->Name() << "> declares rows=" << declaredRows << " cols=" << declaredCols;
+        throw std::runtime_error(oss.str());
+    }
+
+    m_weightFiles.push_back(path);
+    return W;
+}
+
 void XMLParser::LIFNetworkParser(XMLElement* LIF, XMLElement* arch, NetworkParameters& params) {
     parseDouble(LIF, "Cm", params.Cm);
     parseDouble(LIF, "Cf", params.Cf);
@@ -395,36 +850,56 @@ void XMLParser::BIUNetworkParser(XMLElement* BIU, XMLElement* arch, NetworkParam
             if (synapses)
             {
                 auto* weightsElem = synapses->FirstChildElement("weights");
-                std::vector<std::vector<double>> layerWeights;
-                if (weightsElem)
+                WeightMatrix layerMatrix; // [neurons][inputs]
+                if (weightsElem && weightsElem->Attribute("file"))
+                {
+                    std::ostringstream context;
+                    context << "BIU Configuration Error: Layer " << layerIdx;
+                    layerMatrix = loadWeightFile_(weightsElem, synapses, context.str());
+                    if (layerMatrix.cols() == 0 && layerMatrix.rows() != 0)
+                    {
+                        std::ostringstream oss;
+                        oss << "BIU Configuration Error: Layer " << layerIdx << ", row 0 has no weights";
+                        throw std::runtime_error(oss.str());
+                    }
+                }
+                else if (weightsElem)
                 {
-                    int rowIdx = 0;
+                    std::vector<double> layerWeights; // row-major [neurons][inputs]
+                    size_t weightRows = 0;
                     size_t expectedInputs = 0;
-                    for (auto* rowElem = weightsElem->FirstChildElement("row"); rowElem != nullptr; rowElem = rowElem->NextSiblingElement("row"), ++rowIdx)
+                    // rows/cols attributes (optional) only size the buffer; the rows themselves are validated below
+                    int rowsHint = 0, colsHint = 0;
+                    synapses->QueryIntAttribute("rows", &rowsHint);
+                    synapses->QueryIntAttribute("cols", &colsHint);
+                    WeightRowCursor rows(weightsElem, m_preparsed,
+                                         (rowsHint > 0 && colsHint > 0) ? static_cast<size_t>(rowsHint) * static_cast<size_t>(colsHint) : 0);
+
+                    for (int rowIdx = 0; rows.next(); ++rowIdx)
                     {
-                        const char* rowText = rowElem->GetText();
-                        if (!rowText)
+                        if (!rows.hasText())
                         {
                             std::ostringstream oss;
                             oss << "BIU Configuration Error: Empty <row> in weights at layer " << layerIdx << ", row " << rowIdx;
                             throw std::runtime_error(oss.str());
                         }
-                        std::istringstream iss(rowText);
-                        std::vector<double> rowWeights;
-                        double w;
-                        while (iss >> w)
+                        const NumberRowResult& row = rows.row();
+                        if (row.status == NumberStatus::NonFinite)
                         {
-                            if (!std::isfinite(w))
-                            {
-                                std::ostringstream oss;
-                                oss << "BIU Configuration Error: Invalid weight value (NaN or Inf) at layer " << layerIdx 
-                                    << ", row " << rowIdx;
-                                throw std::runtime_error(oss.str());
-                            }
-                            rowWeights.push_back(w);
+                            std::ostringstream oss;
+                            oss << "BIU Configuration Error: Invalid weight value (NaN or Inf) at layer " << layerIdx 
+                                << ", row " << rowIdx;
+                            throw std::runtime_error(oss.str());
+                        }
+                        if (row.status == NumberStatus::NotANumber)
+                        {
+                            std::ostringstream oss;
+                            oss << "BIU Configuration Error: Invalid weight value '" << row.badToken << "' at layer " << layerIdx 
+                                << ", row " << rowIdx;
+                            throw std::runtime_error(oss.str());
                         }
                         
-                        if (rowWeights.empty())
+                        if (row.count == 0)
                         {
                             std::ostringstream oss;
                             oss << "BIU Configuration Error: Layer " << layerIdx << ", row " << rowIdx 
@@ -435,19 +910,20 @@ void XMLParser::BIUNetworkParser(XMLElement* BIU, XMLElement* arch, NetworkParam
                         // Set expected input count from first row
                         if (rowIdx == 0)
                         {
-                            expectedInputs = rowWeights.size();
+                            expectedInputs = row.count;
                         }
-                        else if (rowWeights.size() != expectedInputs)
+                        else if (row.count != expectedInputs)
                         {
                             std::ostringstream oss;
                             oss << "BIU Configuration Error: Layer " << layerIdx << ", row " << rowIdx 
-                                << " has " << rowWeights.size() << " weights, expected " << expectedInputs 
+                                << " has " << row.count << " weights, expected " << expectedInputs 
                                 << " (all neurons in a layer must have the same number of inputs)";
                             throw std::runtime_error(oss.str());
                         }
-                        
-                        layerWeights.push_back(rowWeights);
+                        ++weightRows;
                     }
+                    layerWeights.swap(rows.values());
+                    layerMatrix = WeightMatrix(weightRows, expectedInputs, std::move(layerWeights));
                 }
                 else
                 {
@@ -457,15 +933,15 @@ void XMLParser::BIUNetworkParser(XMLElement* BIU, XMLElement* arch, NetworkParam
                 }
                 
                 // Validate weight matrix dimensions match layer size
-                if (layerWeights.size() != static_cast<size_t>(size))
+                if (layerMatrix.rows() != static_cast<size_t>(size))
                 {
                     std::ostringstream oss;
-                    oss << "BIU Configuration Error: Layer " << layerIdx << " has " << layerWeights.size() 
+                    oss << "BIU Configuration Error: Layer " << layerIdx << " has " << layerMatrix.rows() 
                         << " weight rows but layer size is " << size << " (must match number of neurons)";
                     throw std::runtime_error(oss.str());
                 }
                 
-                params.allWeights.push_back(layerWeights);
+                params.allWeights.push_back(std::move(layerMatrix));
             }
             else
             {
@@ -593,16 +1069,20 @@ void XMLParser::BIUNetworkParser(XMLElement* BIU, XMLElement* arch, NetworkParam
 void XMLParser::YFlashParser(XMLElement* YFlash, NetworkParameters& params, int yFlashIndex)
 {
     auto* weightsElem = YFlash->FirstChildElement("weights");
-    std::vector<std::vector<double>> layerWeights;
+    if (weightsElem && weightsElem->Attribute("file"))
+    {
+        params.YFlashWeights.push_back(loadWeightFile_(weightsElem, YFlash, "Error: YFlash index " + std::to_string(yFlashIndex)));
+        return;
+    }
+
+    std::vector<double> values;
+    size_t rowCount = 0, colCount = 0;
     if (weightsElem)
     {
-        int rowIdx = 0;
-        for (auto* rowElem = weightsElem->FirstChildElement("row");
-            rowElem != nullptr;
-            rowElem = rowElem->NextSiblingElement("row"), ++rowIdx)
+        WeightRowCursor rows(weightsElem, m_preparsed, 0);
+        for (int rowIdx = 0; rows.next(); ++rowIdx)
         {
-            const char* rowText = rowElem->GetText();
-            if (!rowText)
+            if (!rows.hasText())
             {
                 std::ostringstream oss;
                 oss << "Error: Empty <row> in <weights> at row "
@@ -610,13 +1090,29 @@ void XMLParser::YFlashParser(XMLElement* YFlash, NetworkParameters& params, int
                 throw std::runtime_error(oss.str());
             }
 
-            std::istringstream iss(rowText);
-            std::vector<double> rowWeights;
-            double w;
-            while (iss >> w)
-                rowWeights.push_back(w);
+            const NumberRowResult& row = rows.row();
+            if (row.status != NumberStatus::Ok)
+            {
+                std::ostringstream oss;
+                oss << "Error: Invalid weight value '" << row.badToken << "' in <weights> at row "
+                    << rowIdx << " (YFlash index " << yFlashIndex << ")";
+                throw std::runtime_error(oss.str());
+            }
 
-            layerWeights.push_back(rowWeights);
+            // same checks (and messages) as the YFlash array that is built from the matrix
+            if (rowIdx == 0)
+                colCount = row.count;
+            else if (row.count != colCount)
+            {
+                std::ostringstream oss;
+                oss << "YFlash[" << yFlashIndex << "]: row " << rowIdx << " has " << row.count
+                    << " columns, expected " << colCount << ".";
+                throw std::invalid_argument(oss.str());
+            }
+
+            const auto first = rows.values().begin() + static_cast<std::ptrdiff_t>(rows.rowBegin());
+            values.insert(values.end(), first, first + static_cast<std::ptrdiff_t>(row.count));
+            ++rowCount;
         }
     }
     else
@@ -626,7 +1122,7 @@ void XMLParser::YFlashParser(XMLElement* YFlash, NetworkParameters& params, int
             << "(YFlash index " << yFlashIndex << ")";
         throw std::runtime_error(oss.str());
     }
-    params.YFlashWeights.push_back(layerWeights);
+    params.YFlashWeights.emplace_back(rowCount, colCount, std::move(values));
 }
 
 
@@ -723,29 +1219,47 @@ void XMLParser::ANNParseYFlash(XMLElement* yfElem, NetworkParameters::YFlashBloc
         yb.isSigned = (v == "true" || v == "1" || v == "yes");
     }
 
-    auto parseWeights = [](XMLElement* weightsElem, int& rowIdxOut, int pe_id) -> std::vector<std::vector<double>>
+    // Reads all <row>s straight into one row-major buffer (sized from the rows/cols attributes),
+    // checking values and rectangularity in the same pass.
+    auto parseWeights = [this, &yb, yfElem](XMLElement* weightsElem, const char* name, int pe_id) -> WeightMatrix
         {
-            std::vector<std::vector<double>> W;
-            if (!weightsElem) return W;
+            if (weightsElem->Attribute("file"))
+                return loadWeightFile_(weightsElem, yfElem, "Error: YFlash " + std::string(name) + " in PE Id " + std::to_string(pe_id));
+
+            WeightRowCursor rows(weightsElem, m_preparsed,
+                                 (yb.rows > 0 && yb.cols > 0) ? static_cast<size_t>(yb.rows) * static_cast<size_t>(yb.cols) : 0);
+            size_t cols = 0;
             int rowIdx = 0;
-            for (auto* rowElem = weightsElem->FirstChildElement("row"); rowElem != nullptr; rowElem = rowElem->NextSiblingElement("row"), ++rowIdx)
+            for (; rows.next(); ++rowIdx)
             {
-                std::vector<double> r;
-                const char* txt = rowElem->GetText();
-                if (!txt)
+                if (!rows.hasText())
                 {
                     std::ostringstream oss;
                     oss << "Error: Empty <row> in YFlash weights at row " << rowIdx << "in PE Id " << pe_id;
                     throw std::runtime_error(oss.str());
                 }
-                std::istringstream iss(txt);
-                double x; while (iss >> x) r.push_back(x);
-                W.push_back(std::move(r));
+                const NumberRowResult& row = rows.row();
+                if (row.status != NumberStatus::Ok)
+                {
+                    std::ostringstream oss;
+                    oss << "Error: Invalid YFlash " << name << " value '" << row.badToken << "' at row " << rowIdx << " in PE Id " << pe_id;
+                    throw std::runtime_error(oss.str());
+                }
+                if (rowIdx == 0)
+                {
+                    cols = row.count;
+                }
+                else if (row.count != cols)
+                {
+                    std::ostringstream oss;
+                    oss << "Error: YFlash " << name << " is not rectangular at row " << rowIdx;
+                    throw std::runtime_error(oss.str());
+                }
             }
-            rowIdxOut = rowIdx;
-            return W;
+            return WeightMatrix(static_cast<size_t>(rowIdx), cols, std::move(rows.values()));
         };
 
+    WeightMatrix Wpos, Wneg;
     for (auto* w = yfElem->FirstChildElement("weights"); w != nullptr; w = w->NextSiblingElement("weights"))
     {
         bool isPos = false, isNeg = false;
@@ -761,34 +1275,24 @@ void XMLParser::ANNParseYFlash(XMLElement* yfElem, NetworkParameters::YFlashBloc
             isNeg = (v == "true" || v == "1" || v == "yes");
         }
 
-        int rowIdx = 0;
-        if (isPos || (!yb.isSigned && yb.Wpos.empty()))
+        // parsed once even if the block is both pos and neg (the streamed rows can be taken only once)
+        const bool takePos = isPos || (!yb.isSigned && Wpos.empty());
+        if (takePos || isNeg)
         {
-            yb.Wpos = parseWeights(w, rowIdx, pe_id);
-        }
-        if (isNeg) {
-            yb.Wneg = parseWeights(w, rowIdx, pe_id);
+            const WeightMatrix W = parseWeights(w, takePos ? "Wpos" : "Wneg", pe_id);
+            if (takePos) Wpos = W;
+            if (isNeg) Wneg = W;
         }
     }
 
-    if (!yb.Wpos.empty()) {
-        int cols = static_cast<int>(yb.Wpos.front().size());
-        for (size_t r = 0; r < yb.Wpos.size(); ++r)
-        {
-            if (static_cast<int>(yb.Wpos[r].size()) != cols)
-            {
-                std::ostringstream oss;
-                oss << "Error: YFlash Wpos is not rectangular at row " << r;
-                throw std::runtime_error(oss.str());
-            }
-        }
-    }
-    if (yb.isSigned && !yb.Wneg.empty() && yb.Wneg.size() != yb.Wpos.size())
+    if (yb.isSigned && !Wneg.empty() && Wneg.size() != Wpos.size())
     {
         std::ostringstream oss;
-        oss << "Error: YFlash Wneg rows != Wpos rows (Wneg rows: " << yb.Wneg.size()
-            << ", Wpos rows: " << yb.Wpos.size() << ")";
+        oss << "Error: YFlash Wneg rows != Wpos rows (Wneg rows: " << Wneg.size()
+            << ", Wpos rows: " << Wpos.size() << ")";
         throw std::runtime_error(oss.str());
     }
+    yb.Wpos = Wpos;
+    yb.Wneg = Wneg;
 }
 
@@ -2,8 +2,9 @@
 #include <string>
 #include <vector>
 #include "LIFNetwork.hpp"
+#include "NumberParser.hpp"
 
-namespace tinyxml2 { class XMLElement; }
+namespace tinyxml2 { class XMLElement; class XMLDocument; }
 
 /**
  * @brief XML + CFG parser for NemoSim networks.
@@ -21,10 +22,37 @@ public:
     // Main XML parse entry
     bool parse(const std::string& filename, NetworkParameters& params);
 
+    // Streaming mode: the file is read with a pull parser and <weights> rows are parsed
+    // straight into the final weight storage; only the small remainder becomes a DOM.
+    void setStreaming(bool enabled) { m_streaming = enabled; }
+
     // Parse .cfg or .ini-style key=value file into Config
     Config parseConfigFromFile(const std::string& filePath);
 
 private:
+    // ------- streaming mode -------
+    struct PreparsedRow
+    {
+        bool hasText = false;      // false: empty <row> (or one not starting with text)
+        NumberRowResult numbers;
+    };
+    struct PreparsedWeights
+    {
+        std::vector<double> values;     // all rows, row-major
+        std::vector<PreparsedRow> rows; // up to and including the first invalid row
+        bool failed = false;
+    };
+    class WeightRowCursor;
+
+    bool m_streaming = false;
+    std::vector<PreparsedWeights> m_preparsed; // indexed by the skeleton's preparsed attribute
+    bool loadStreaming_(const std::string& filename, tinyxml2::XMLDocument& doc);
+
+    // ------- <weights file="..."> sidecar files -------
+    std::string m_baseDir;                 // directory of the XML file, for relative paths
+    std::vector<std::string> m_weightFiles; // sidecars loaded by the current parse()
+    WeightMatrix loadWeightFile_(tinyxml2::XMLElement* weightsElem, tinyxml2::XMLElement* shapeElem, const std::string& context);
+
     // ------- existing parsers (kept; implemented here in a minimal, safe way) -------
     void LIFNetworkParser(tinyxml2::XMLElement* LIF, tinyxml2::XMLElement* arch, NetworkParameters& params);
     void BIUNetworkParser(tinyxml2::XMLElement* BIU, tinyxml2::XMLElement* arch, NetworkParameters& params);
@@ -0,0 +1,335 @@
+#include "XmlPullReader.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool isNameChar(char c)
+{
+    const unsigned char u = static_cast<unsigned char>(c);
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == ':' || c == '-' || c == '.' || u >= 0x80;
+}
+
+bool isBlank(const std::string& s)
+{
+    return std::all_of(s.begin(), s.end(), isSpace);
+}
+
+void appendUtf8(std::string& out, unsigned long cp)
+{
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+XmlPullReader::XmlPullReader(std::istream& in, std::size_t bufferSize)
+    : m_in(in), m_buffer(std::max<std::size_t>(bufferSize, 64))
+{
+    // skip a UTF-8 byte order mark
+    if (ensure_(3) && std::memcmp(&m_buffer[m_pos], "\xEF\xBB\xBF", 3) == 0)
+        m_pos += 3;
+}
+
+bool XmlPullReader::next(Event& event)
+{
+    event.attributes.clear();
+    event.text.clear();
+
+    if (m_pendingEnd)
+    {
+        m_pendingEnd = false;
+        event.type = EventType::EndElement;
+        event.name = m_open.back();
+        m_open.pop_back();
+        return true;
+    }
+
+    for (;;)
+    {
+        if (!ensure_(1))
+        {
+            if (!m_open.empty())
+                fail_("unexpected end of file, <" + m_open.back() + "> is not closed");
+            if (!m_seenRoot)
+                fail_("no root element");
+            return false;
+        }
+
+        if (m_buffer[m_pos] != '<')
+        {
+            readText_(event.text);
+            if (isBlank(event.text))
+            {
+                event.text.clear();
+                continue;
+            }
+            if (m_open.empty())
+                fail_("text outside the root element");
+            event.type = EventType::Text;
+            return true;
+        }
+
+        if (startsWith_("<?"))
+        {
+            readUntil_("?>", nullptr);
+            continue;
+        }
+        if (startsWith_("<!--"))
+        {
+            m_pos += 4;
+            readUntil_("-->", &event.text);
+            event.type = EventType::Comment;
+            return true;
+        }
+        if (startsWith_("<![CDATA["))
+        {
+            m_pos += 9;
+            readUntil_("]]>", &event.text);
+            event.type = EventType::Text;
+            return true;
+        }
+        if (startsWith_("<!"))
+        {
+            skipDoctype_();
+            continue;
+        }
+        if (startsWith_("</"))
+        {
+            m_pos += 2;
+            readName_(event.name);
+            skipSpace_();
+            expect_('>');
+            if (m_open.empty() || m_open.back() != event.name)
+                fail_("unexpected closing tag </" + event.name + ">");
+            m_open.pop_back();
+            event.type = EventType::EndElement;
+            return true;
+        }
+
+        // start tag
+        ++m_pos;
+        readName_(event.name);
+        if (m_open.empty() && m_seenRoot)
+            fail_("more than one root element");
+        for (;;)
+        {
+            skipSpace_();
+            const char c = get_();
+            if (c == '>')
+                break;
+            if (c == '/')
+            {
+                expect_('>');
+                m_pendingEnd = true;
+                break;
+            }
+            --m_pos;
+            Attribute attr;
+            readName_(attr.name);
+            skipSpace_();
+            expect_('=');
+            skipSpace_();
+            const char quote = get_();
+            if (quote != '"' && quote != '\'')
+                fail_("attribute '" + attr.name + "' value is not quoted");
+            readAttributeValue_(quote, attr.value);
+            event.attributes.push_back(std::move(attr));
+        }
+        m_open.push_back(event.name);
+        m_seenRoot = true;
+        event.type = EventType::StartElement;
+        return true;
+    }
+}
+
+// ---------------- buffer ----------------
+
+// Makes at least `count` bytes available from m_pos; false if the input ends first.
+bool XmlPullReader::ensure_(std::size_t count)
+{
+    if (m_len - m_pos >= count)
+        return true;
+
+    std::memmove(m_buffer.data(), m_buffer.data() + m_pos, m_len - m_pos);
+    m_len -= m_pos;
+    m_pos = 0;
+    while (m_len < count && m_in)
+    {
+        m_in.read(m_buffer.data() + m_len, static_cast<std::streamsize>(m_buffer.size() - m_len));
+        m_len += static_cast<std::size_t>(m_in.gcount());
+    }
+    return m_len >= count;
+}
+
+bool XmlPullReader::startsWith_(const char* prefix)
+{
+    const std::size_t n = std::strlen(prefix);
+    return ensure_(n) && std::memcmp(&m_buffer[m_pos], prefix, n) == 0;
+}
+
+char XmlPullReader::get_()
+{
+    if (!ensure_(1))
+        fail_("unexpected end of file");
+    const char c = m_buffer[m_pos++];
+    if (c == '\n') ++m_line;
+    return c;
+}
+
+void XmlPullReader::skipSpace_()
+{
+    while (ensure_(1) && isSpace(m_buffer[m_pos]))
+        get_();
+}
+
+void XmlPullReader::expect_(char c)
+{
+    if (get_() != c)
+        fail_(std::string("expected '") + c + "'");
+}
+
+// ---------------- tokens ----------------
+
+void XmlPullReader::readName_(std::string& name)
+{
+    name.clear();
+    while (ensure_(1) && isNameChar(m_buffer[m_pos]))
+        name += m_buffer[m_pos++];
+    if (name.empty())
+        fail_("expected a name");
+}
+
+// Text up to the next '<' (or the end of the file), entities decoded.
+void XmlPullReader::readText_(std::string& text)
+{
+    while (ensure_(1))
+    {
+        const char* begin = m_buffer.data() + m_pos;
+        const char* end = m_buffer.data() + m_len;
+        const char* stop = begin;
+        while (stop != end && *stop != '<' && *stop != '&')
+            ++stop;
+
+        text.append(begin, stop);
+        m_line += static_cast<int>(std::count(begin, stop, '\n'));
+        m_pos += static_cast<std::size_t>(stop - begin);
+
+        if (stop == end)
+            continue;
+        if (*stop == '<')
+            return;
+        decodeEntity_(text);
+    }
+}
+
+void XmlPullReader::readAttributeValue_(char quote, std::string& value)
+{
+    for (;;)
+    {
+        if (!ensure_(1))
+            fail_("unexpected end of file in an attribute value");
+        const char c = m_buffer[m_pos];
+        if (c == quote)
+        {
+            ++m_pos;
+            return;
+        }
+        if (c == '<')
+            fail_("'<' in an attribute value");
+        if (c == '&')
+            decodeEntity_(value);
+        else
+            value += get_();
+    }
+}
+
+// Consumes input up to and including `terminator`, optionally keeping what came before it.
+void XmlPullReader::readUntil_(const char* terminator, std::string* out)
+{
+    const std::size_t n = std::strlen(terminator);
+    while (!startsWith_(terminator))
+    {
+        if (!ensure_(1))
+            fail_(std::string("unexpected end of file, missing '") + terminator + "'");
+        const char c = get_();
+        if (out) *out += c;
+    }
+    m_pos += n;
+}
+
+// <!DOCTYPE ...> including an internal subset in [...]
+void XmlPullReader::skipDoctype_()
+{
+    int brackets = 0;
+    m_pos += 2;
+    for (;;)
+    {
+        const char c = get_();
+        if (c == '[') ++brackets;
+        else if (c == ']') --brackets;
+        else if (c == '>' && brackets <= 0) return;
+    }
+}
+
+// At '&': appends the decoded character; unknown entities are kept as written.
+void XmlPullReader::decodeEntity_(std::string& out)
+{
+    ensure_(12);
+    const char* begin = m_buffer.data() + m_pos;
+    const char* end = m_buffer.data() + std::min(m_len, m_pos + 12);
+    const char* semi = std::find(begin, end, ';');
+    if (semi == end)
+    {
+        out += get_();
+        return;
+    }
+
+    const std::string name(begin + 1, semi);
+    std::string decoded;
+    if (name == "amp") decoded = "&";
+    else if (name == "lt") decoded = "<";
+    else if (name == "gt") decoded = ">";
+    else if (name == "quot") decoded = "\"";
+    else if (name == "apos") decoded = "'";
+    else if (name.size() > 1 && name[0] == '#')
+    {
+        const bool hex = (name[1] == 'x' || name[1] == 'X');
+        const std::string digits = name.substr(hex ? 2 : 1);
+        char* parsedEnd = nullptr;
+        const unsigned long cp = digits.empty() ? 0 : std::strtoul(digits.c_str(), &parsedEnd, hex ? 16 : 10);
+        if (!digits.empty() && parsedEnd && *parsedEnd == '\0' && cp > 0 && cp <= 0x10FFFF)
+            appendUtf8(decoded, cp);
+    }
+
+    if (decoded.empty())
+    {
+        out += get_();
+        return;
+    }
+    out += decoded;
+    m_pos += static_cast<std::size_t>(semi - begin) + 1;
+}
+
+void XmlPullReader::fail_(const std::string& what) const
+{
+    throw std::runtime_error("XML Error: " + what + " at line " + std::to_string(m_line));
+}
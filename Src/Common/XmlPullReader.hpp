@@ -0,0 +1,70 @@
+#pragma once
+/**
+ * @file XmlPullReader.hpp
+ * @brief Minimal streaming (pull) XML reader.
+ *
+ * Reads the document from a std::istream through a fixed-size buffer and hands out one
+ * event at a time, so memory does not grow with the file size. It covers what network
+ * configurations use: elements, attributes, text, CDATA and comments. Declarations,
+ * processing instructions and DOCTYPE are skipped; the predefined entities and numeric
+ * character references are decoded. Like tinyxml2, whitespace-only text is dropped.
+ *
+ * Malformed input throws std::runtime_error naming the line.
+ */
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+class XmlPullReader
+{
+public:
+    enum class EventType { StartElement, EndElement, Text, Comment };
+
+    struct Attribute
+    {
+        std::string name;
+        std::string value;
+    };
+
+    struct Event
+    {
+        EventType type = EventType::Text;
+        std::string name;                   // element name (start / end)
+        std::vector<Attribute> attributes;  // start only
+        std::string text;                   // text / CDATA / comment content, entities decoded
+    };
+
+    explicit XmlPullReader(std::istream& in, std::size_t bufferSize = 1 << 16);
+
+    /// Reads the next event into `event`; returns false once the root element is closed
+    /// and the rest of the file has been consumed. A self-closing element gives a start
+    /// and an end event.
+    bool next(Event& event);
+
+    int line() const { return m_line; }
+
+private:
+    std::istream& m_in;
+    std::vector<char> m_buffer;
+    std::size_t m_pos = 0;
+    std::size_t m_len = 0;
+    int m_line = 1;
+    std::vector<std::string> m_open;   // names of the open elements
+    bool m_seenRoot = false;
+    bool m_pendingEnd = false;         // self-closing element still owes its end event
+
+    bool ensure_(std::size_t count);
+    bool startsWith_(const char* prefix);
+    char get_();
+    void skipSpace_();
+    void expect_(char c);
+    void readName_(std::string& name);
+    void readText_(std::string& text);
+    void readAttributeValue_(char quote, std::string& value);
+    void readUntil_(const char* terminator, std::string* out);
+    void skipDoctype_();
+    void decodeEntity_(std::string& out);
+    [[noreturn]] void fail_(const std::string& what) const;
+};
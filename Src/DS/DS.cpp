@@ -1,11 +1,17 @@
 #include "DS.hpp"
+#include "../Common/Checkpoint.hpp"
+#include <cstdint>
 #include <stdexcept>
 
-// ===== Minimal addition: static M matrix (16 rows x 32 cycles) =====
-static const int ROWS = 16;
-static const int COLS = 32;
+namespace {
 
-static const int M[ROWS][COLS] =
+// Characterized pattern of the 4-bit silicon DS (16 codes x 32 cycles). Its rows are
+// hand-shaped (code 14 even fires on an odd cycle) rather than the evenly spread rule of
+// DSPattern below, so 4 bits keep it verbatim, packed into one word per code at compile time.
+constexpr int ROWS = 16;
+constexpr int COLS = 32;
+
+constexpr int M[ROWS][COLS] =
 {
 	{1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0},
 	{1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,0,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0},
@@ -25,6 +31,53 @@ static const int M[ROWS][COLS] =
 	{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
 };
 
+struct Pattern4
+{
+	std::uint32_t row[ROWS];
+	constexpr Pattern4() : row()
+	{
+		for (int r = 0; r < ROWS; ++r)
+			for (int c = 0; c < COLS; ++c)
+				if (M[r][c] != 0)
+					row[r] |= std::uint32_t(1) << c;
+	}
+};
+constexpr Pattern4 kPattern4{};
+
+// BW-bit pattern: n = 2^BW - code spikes spread evenly over the 2^BW even cycles of the
+// 2^(BW+1)-cycle period; slot k (cycle 2k) fires iff k*n mod 2^BW < n. Closed form, so
+// wide units need no table.
+template <unsigned int BW>
+struct DSPattern
+{
+	static constexpr unsigned int kSlots = 1u << BW;
+	static constexpr unsigned int kCycles = 2u << BW;
+
+	static bool spike(unsigned int code, unsigned int cycle)
+	{
+		cycle &= kCycles - 1;
+		if (cycle & 1u)
+			return false;
+		const std::uint64_t n = kSlots - code;
+		return ((std::uint64_t(cycle >> 1) * n) & (kSlots - 1)) < n;
+	}
+};
+
+template <>
+struct DSPattern<4>
+{
+	static constexpr unsigned int kCycles = COLS;
+
+	static bool spike(unsigned int code, unsigned int cycle)
+	{
+		return ((kPattern4.row[code] >> (cycle & (kCycles - 1))) & 1u) != 0;
+	}
+};
+
+constexpr unsigned int kMaxBitWidth = 16;
+
+} // namespace
+
 // ===== Existing DS implementation (minimal changes applied) =====
 
 DS::DS(double clkFreqMHz, unsigned int bw, Mode m)
@@ -33,17 +86,16 @@ DS::DS(double clkFreqMHz, unsigned int bw, Mode m)
 	m_mode(m)
 {
 	if (m_clockFrequencyMHz <= 0) throw std::invalid_argument("Clock frequency must be positive.");
+	if (m_bitWidth < 1 || m_bitWidth > kMaxBitWidth) throw std::invalid_argument("DS bit width must be between 1 and 16.");
 	m_clockPeriodNs = 1000.0 / m_clockFrequencyMHz;
 	updateThreshold();
 }
 
 void DS::setCode(unsigned int code)
 {
-    // Clamp to [0..ROWS-1] to match M rows
-    if (code >= static_cast<unsigned int>(ROWS))
-        m_digitalCode = ROWS - 1;
-    else
-        m_digitalCode = code;
+    // Clamp to the codes of the bit width
+    const unsigned int maxCode = (1u << m_bitWidth) - 1u;
+    m_digitalCode = code > maxCode ? maxCode : code;
     updateThreshold();
 }
 
@@ -63,20 +115,79 @@ void DS::updateThreshold()
 	}
 	else if (m_mode == FrequencyMode)
 	{
-		unsigned int base = 16;
+		unsigned int base = 1u << m_bitWidth;
 		m_threshold = 1 + (base - m_digitalCode);
 	}
 }
 
 bool DS::tick()
 {
-    // Read spike from M[code][cycle] and advance cycle modulo 32
-    const int val = M[m_digitalCode][m_counter % COLS];
-    const bool spike = (val != 0);
+	double spike;
+	bankKernels(m_bitWidth).tick(this, 1, &spike);
+	return spike != 0.0;
+}
 
-	m_currentTimeNs += m_clockPeriodNs;
-	m_counter++;
-	return spike;
+void DS::advance(unsigned int cycles)
+{
+	for (unsigned int i = 0; i < cycles; ++i)
+	{
+		m_currentTimeNs += m_clockPeriodNs;
+		m_counter++;
+	}
+}
+
+unsigned int DS::activeCycles(unsigned int cycles) const
+{
+	return bankKernels(m_bitWidth).activeCycles(this, 1, cycles);
+}
+
+template <unsigned int BW>
+void DS::tickBank_(DS* units, std::size_t count, double* spikes)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		// Pattern bit of the current cycle (the rule wraps the counter to the period)
+		DS& ds = units[i];
+		spikes[i] = DSPattern<BW>::spike(ds.m_digitalCode, ds.m_counter) ? 1.0 : 0.0;
+		ds.m_currentTimeNs += ds.m_clockPeriodNs;
+		ds.m_counter++;
+	}
+}
+
+template <unsigned int BW>
+unsigned int DS::activeCyclesBank_(const DS* units, std::size_t count, unsigned int cycles)
+{
+	unsigned int active = 0;
+	for (std::size_t u = 0; u < count; ++u)
+	{
+		const DS& ds = units[u];
+		for (unsigned int i = cycles; i > active; --i)
+		{
+			if (DSPattern<BW>::spike(ds.m_digitalCode, ds.m_counter + i - 1))
+			{
+				active = i;
+				break;
+			}
+		}
+	}
+	return active;
+}
+
+const DS::BankKernels& DS::bankKernels(unsigned int bw)
+{
+	static const BankKernels kKernels[kMaxBitWidth] =
+	{
+		{ &tickBank_<1>,  &activeCyclesBank_<1> },  { &tickBank_<2>,  &activeCyclesBank_<2> },
+		{ &tickBank_<3>,  &activeCyclesBank_<3> },  { &tickBank_<4>,  &activeCyclesBank_<4> },
+		{ &tickBank_<5>,  &activeCyclesBank_<5> },  { &tickBank_<6>,  &activeCyclesBank_<6> },
+		{ &tickBank_<7>,  &activeCyclesBank_<7> },  { &tickBank_<8>,  &activeCyclesBank_<8> },
+		{ &tickBank_<9>,  &activeCyclesBank_<9> },  { &tickBank_<10>, &activeCyclesBank_<10> },
+		{ &tickBank_<11>, &activeCyclesBank_<11> }, { &tickBank_<12>, &activeCyclesBank_<12> },
+		{ &tickBank_<13>, &activeCyclesBank_<13> }, { &tickBank_<14>, &activeCyclesBank_<14> },
+		{ &tickBank_<15>, &activeCyclesBank_<15> }, { &tickBank_<16>, &activeCyclesBank_<16> }
+	};
+	if (bw < 1 || bw > kMaxBitWidth) throw std::invalid_argument("DS bit width must be between 1 and 16.");
+	return kKernels[bw - 1];
 }
 
 bool DS::isSpikeActive() const
@@ -99,3 +210,21 @@ void DS::setMode(Mode m)
 	m_mode = m;
 	updateThreshold();
 }
+
+void DS::saveState(SnapshotWriter& out) const
+{
+	out.put(m_digitalCode);
+	out.put(m_counter);
+	out.put(m_threshold);
+	out.put(m_lastSpikeTimeNs);
+	out.put(m_currentTimeNs);
+}
+
+void DS::loadState(SnapshotReader& in)
+{
+	in.get(m_digitalCode);
+	in.get(m_counter);
+	in.get(m_threshold);
+	in.get(m_lastSpikeTimeNs);
+	in.get(m_currentTimeNs);
+}
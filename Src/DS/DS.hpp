@@ -1,4 +1,8 @@
 #pragma once
+#include <cstddef>
+
+class SnapshotWriter;
+class SnapshotReader;
 
 class DS
 {
@@ -11,15 +15,36 @@ public:
 public:
 	DS(double clkFreqMHz, unsigned int bw, Mode m = ThresholdMode);
 
-	void setCode(unsigned int code);
+	// Spike pattern period of a bw-bit unit: code c fires 2^bw - c times in 2^(bw+1)
+	// cycles (spikes are two cycles wide, so at most every other cycle).
+	static unsigned int patternCycles(unsigned int bw) { return 2u << bw; }
+	unsigned int getPatternCycles() const { return patternCycles(m_bitWidth); }
+
+	void setCode(unsigned int code);                  // clamped to 2^bw - 1
 	void reset();
 	bool tick();
+	void advance(unsigned int cycles);               // tick `cycles` times, discarding the output
+	unsigned int activeCycles(unsigned int cycles) const; // 1 + offset of the last spike among the next `cycles` ticks (0 if none)
 	bool isSpikeActive() const;
 
+	// The same on a bank of units of one bit width (a BIU front-end), specialized per width:
+	// select them once with bankKernels(bw), so the loop over the units runs on the inlined
+	// pattern rule of that width instead of one indirect call per unit and cycle.
+	struct BankKernels
+	{
+		void (*tick)(DS* units, std::size_t count, double* spikes);                     // 1.0 / 0.0 per unit
+		unsigned int (*activeCycles)(const DS* units, std::size_t count, unsigned int cycles); // max over the units
+	};
+	static const BankKernels& bankKernels(unsigned int bw);
+
 	double getSpikePeriodNs() const;
 	double getSpikeRateMHz() const;
 	void setMode(Mode m);
 
+	// Checkpoint / resume (see Common/Checkpoint.hpp)
+	void saveState(SnapshotWriter& out) const;
+	void loadState(SnapshotReader& in);
+
 	
 private:
 	double m_clockFrequencyMHz;
@@ -38,4 +63,10 @@ private:
 	Mode m_mode;
 
 	void updateThreshold();
+
+	// Bank kernels of a bit width (DS.cpp)
+	template <unsigned int BW>
+	static void tickBank_(DS* units, std::size_t count, double* spikes);
+	template <unsigned int BW>
+	static unsigned int activeCyclesBank_(const DS* units, std::size_t count, unsigned int cycles);
 };
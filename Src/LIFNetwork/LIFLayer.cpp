@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include <sstream> // Add this for stringstream
 #include "LIFLayer.hpp"
+#include "../Common/Checkpoint.hpp"
 
 //implementation of LIFLayer class
 
@@ -31,9 +32,31 @@ void LIFLayer::initializeWeights(YFlash* yflash)
     m_yflash = yflash;
 }
 
+void LIFLayer::setPrecision(Precision precision)
+{
+    if (precision == m_precision)
+        return;
+    if (precision == Precision::Fixed)
+        throw std::invalid_argument("LIFLayer: fixed precision is only supported by BIU layers.");
+
+    if (precision == Precision::Float)
+    {
+        m_neuronsFloat.clear();
+        for (const auto& neuron : m_neurons) m_neuronsFloat.emplace_back(neuron);
+        m_neurons.clear();
+    }
+    else
+    {
+        m_neurons.clear();
+        for (const auto& neuron : m_neuronsFloat) m_neurons.emplace_back(neuron);
+        m_neuronsFloat.clear();
+    }
+    m_precision = precision;
+}
+
 unsigned int LIFLayer::getLayerSize() const
 {
-    return m_neurons.size();
+    return static_cast<unsigned int>(m_precision == Precision::Float ? m_neuronsFloat.size() : m_neurons.size());
 }
 
 void LIFLayer::updateLayer(std::vector<double>& input)
@@ -41,37 +64,65 @@ void LIFLayer::updateLayer(std::vector<double>& input)
     if (m_yflash)
     {
         input = m_yflash->step(input);
-        if (input.size() != m_neurons.size()) {
+        if (input.size() != getLayerSize()) {
             std::ostringstream oss;
             oss << "LIFLayer::updateLayer: YFlash output size (" << input.size()
-                << ") does not match number of neurons (" << m_neurons.size() << ").";
+                << ") does not match number of neurons (" << getLayerSize() << ").";
             throw std::runtime_error(oss.str());
         }
     }
-    for (size_t i = 0; i < input.size(); ++i)
-    {
-        m_neurons[i].update(input[i]);
-    }
+    visit_([&](auto& neurons) {
+        parallelFor(m_scheduler, input.size(), m_updateGrain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                neurons[i].update(input[i]);
+            }
+        });
+    });
 }
 
 void LIFLayer::step(std::vector<double>& nextInputs)
 {
-    if (nextInputs.size() != m_neurons.size()) {
+    if (nextInputs.size() != getLayerSize()) {
         std::ostringstream oss;
         oss << "LIFLayer::step: nextInputs size (" << nextInputs.size()
-            << ") does not match number of neurons (" << m_neurons.size() << ").";
+            << ") does not match number of neurons (" << getLayerSize() << ").";
         throw std::invalid_argument(oss.str());
     }
-    for (size_t i = 0; i < m_neurons.size(); ++i)
-    {
-        if (m_neurons[i].hasSpiked())
+    visit_([&](const auto& neurons) {
+        for (size_t i = 0; i < neurons.size(); ++i)
         {
-            nextInputs[i] = m_neurons[i].getVDD();
+            if (neurons[i].hasSpiked())
+            {
+                nextInputs[i] = neurons[i].getVDD();
+            }
+            else
+            {
+                nextInputs[i] = 0;
+            }
         }
-        else
-        {
-            nextInputs[i] = 0;
-        }
-    }
+    });
+}
+
+void LIFLayer::saveState(SnapshotWriter& out) const
+{
+    out.put<std::uint64_t>(getLayerSize());
+    visit_([&](const auto& neurons) {
+        for (const auto& neuron : neurons) neuron.saveState(out);
+    });
 }
 
+void LIFLayer::loadState(SnapshotReader& in)
+{
+    in.expectCount(getLayerSize(), "neurons per layer");
+    visit_([&](auto& neurons) {
+        for (auto& neuron : neurons) neuron.loadState(in);
+    });
+}
+
+void LIFLayer::resetState()
+{
+    visit_([&](auto& neurons) {
+        for (auto& neuron : neurons) neuron.resetState();
+    });
+}
@@ -6,23 +6,50 @@
 #include <string>
 #include "LIFNeuron.hpp"
 #include "YFlash.hpp"
+#include "../Common/Precision.hpp"
 // --------- LIF Layer Definition ---------
 class LIFLayer 
 {
+	// Calls f with the neuron vector of the current precision (defined ahead of the
+	// inline accessors below, which deduce their result from it).
+	template <typename F>
+	decltype(auto) visit_(F&& f)
+	{
+		return m_precision == Precision::Float ? f(m_neuronsFloat) : f(m_neurons);
+	}
+	template <typename F>
+	decltype(auto) visit_(F&& f) const
+	{
+		return m_precision == Precision::Float ? f(m_neuronsFloat) : f(m_neurons);
+	}
+
 public:
 	LIFLayer(int numNeurons, double Cm, double Cf, double Vth, double VDD, double dt, double IR);
 	void initializeWeights(YFlash* yflash);
+	// Numeric type of the neurons (see Precision.hpp); converts them, state included.
+	void setPrecision(Precision precision);
+	// Neuron updates in ranges on `scheduler` (null = single-threaded); see TaskScheduler.
+	void setScheduler(TaskScheduler* scheduler) { m_scheduler = scheduler; }
 	unsigned int getLayerSize() const;
 	void updateLayer(std::vector<double>& input);
 	void step(std::vector<double>& nextInputs);
-	double getVm(int index) const { return m_neurons[index].getVm(); }
-	std::vector<double> getVms(int index) const { return m_neurons[index].getVms(); }
-	std::vector<double> getIinVec(int index) const { return m_neurons[index].getIinVec(); }
-	std::vector<double> getVoutVec(int index) const { return m_neurons[index].getVoutVec(); }
-	bool hasSpiked(int index) const { return m_neurons[index].hasSpiked(); }
+	double getVm(int index) const { return visit_([&](const auto& neurons) { return neurons[index].getVm(); }); }
+	std::vector<double> getVms(int index) const { return visit_([&](const auto& neurons) { return neurons[index].getVms(); }); }
+	std::vector<double> getIinVec(int index) const { return visit_([&](const auto& neurons) { return neurons[index].getIinVec(); }); }
+	std::vector<double> getVoutVec(int index) const { return visit_([&](const auto& neurons) { return neurons[index].getVoutVec(); }); }
+	void takeTraces(int index, std::vector<double>& vms, std::vector<double>& iins, std::vector<double>& vouts) { visit_([&](auto& neurons) { neurons[index].takeTraces(vms, iins, vouts); }); }
+	bool hasSpiked(int index) const { return visit_([&](const auto& neurons) { return neurons[index].hasSpiked(); }); }
 	YFlash* getYFlash() const { return m_yflash; }
+	void saveState(SnapshotWriter& out) const;
+	void loadState(SnapshotReader& in);
+	// Every neuron back to its initial state (see BasicLIFNeuron::resetState).
+	void resetState();
 private:
-	std::vector<LIFNeuron> m_neurons;
+	Precision m_precision = Precision::Double;
+	std::vector<LIFNeuron> m_neurons;                   // Precision::Double
+	std::vector<BasicLIFNeuron<float>> m_neuronsFloat;  // Precision::Float
 	std::vector<std::vector<double>> m_weights;
 	YFlash* m_yflash = nullptr;
+	TaskScheduler* m_scheduler = nullptr;
+	ParallelGrain m_updateGrain;
 };
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream> // Add this for stringstream
 #include "LIFNetwork.hpp"
+#include "../Common/Profiler.hpp"
 
 //implementation of LIFNetwork class
 
@@ -16,14 +17,25 @@ LIFNetwork::LIFNetwork(NetworkParameters params)
 		throw std::invalid_argument("LIFNetwork: layerSizes must not be empty.");
 	}
 
+	m_resetEveryLines = static_cast<std::size_t>(params.resetEveryLines);
+	if (params.computeThreads != 1)
+		m_scheduler = std::make_shared<TaskScheduler>(static_cast<unsigned>(params.computeThreads));
+
 	for (size_t i = 0; (i < params.YFlashWeights.size()); ++i)
 	{
 		m_yflashVec.emplace_back(params.YFlashWeights[i], i);
+		if (params.variation.enabled())
+			m_yflashVec.back().applyVariation(params.variation);
+		m_yflashVec.back().setPrecision(params.precision);
+		m_yflashVec.back().setScheduler(m_scheduler.get());
 	}
 	for (int size : params.layerSizes)
 	{
 		m_layers.emplace_back(size, params.Cm, params.Cf, params.VTh, m_VDD, m_dt, params.IR);
+		m_layers.back().setPrecision(params.precision);
+		m_layers.back().setScheduler(m_scheduler.get());
 	}
+	m_layerSpikes.assign(m_layers.size(), 0.0);
 	for (size_t i = 0; (i < m_layers.size() - 1) && m_yflashVec.size() != 0; ++i)
 	{
 		m_layers[i + 1].initializeWeights(&m_yflashVec[i]);
@@ -39,11 +51,14 @@ void LIFNetwork::feedForward(std::vector<double>& input)
 		return;
 	}
 
+	const bool profiling = !m_layerNs.empty();
 	for (size_t l = m_layers.size() - 1; l >= 0; --l)
 	{
+		const std::uint64_t start = profiling ? Profiler::now() : 0;
 		if (l == 0)
 		{
 			m_layers[0].updateLayer(input);
+			if (profiling) m_layerNs[0] += Profiler::now() - start;
 			break;
 		}
 
@@ -51,7 +66,29 @@ void LIFNetwork::feedForward(std::vector<double>& input)
 		m_layers[l - 1].step(nextInputs);
 
 		m_layers[l].updateLayer(nextInputs);
+		if (profiling) m_layerNs[l] += Profiler::now() - start;
 	}
+
+	for (size_t l = 0; l < m_layers.size(); ++l)
+	{
+		for (unsigned int i = 0; i < m_layers[l].getLayerSize(); ++i)
+		{
+			if (!m_layers[l].hasSpiked(i)) continue;
+			m_layerSpikes[l] += 1.0;
+			if (m_spikeStats) m_spikeStats->recordSpike(l, i);
+			if (m_readout && l + 1 == m_layers.size()) m_readout->recordSpike(i);
+		}
+	}
+	if (m_spikeStats) m_spikeStats->endCycle(); // one cycle per input line
+	if (m_readout) m_readout->endCycle();
+}
+
+void LIFNetwork::collectTotals(std::map<std::string, double>& totals)
+{
+	for (size_t l = 0; l < m_layerSpikes.size(); ++l)
+		totals["spikes_L" + std::to_string(l)] = m_layerSpikes[l];
+	if (m_readout && m_readout->hasLabels())
+		totals["readout_accuracy"] = m_readout->accuracy();
 }
 void LIFNetwork::printNetworkState(int timestep) const
 {
@@ -73,6 +110,9 @@ void LIFNetwork::printNetworkState(int timestep) const
 void LIFNetwork::printNetworkToFile()
 {
 	std::cout << "printing network files " << std::endl;
+	if (streamsTraces_())
+		return; // traces were streamed to their files during run()
+
 	for (int layerIdx = 0; layerIdx < m_layers.size(); ++layerIdx) {
 		int numNeurons = m_layers[layerIdx].getLayerSize();
 
@@ -114,31 +154,119 @@ void LIFNetwork::printNetworkToFile()
 
 }
  
-void LIFNetwork::run(std::ifstream& inputFile)
+void LIFNetwork::run(std::istream& inputFile)
 {
-	std::string line;
-
-	if (!inputFile.is_open()) {
-		std::cerr << "Unable to open file\n";
+	if (!inputFile) {
+		std::cerr << "Unable to read input\n";
 		return;
 	}
 
-	// use base helper (or keep your original counting code)
-	const std::size_t totalLines = countLines(inputFile);
+	std::vector<std::size_t> layerSizes;
+	for (const auto& layer : m_layers) layerSizes.push_back(layer.getLayerSize());
+	startSpikeStats_(layerSizes, m_dt);
 
-	std::size_t currentLine = 0;
-	while (std::getline(inputFile, line)) {
-		++currentLine;
+	if (streamsTraces_())
+		openTraceFiles_();
+	startReadout_(layerSizes.empty() ? 0 : layerSizes.back());
+	const std::size_t resumedLines = resumeFromCheckpoint_(inputFile);
+	m_traceWriter.start(m_pipeline);
 
-		std::vector<double> values;
+	auto parseLine = [](const std::string& line, std::size_t, std::vector<double>& values) {
 		std::stringstream ss(line);
 		double value;
 		while (ss >> value) values.push_back(value);
+	};
+
+	ProgressReporter progress(m_progress, inputFile);
+	LineReader reader(inputFile, parseLine, m_pipeline, resumedLines, inputOffsetEvery_());
+	InputLine input;
+	std::uint64_t linesRun = 0;
+	if (Profiler::enabled())
+		m_layerNs.assign(m_layers.size(), 0);
 
-		feedForward(values);
-		showProgressBar(currentLine, totalLines);  // now from BaseNetwork
+	while (reader.next(input)) {
+		++linesRun;
+		if (resetDue_(input))
+			for (auto& layer : m_layers) layer.resetState();
+		feedForward(input.values);
+		if (m_spikeStats) m_spikeStats->endLine();
+		if (m_readout)
+		{
+			TraceWriter::Batch row;
+			m_readout->endLine(input.number, row);
+			m_traceWriter.submit(std::move(row));
+		}
+		if (streamsTraces_()) streamTraces_();
+		checkpointIfDue_(input);
+		progress.lineDone(input);
 	}
+	progress.finish();
 
 	std::cout << "\nFinished executing.\n";
-	inputFile.close();
+	m_traceWriter.close();
+	finishSpikeStats_();
+	finishReadout_();
+
+	if (Profiler::enabled())
+	{
+		// one cycle per line; a spike of layer l reaches every neuron of layer l+1
+		std::uint64_t layerTotal = 0;
+		double spikes = 0.0, synapticEvents = 0.0;
+		for (size_t l = 0; l < m_layers.size(); ++l)
+		{
+			layerTotal += m_layerNs[l];
+			spikes += m_layerSpikes[l];
+			if (l + 1 < m_layers.size())
+				synapticEvents += m_layerSpikes[l] * m_layers[l + 1].getLayerSize();
+		}
+		Profiler::addLayerTimes(m_layerNs);
+		Profiler::addTime(Profiler::LayerUpdate, layerTotal);
+		Profiler::addCount(Profiler::InputLines, linesRun);
+		Profiler::addCount(Profiler::Cycles, linesRun);
+		Profiler::addCount(Profiler::Spikes, static_cast<std::uint64_t>(spikes));
+		Profiler::addCount(Profiler::SynapticEvents, static_cast<std::uint64_t>(synapticEvents));
+	}
+}
+
+void LIFNetwork::openTraceFiles_()
+{
+	m_traceIds.assign(m_layers.size(), std::vector<int>());
+	for (size_t layerIdx = 0; layerIdx < m_layers.size(); ++layerIdx) {
+		for (unsigned int neuronIdx = 0; neuronIdx < m_layers[layerIdx].getLayerSize(); ++neuronIdx) {
+			const std::string suffix = std::to_string(layerIdx) + "_" + std::to_string(neuronIdx) + ".txt";
+			m_traceIds[layerIdx].push_back(m_traceWriter.open("vms_" + suffix));
+			m_traceIds[layerIdx].push_back(m_traceWriter.open("iins_" + suffix));
+			m_traceIds[layerIdx].push_back(m_traceWriter.open("vouts_" + suffix));
+		}
+	}
+}
+
+void LIFNetwork::streamTraces_()
+{
+	TraceWriter::Batch batch;
+	for (size_t layerIdx = 0; layerIdx < m_layers.size(); ++layerIdx) {
+		for (unsigned int neuronIdx = 0; neuronIdx < m_layers[layerIdx].getLayerSize(); ++neuronIdx) {
+			TraceWriter::Chunk vms, iins, vouts;
+			m_layers[layerIdx].takeTraces(neuronIdx, vms.values, iins.values, vouts.values);
+			vms.fileId   = m_traceIds[layerIdx][3 * neuronIdx];
+			iins.fileId  = m_traceIds[layerIdx][3 * neuronIdx + 1];
+			vouts.fileId = m_traceIds[layerIdx][3 * neuronIdx + 2];
+			batch.push_back(std::move(vms));
+			batch.push_back(std::move(iins));
+			batch.push_back(std::move(vouts));
+		}
+	}
+	m_traceWriter.submit(std::move(batch));
+}
+
+void LIFNetwork::saveState(SnapshotWriter& out) const
+{
+	out.put<std::uint64_t>(m_layers.size());
+	for (const auto& layer : m_layers) layer.saveState(out);
+}
+
+void LIFNetwork::loadState(SnapshotReader& in)
+{
+	in.expectCount(m_layers.size(), "layers");
+	for (auto& layer : m_layers) layer.loadState(in);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <random>
 #include <sstream>
@@ -14,13 +16,23 @@ class LIFNetwork : public BaseNetwork
 {
 public:
    LIFNetwork(NetworkParameters params);
-   void run(std::ifstream& inputFile) override;
+   void run(std::istream& inputFile) override;
    void feedForward(std::vector<double>& input);
    void printNetworkState(int timestep) const;
    void printNetworkToFile();
+   void collectTotals(std::map<std::string, double>& totals) override; // "spikes_L<l>" per layer
 private:
 	std::vector<LIFLayer> m_layers;
 	double m_VDD, m_dt;
 	std::vector<double> vms;
 	std::vector<YFlash> m_yflashVec;
+	std::vector<double> m_layerSpikes; // output spikes per layer in this run (not checkpointed)
+	std::vector<std::uint64_t> m_layerNs; // update time per layer, only when profiling
+	std::shared_ptr<TaskScheduler> m_scheduler; // compute_threads != 1; shared by layers and arrays
+	// streamed mode: vms/iins/vouts file ids per neuron, streamed line by line
+	std::vector<std::vector<int>> m_traceIds;
+	void openTraceFiles_();
+	void streamTraces_();
+	void saveState(SnapshotWriter& out) const override;
+	void loadState(SnapshotReader& in) override;
 };
\ No newline at end of file
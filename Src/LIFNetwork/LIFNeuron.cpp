@@ -3,30 +3,35 @@
 #include <random>
 #include <string>
 #include "LIFNeuron.hpp"
-LIFNeuron::LIFNeuron(double Cm_, double Cf_, double Vth_, double VDD_, double dt_, double IR_)
-    : m_Cm(Cm_), m_Cf(Cf_), m_Vth(Vth_), m_VDD(VDD_), m_dt(dt_)
+#include "../Common/Checkpoint.hpp"
+template <typename Real>
+BasicLIFNeuron<Real>::BasicLIFNeuron(double Cm_, double Cf_, double Vth_, double VDD_, double dt_, double IR_)
+    : m_Cm(static_cast<Real>(Cm_)), m_Cf(static_cast<Real>(Cf_)), m_Vth(static_cast<Real>(Vth_)),
+    m_VDD(static_cast<Real>(VDD_)), m_dt(static_cast<Real>(dt_))
 {
-    m_Vm = 0.0;
-    m_beta = m_Cm / (m_Cm + m_Cf);
+    m_Vm = Real(0);
+    m_beta = static_cast<Real>(Cm_ / (Cm_ + Cf_));
     m_spiked = false;
-    m_IR = 8 * IR_;
-    m_lastVout = 0.0;
+    m_IR = static_cast<Real>(8 * IR_);
+    m_lastVout = Real(0);
 }
-void LIFNeuron::update(double Iin)
+template <typename Real>
+void BasicLIFNeuron<Real>::update(double Iin_)
 {
+    const Real Iin = static_cast<Real>(Iin_);
     // Determine f(Vth) based on current Vm
-    double f_Vth = (m_Vm > m_Vth) ? 1.0 : 0.0;
+    Real f_Vth = (m_Vm > m_Vth) ? Real(1) : Real(0);
     // Calculate output voltage
-    double Vout = m_VDD * f_Vth;
+    Real Vout = m_VDD * f_Vth;
     // Calculate V_f
-    double Vf = Vout - m_Vm;
+    Real Vf = Vout - m_Vm;
     // Approximate dVf/dt
-    double dVf_dt = (Vout - m_lastVout) / m_dt;
+    Real dVf_dt = (Vout - m_lastVout) / m_dt;
     m_lastVout = Vout; // Update last output
     // Update Vm'
-    double Vm_prime = m_Vm + (m_dt / m_Cm) * (Iin - m_IR * f_Vth + m_Cf * dVf_dt);
+    Real Vm_prime = m_Vm + (m_dt / m_Cm) * (Iin - m_IR * f_Vth + m_Cf * dVf_dt);
     // Save previous Vm to check for threshold crossings
-    double Vm_prior = m_Vm;
+    Real Vm_prior = m_Vm;
     // Spike/reset logic according to threshold crossing
     if ((Vm_prime > m_Vth) && (Vm_prior <= m_Vth))
     {
@@ -48,6 +53,40 @@ void LIFNeuron::update(double Iin)
     }
     // Store data for logging
     m_vms.emplace_back(m_Vm);
-    m_Iin.emplace_back(Iin);
+    m_Iin.emplace_back(Iin_);
     m_vout.emplace_back(Vout);
 }
+
+// State is stored as double whatever Real is, so snapshots do not depend on the precision.
+template <typename Real>
+void BasicLIFNeuron<Real>::saveState(SnapshotWriter& out) const
+{
+    out.put(static_cast<double>(m_Vm));
+    out.put(m_spiked);
+    out.put(static_cast<double>(m_lastVout));
+    out.putVector(m_vms);
+    out.putVector(m_Iin);
+    out.putVector(m_vout);
+}
+
+template <typename Real>
+void BasicLIFNeuron<Real>::loadState(SnapshotReader& in)
+{
+    m_Vm = static_cast<Real>(in.get<double>());
+    in.get(m_spiked);
+    m_lastVout = static_cast<Real>(in.get<double>());
+    in.getVector(m_vms);
+    in.getVector(m_Iin);
+    in.getVector(m_vout);
+}
+
+template <typename Real>
+void BasicLIFNeuron<Real>::resetState()
+{
+    m_Vm = Real(0);
+    m_lastVout = Real(0);
+    m_spiked = false;
+}
+
+template class BasicLIFNeuron<double>;
+template class BasicLIFNeuron<float>;
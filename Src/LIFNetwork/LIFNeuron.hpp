@@ -4,11 +4,19 @@
 #include <vector>
 #include <random>
 #include <string>
+
+class SnapshotWriter;
+class SnapshotReader;
 // --------- LIF Neuron Definition ---------
-class LIFNeuron 
+// Real: type of the membrane state and constants (see Precision.hpp); traces stay double.
+template <typename Real>
+class BasicLIFNeuron
 {
 public:
-   LIFNeuron(double Cm_, double Cf_, double Vth_, double VDD_, double dt_, double IR_);
+   BasicLIFNeuron(double Cm_, double Cf_, double Vth_, double VDD_, double dt_, double IR_);
+   // Same neuron (constants, state, traces) in another precision.
+   template <typename Other>
+   explicit BasicLIFNeuron(const BasicLIFNeuron<Other>& other);
    void update(double Iin);
    double getVm() const { return m_Vm; }
    bool hasSpiked() const { return m_spiked; }
@@ -16,10 +24,42 @@ public:
    std::vector<double> getVms() const { return m_vms; }
    std::vector<double> getIinVec() const { return m_Iin; }
    std::vector<double> getVoutVec() const { return m_vout; }
+   // Hands the recorded traces to the caller and starts empty ones (streamed output).
+   void takeTraces(std::vector<double>& vms, std::vector<double>& iins, std::vector<double>& vouts)
+   {
+      vms.swap(m_vms);    m_vms.clear();
+      iins.swap(m_Iin);   m_Iin.clear();
+      vouts.swap(m_vout); m_vout.clear();
+   }
+   // Checkpoint / resume
+   void saveState(SnapshotWriter& out) const;
+   void loadState(SnapshotReader& in);
+   // Back to the state of a new neuron (Vm, last output); traces are kept.
+   void resetState();
 private:
-	double m_Cm, m_Cf, m_Vth, m_VDD, m_Vm, m_beta, m_dt, m_IR, m_lastVout;
+	template <typename> friend class BasicLIFNeuron;
+
+	Real m_Cm, m_Cf, m_Vth, m_VDD, m_Vm, m_beta, m_dt, m_IR, m_lastVout;
 	bool m_spiked;
 	std::vector<double> m_vms;
 	std::vector<double> m_Iin;
 	std::vector<double> m_vout;
 };
+
+using LIFNeuron = BasicLIFNeuron<double>;
+
+// Both instantiations are compiled in LIFNeuron.cpp.
+extern template class BasicLIFNeuron<double>;
+extern template class BasicLIFNeuron<float>;
+
+template <typename Real>
+template <typename Other>
+BasicLIFNeuron<Real>::BasicLIFNeuron(const BasicLIFNeuron<Other>& other)
+	: m_Cm(static_cast<Real>(other.m_Cm)), m_Cf(static_cast<Real>(other.m_Cf)),
+	m_Vth(static_cast<Real>(other.m_Vth)), m_VDD(static_cast<Real>(other.m_VDD)),
+	m_Vm(static_cast<Real>(other.m_Vm)), m_beta(static_cast<Real>(other.m_beta)),
+	m_dt(static_cast<Real>(other.m_dt)), m_IR(static_cast<Real>(other.m_IR)),
+	m_lastVout(static_cast<Real>(other.m_lastVout)), m_spiked(other.m_spiked),
+	m_vms(other.m_vms), m_Iin(other.m_Iin), m_vout(other.m_vout)
+{
+}
@@ -0,0 +1,290 @@
+#include "MonteCarlo.hpp"
+#include "Session.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+static double parseSpecNumber(const std::string& key, const std::string& value)
+{
+	size_t used = 0;
+	double v = 0.0;
+	try
+	{
+		v = std::stod(value, &used);
+	}
+	catch (const std::exception&)
+	{
+		used = 0;
+	}
+	if (used == 0 || used != value.size() || !std::isfinite(v))
+		throw std::runtime_error("Monte Carlo Error: invalid value '" + value + "' for " + key);
+	return v;
+}
+
+static double parseSigma(const std::string& key, const std::string& value)
+{
+	double sigma = parseSpecNumber(key, value);
+	if (sigma < 0.0)
+		throw std::runtime_error("Monte Carlo Error: " + key + " cannot be negative");
+	return sigma;
+}
+
+MonteCarloSpec parseMonteCarloSpec(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+		throw std::runtime_error("Monte Carlo Error: unable to open spec: " + path);
+
+	MonteCarloSpec spec;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t colon = line.find(':');
+		if (colon == std::string::npos) continue;
+
+		// key: the quoted name before the colon
+		size_t keyEnd = line.rfind('"', colon);
+		size_t keyBegin = (keyEnd == std::string::npos || keyEnd == 0) ? std::string::npos : line.rfind('"', keyEnd - 1);
+		if (keyBegin == std::string::npos)
+			continue;
+		std::string key = line.substr(keyBegin + 1, keyEnd - keyBegin - 1);
+
+		// value: a quoted string, or up to the next separator
+		std::string value;
+		size_t start = line.find_first_not_of(" \t", colon + 1);
+		if (start != std::string::npos && line[start] == '"')
+			value = line.substr(start + 1, line.find('"', start + 1) - start - 1);
+		else if (start != std::string::npos)
+			value = line.substr(start, line.find_first_of(", \t\r\n}", start) - start);
+
+		if (key == "trials")
+		{
+			double trials = parseSpecNumber(key, value);
+			if (trials < 1 || trials != std::floor(trials))
+				throw std::runtime_error("Monte Carlo Error: trials must be a positive integer");
+			spec.trials = static_cast<std::size_t>(trials);
+		}
+		else if (key == "seed")
+		{
+			try
+			{
+				spec.seed = std::stoull(value);
+			}
+			catch (const std::exception&)
+			{
+				throw std::runtime_error("Monte Carlo Error: invalid value '" + value + "' for seed");
+			}
+		}
+		else if (key == "threads")
+		{
+			double threads = parseSpecNumber(key, value);
+			if (threads < 0)
+				throw std::runtime_error("Monte Carlo Error: threads cannot be negative");
+			spec.threads = static_cast<unsigned>(threads);
+		}
+		else if (key == "distribution")
+		{
+			std::string lower = value;
+			std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+			if (lower == "gaussian" || lower == "normal")
+				spec.variation.distribution = DeviceVariation::Distribution::Gaussian;
+			else if (lower == "lognormal")
+				spec.variation.distribution = DeviceVariation::Distribution::LogNormal;
+			else
+				throw std::runtime_error("Monte Carlo Error: unknown distribution '" + value + "' (expected gaussian or lognormal)");
+		}
+		else if (key == "VTh_sigma")    spec.variation.sigmaVTh = parseSigma(key, value);
+		else if (key == "RLeak_sigma")  spec.variation.sigmaRLeak = parseSigma(key, value);
+		else if (key == "Cu_sigma")     spec.variation.sigmaCu = parseSigma(key, value);
+		else if (key == "Cn_sigma")     spec.variation.sigmaCn = parseSigma(key, value);
+		else if (key == "YFlash_sigma") spec.variation.sigmaYFlash = parseSigma(key, value);
+		else if (key == "summary_file") spec.summaryFile = value;
+		else if (key == "trials_file")  spec.trialsFile = value;
+		else
+			throw std::runtime_error("Monte Carlo Error: unknown key '" + key + "' in " + path);
+	}
+
+	if (spec.trials == 0)
+		throw std::runtime_error("Monte Carlo Error: " + path + " does not set 'trials'");
+	if (spec.summaryFile.empty())
+		throw std::runtime_error("Monte Carlo Error: summary_file is empty");
+	return spec;
+}
+
+std::uint64_t trialSeed(std::uint64_t seed, std::size_t trial)
+{
+	return DeviceVariation::mix(seed ^ DeviceVariation::mix(static_cast<std::uint64_t>(trial)));
+}
+
+// The varied quantities must exist in the network type.
+static void checkSpecFits(const NetworkParameters& nominal, const MonteCarloSpec& spec)
+{
+	const DeviceVariation& v = spec.variation;
+	if (nominal.networkType == NetworkTypes::BIUNetworkType)
+	{
+		if (v.sigmaYFlash > 0.0)
+			throw std::runtime_error("Monte Carlo Error: YFlash_sigma applies to LIF networks (BIU synapses are not Y-Flash arrays)");
+	}
+	else if (nominal.networkType == NetworkTypes::LIFNetworkType)
+	{
+		if (v.sigmaVTh > 0.0 || v.sigmaRLeak > 0.0 || v.sigmaCu > 0.0 || v.sigmaCn > 0.0)
+			throw std::runtime_error("Monte Carlo Error: VTh/RLeak/Cu/Cn sigmas apply to BIU networks; LIF networks vary YFlash_sigma");
+		if (nominal.YFlashWeights.empty() && v.sigmaYFlash > 0.0)
+			throw std::runtime_error("Monte Carlo Error: the network has no Y-Flash arrays to vary");
+	}
+	else
+	{
+		throw std::runtime_error("Monte Carlo Error: Monte Carlo trials are supported for BIU and LIF networks");
+	}
+}
+
+MonteCarloResult runMonteCarlo(const NetworkParameters& nominal, const MonteCarloSpec& spec, const std::string& inputPath)
+{
+	checkSpecFits(nominal, spec);
+
+	// every trial reads the same input; load it once
+	std::ifstream inputFile(inputPath);
+	if (!inputFile.is_open())
+		throw std::runtime_error("Input Data Error: Failed to open input data file: " + inputPath);
+	std::ostringstream inputText;
+	inputText << inputFile.rdbuf();
+	const std::string input = inputText.str();
+
+	std::vector<std::map<std::string, double>> trials(spec.trials);
+	MonteCarloResult result;
+	result.seeds.resize(spec.trials);
+
+	std::mutex progressMutex;
+	std::size_t done = 0;
+	StdoutMute mute; // per-run progress bars and totals; the summary reports them
+
+	runParallel(spec.trials, spec.threads, [&](std::size_t t) {
+		NetworkParameters params = nominal; // weights are shared WeightMatrix handles
+		params.verbosity = Verbosity::Info;
+		params.variation = spec.variation;
+		params.variation.seed = trialSeed(spec.seed, t);
+		result.seeds[t] = params.variation.seed;
+		// per-layer spike counts from the spike statistics; BIU neurons record no trace
+		params.spikeStats = true;
+		params.probes.clear();
+
+		Session session(std::move(params));
+		session.setKeepTraces(false);
+		RunResult run = session.runText(input);
+
+		std::map<std::string, double>& metrics = trials[t];
+		metrics = std::move(run.totals);
+		for (size_t l = 0; l < run.layers.size(); ++l)
+			metrics["spikes_L" + std::to_string(l)] = run.layers[l].spikes;
+
+		std::lock_guard<std::mutex> lock(progressMutex);
+		std::clog << "\rMonte Carlo: " << ++done << "/" << spec.trials << " trials done" << std::flush;
+	});
+	std::clog << std::endl;
+
+	std::map<std::string, std::size_t> columns;
+	for (const auto& metrics : trials)
+		for (const auto& m : metrics)
+			columns.emplace(m.first, 0);
+	for (const auto& c : columns)
+		result.metrics.push_back(c.first);
+
+	result.values.assign(spec.trials, std::vector<double>(result.metrics.size(), std::numeric_limits<double>::quiet_NaN()));
+	for (size_t t = 0; t < trials.size(); ++t)
+		for (size_t m = 0; m < result.metrics.size(); ++m)
+		{
+			auto it = trials[t].find(result.metrics[m]);
+			if (it != trials[t].end())
+				result.values[t][m] = it->second;
+		}
+	return result;
+}
+
+static std::string formatNumber(double v)
+{
+	std::ostringstream s;
+	s << std::setprecision(10) << v;
+	return s.str();
+}
+
+void writeMonteCarloSummary(std::ostream& out, const MonteCarloResult& result, bool csv)
+{
+	std::vector<std::vector<std::string>> table{ { "metric", "trials", "mean", "stddev", "min", "p05", "median", "p95", "max" } };
+	for (size_t m = 0; m < result.metrics.size(); ++m)
+	{
+		std::vector<double> values;
+		for (const auto& trial : result.values)
+			if (!std::isnan(trial[m]))
+				values.push_back(trial[m]);
+		if (values.empty())
+			continue;
+		std::sort(values.begin(), values.end());
+
+		// Welford: exact for constant metrics, stable for large energies
+		const double n = static_cast<double>(values.size());
+		double mean = 0.0, squares = 0.0;
+		for (size_t k = 0; k < values.size(); ++k)
+		{
+			const double delta = values[k] - mean;
+			mean += delta / static_cast<double>(k + 1);
+			squares += delta * (values[k] - mean);
+		}
+		const double stddev = values.size() > 1 ? std::sqrt(squares / (n - 1.0)) : 0.0;
+
+		// nearest-rank percentile
+		auto percentile = [&](double p) {
+			size_t rank = static_cast<size_t>(std::ceil(p * n));
+			return values[rank == 0 ? 0 : rank - 1];
+		};
+
+		table.push_back({ result.metrics[m], std::to_string(values.size()), formatNumber(mean), formatNumber(stddev),
+		                  formatNumber(values.front()), formatNumber(percentile(0.05)), formatNumber(percentile(0.5)),
+		                  formatNumber(percentile(0.95)), formatNumber(values.back()) });
+	}
+
+	std::vector<size_t> widths(table.front().size(), 0);
+	for (const auto& cells : table)
+		for (size_t c = 0; c < cells.size(); ++c)
+			widths[c] = std::max(widths[c], cells[c].size());
+
+	for (const auto& cells : table)
+	{
+		for (size_t c = 0; c < cells.size(); ++c)
+		{
+			if (csv)
+				out << (c ? "," : "") << cells[c];
+			else if (c == 0)
+				out << std::left << std::setw(static_cast<int>(widths[c])) << cells[c] << std::right;
+			else
+				out << "  " << std::setw(static_cast<int>(widths[c])) << cells[c];
+		}
+		out << '\n';
+	}
+}
+
+void writeMonteCarloTrials(std::ostream& out, const MonteCarloResult& result)
+{
+	out << "trial,seed";
+	for (const auto& metric : result.metrics)
+		out << ',' << metric;
+	out << '\n';
+
+	for (size_t t = 0; t < result.values.size(); ++t)
+	{
+		out << t << ',' << result.seeds[t];
+		for (double v : result.values[t])
+		{
+			out << ',';
+			if (!std::isnan(v))
+				out << formatNumber(v);
+		}
+		out << '\n';
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * @file MonteCarlo.hpp
+ * @brief Monte Carlo device-variation trials over a network that is parsed once.
+ *
+ * Every trial builds the network from the nominal NetworkParameters (shared weights, not
+ * copied) plus a DeviceVariation with its own seed; the networks derive the perturbed
+ * per-device values while they are built (BIU: per-neuron VTh, RLeak, Cu, Cn; LIF: the
+ * conductance of every Y-Flash cell, stored as a delta next to the shared matrix). The
+ * input file is read once and the trials run in parallel, one per worker thread.
+ *
+ * Trial t uses the seed trialSeed(seed, t), so a design point is reproducible from the
+ * spec alone and does not depend on the thread count.
+ *
+ * Spec format (JSON, one key per line; sigmas are relative to the nominal value):
+ *
+ *     {
+ *         "trials": 1000,
+ *         "seed": 1,
+ *         "distribution": "gaussian",
+ *         "VTh_sigma": 0.03,
+ *         "RLeak_sigma": 0.1,
+ *         "Cu_sigma": 0.05,
+ *         "Cn_sigma": 0.05,
+ *         "YFlash_sigma": 0.1,
+ *         "threads": 0,
+ *         "summary_file": "montecarlo_summary.csv",
+ *         "trials_file": "montecarlo_trials.csv"
+ *     }
+ *
+ * "gaussian" scales a value by 1 + sigma * z (redrawn until positive), "lognormal" by
+ * exp(sigma * z - sigma^2 / 2). VTh/RLeak/Cu/Cn apply to BIU networks, YFlash to LIF.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "networkParams.hpp"
+
+struct MonteCarloSpec
+{
+    std::size_t trials = 0;
+    std::uint64_t seed = 1;
+    unsigned threads = 0;              // 0 = one per core
+    DeviceVariation variation;         // distribution and sigmas; the seed is set per trial
+    std::string summaryFile = "montecarlo_summary.csv";
+    std::string trialsFile = "montecarlo_trials.csv"; // empty = no per-trial table
+};
+
+/// Metrics of every trial: metric names (sorted) and one row of values per trial.
+struct MonteCarloResult
+{
+    std::vector<std::string> metrics;          // run totals and spikes_L<l> per layer
+    std::vector<std::uint64_t> seeds;          // per trial
+    std::vector<std::vector<double>> values;   // [trial][metric]; NaN if a trial lacks it
+};
+
+/// Reads a Monte Carlo spec. Throws std::runtime_error ("Monte Carlo Error: ...") if invalid.
+MonteCarloSpec parseMonteCarloSpec(const std::string& path);
+
+/// Device seed of trial `trial` of a design point seeded with `seed`.
+std::uint64_t trialSeed(std::uint64_t seed, std::size_t trial);
+
+/// Runs the trials of `spec` on `inputPath`. Throws if the spec does not fit the network.
+MonteCarloResult runMonteCarlo(const NetworkParameters& nominal, const MonteCarloSpec& spec, const std::string& inputPath);
+
+/// Statistics per metric: mean, standard deviation, min, 5th percentile, median, 95th
+/// percentile and max over the trials. Aligned for reading, or comma separated when `csv`.
+void writeMonteCarloSummary(std::ostream& out, const MonteCarloResult& result, bool csv);
+
+/// One CSV row per trial: trial index, device seed and every metric.
+void writeMonteCarloTrials(std::ostream& out, const MonteCarloResult& result);
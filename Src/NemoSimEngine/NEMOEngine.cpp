@@ -1,25 +1,60 @@
 #include "NEMOEngine.hpp"
+#include "Profiler.hpp"
 
-NEMOEngine::NEMOEngine(NetworkParameters params)
+std::unique_ptr<BaseNetwork> createNetwork(const NetworkParameters& params)
 {
 	switch (params.networkType)
 	{
 	case NetworkTypes::BIUNetworkType:
-		m_pNetwork = new BIUNetwork(params);
-		break;
+		return std::unique_ptr<BaseNetwork>(new BIUNetwork(params));
 
 	case NetworkTypes::LIFNetworkType:
-		m_pNetwork = new LIFNetwork(params);
-		break;
+		return std::unique_ptr<BaseNetwork>(new LIFNetwork(params));
 	case NetworkTypes::ANNNetworkType:
-		m_pNetwork = new ANNNetwork(params);
-		break;
+		return std::unique_ptr<BaseNetwork>(new ANNNetwork(params));
 
 	default:
 		throw std::invalid_argument("Unknown network type");
 	}
 }
 
+void applyRunOptions(BaseNetwork& network, const NetworkParameters& params)
+{
+	PipelineOptions pipeline;
+	pipeline.enabled = params.pipelineEnabled;
+	pipeline.depth = static_cast<std::size_t>(params.pipelineDepth);
+	network.setPipelineOptions(pipeline);
+
+	SpikeStatsOptions spikeStats;
+	spikeStats.enabled = params.spikeStats;
+	spikeStats.file = params.spikeStatsFile;
+	spikeStats.binLines = static_cast<std::size_t>(params.spikeStatsBinLines);
+	network.setSpikeStatsOptions(spikeStats);
+
+	ReadoutOptions readout;
+	readout.mode = params.readoutMode;
+	readout.file = params.readoutFile;
+	readout.labelsPath = params.readoutLabelsPath;
+	network.setReadoutOptions(readout);
+}
+
+NEMOEngine::NEMOEngine(NetworkParameters params)
+{
+	m_pNetwork = createNetwork(params).release();
+	applyRunOptions(*m_pNetwork, params);
+
+	CheckpointOptions checkpoint;
+	checkpoint.path = params.checkpointPath;
+	checkpoint.everyLines = static_cast<std::size_t>(params.checkpointEveryLines);
+	checkpoint.everySeconds = params.checkpointEverySeconds;
+	checkpoint.resumeFrom = params.checkpointResumePath;
+	m_pNetwork->setCheckpointOptions(checkpoint);
+
+	ProgressOptions progress;
+	progress.intervalSeconds = params.progressIntervalSeconds;
+	m_pNetwork->setProgressOptions(progress);
+}
+
 NEMOEngine::~NEMOEngine()
 {
 	delete m_pNetwork;
@@ -29,5 +64,7 @@ NEMOEngine::~NEMOEngine()
 void NEMOEngine::runEngine(std::ifstream &inputFile)
 {
 	m_pNetwork->run(inputFile);
+
+	Profiler::Scope timer(Profiler::OutputWrite);
 	m_pNetwork->printNetworkToFile();
 }
\ No newline at end of file
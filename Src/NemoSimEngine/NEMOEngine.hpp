@@ -6,12 +6,20 @@
 #include <string>
 #include <cmath>
 #include <fstream>
+#include <memory>
 #include "networkParams.hpp"
 #include "LIFNetwork.hpp"
 #include "BIUNetwork.hpp"
 #include "BaseNetwork.hpp"
 #include "ANNNetwork.hpp"
 
+// Builds the network described by `params` (BIU, LIF or ANN) in its initial state.
+std::unique_ptr<BaseNetwork> createNetwork(const NetworkParameters& params);
+
+// Applies the options of `params` that every kind of run uses (pipeline, spike statistics,
+// readout); checkpoints and progress are left to the NEMOSIM executable.
+void applyRunOptions(BaseNetwork& network, const NetworkParameters& params);
+
 class NEMOEngine
 {
 public:
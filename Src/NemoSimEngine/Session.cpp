@@ -0,0 +1,230 @@
+#include "Session.hpp"
+#include "NEMOEngine.hpp"
+#include "NetworkImage.hpp"
+#include "TaskScheduler.hpp"
+#include "XMLParser.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// ---------------- network loading ----------------
+
+std::vector<std::string> NetworkSources(const Config& config)
+{
+	std::vector<std::string> sources{ config.xmlConfigPath };
+	if (!config.supXmlConfigPath.empty())
+		sources.push_back(config.supXmlConfigPath);
+	return sources;
+}
+
+bool ParseNetworkXML(XMLParser* parser, NetworkParameters* params, const Config& config)
+{
+	for (const auto& path : NetworkSources(config))
+	{
+		if (!parser->parse(path.c_str(), *params))
+		{
+			std::cerr << "Failed to parse network configuration." << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LoadNetworkDescription(XMLParser* parser, NetworkParameters* params, const Config& config)
+{
+	std::uint64_t sourceHash = 0;
+	if (config.networkImagePath.empty() || !hashNetworkSources(NetworkSources(config), sourceHash))
+		return ParseNetworkXML(parser, params, config); // no image, or the XML reports its own error
+
+	std::string whyNot;
+	if (loadNetworkImage(config.networkImagePath, sourceHash, *params, whyNot))
+	{
+		std::cout << "Loaded network image " << config.networkImagePath << std::endl;
+		return true;
+	}
+
+	std::cout << "Network image " << config.networkImagePath << " " << whyNot << "; parsing the XML configuration and rebuilding it." << std::endl;
+	if (!ParseNetworkXML(parser, params, config))
+		return false;
+	writeNetworkImage(config.networkImagePath, *params, sourceHash);
+	return true;
+}
+
+bool RetrieveNetworkParamsFromXML(XMLParser* parser, NetworkParameters* params, Config& config)
+{
+	if (!LoadNetworkDescription(parser, params, config))
+		return false;
+
+	if (!config.neuronEnergyCsvPath.empty())
+	{
+		params->neuronEnergyCsvPath = config.neuronEnergyCsvPath;
+	}
+
+	if (!config.synapsesEnergyCsvPath.empty())
+	{
+		params->synapsesEnergyCsvPath = config.synapsesEnergyCsvPath;
+	}
+
+	params->verbosity = config.verbosity;
+	params->biuQuiescentFastForward = config.quiescentFastForward;
+	params->biuEarlyExitMode = config.earlyExitMode;
+	params->biuEarlyExitTolerance = config.earlyExitTolerance;
+	params->biuPatternLutInputs = config.biuPatternLutInputs;
+	params->biuLayerPipeline = config.biuLayerPipeline;
+	params->computeThreads = config.computeThreads;
+	params->pipelineEnabled = config.pipeline;
+	params->pipelineDepth = config.pipelineDepth;
+	params->checkpointPath = config.checkpointPath;
+	params->checkpointEveryLines = config.checkpointEveryLines;
+	params->checkpointEverySeconds = config.checkpointEverySeconds;
+	params->resetEveryLines = config.resetEveryLines;
+	params->shards = config.shards;
+	params->progressIntervalSeconds = config.progressIntervalSeconds;
+	params->probes = config.probes;
+	params->spikeStats = config.spikeStats;
+	params->spikeStatsFile = config.spikeStatsFile;
+	params->spikeStatsBinLines = config.spikeStatsBinLines;
+	params->readoutMode = config.readoutMode;
+	params->readoutFile = config.readoutFile;
+	params->readoutLabelsPath = config.readoutLabelsPath;
+	params->precision = config.precision;
+	params->fixedPoint = config.fixedPoint;
+	if (params->precision != Precision::Double && params->networkType == NetworkTypes::ANNNetworkType)
+		std::cerr << "Warning: precision is only supported by BIU and LIF networks; ANN runs in double.\n";
+	if (params->precision == Precision::Fixed && params->networkType == NetworkTypes::LIFNetworkType)
+	{
+		std::cerr << "Warning: fixed precision is only supported by BIU networks; LIF runs in double.\n";
+		params->precision = Precision::Double;
+	}
+	if (params->readoutMode != ReadoutMode::Off && params->networkType == NetworkTypes::ANNNetworkType)
+		std::cerr << "Warning: readout is only supported by BIU and LIF networks; ignored.\n";
+	if (!params->probes.empty() && params->networkType != NetworkTypes::BIUNetworkType)
+		std::cerr << "Warning: probes are only supported by BIU networks; every trace is recorded.\n";
+	return true;
+}
+
+// ---------------- Session ----------------
+
+Session::Session(const std::string& jsonConfigPath)
+{
+	XMLParser parser;
+	Config config = parser.parseConfigFromFile(jsonConfigPath);
+	parser.setStreaming(config.xmlStreaming);
+
+	if (config.xmlConfigPath.empty())
+		throw std::runtime_error("Configuration Error: XML configuration path is empty in " + jsonConfigPath);
+	if (!RetrieveNetworkParamsFromXML(&parser, &m_params, config))
+		throw std::runtime_error("Configuration Error: failed to load the network of " + jsonConfigPath);
+	loadEnergyTable_();
+}
+
+Session::Session(NetworkParameters params)
+	: m_params(std::move(params))
+{
+	loadEnergyTable_();
+}
+
+void Session::loadEnergyTable_()
+{
+	// read the energy CSVs once; every network of the session shares the tables
+	if (m_params.networkType == NetworkTypes::BIUNetworkType && !m_params.energyTable)
+		m_params.energyTable = BIUNetwork::loadEnergyTable(m_params);
+}
+
+RunResult Session::run(std::istream& input)
+{
+	RunResult result;
+
+	// a fresh network per run: the initial state, sharing the loaded weights
+	std::unique_ptr<BaseNetwork> network = createNetwork(m_params);
+	applyRunOptions(*network, m_params);
+	if (m_keepTraces)
+		network->captureTraces(&result.traces);
+	else
+		network->discardTraces();
+	network->captureSpikeStats(&result.spikeStats);
+
+	network->run(input);
+	network->printNetworkToFile(); // traces were captured; only the summary is printed
+	network->collectTotals(result.totals);
+	if (const SpikeStats* stats = network->spikeStats())
+	{
+		for (std::size_t l = 0; l < stats->layerCount(); ++l)
+		{
+			LayerActivity layer;
+			layer.neurons = stats->layerSize(l);
+			layer.cycles = static_cast<std::size_t>(stats->cycles());
+			layer.spikes = static_cast<double>(stats->layerSpikes(l));
+			result.layers.push_back(layer);
+		}
+	}
+	return result;
+}
+
+RunResult Session::runFile(const std::string& inputPath)
+{
+	std::ifstream input(inputPath);
+	if (!input.is_open())
+		throw std::runtime_error("Input Data Error: Failed to open input data file: " + inputPath);
+	return run(input);
+}
+
+RunResult Session::runText(const std::string& inputText)
+{
+	std::istringstream input(inputText);
+	return run(input);
+}
+
+// ---------------- batch helpers ----------------
+
+std::vector<LayerActivity> layerActivity(const RunResult& result)
+{
+	std::vector<LayerActivity> layers;
+	for (const auto& trace : result.traces)
+	{
+		unsigned layer = 0, neuron = 0;
+		char tail = 0;
+		if (std::sscanf(trace.first.c_str(), "spikes_%u_%u.tx%c", &layer, &neuron, &tail) != 3 || tail != 't')
+			continue;
+		if (layer >= layers.size())
+			layers.resize(layer + 1);
+
+		LayerActivity& activity = layers[layer];
+		++activity.neurons;
+		activity.cycles = std::max(activity.cycles, trace.second.size());
+		for (double s : trace.second)
+			activity.spikes += s;
+	}
+	return layers;
+}
+
+void runParallel(std::size_t count, unsigned threads, const std::function<void(std::size_t)>& job)
+{
+	if (count == 0)
+		return;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+
+	// one job per task: runs are long and uneven, idle workers steal what is left
+	TaskScheduler scheduler(threads);
+	scheduler.parallelFor(count, 1, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			job(i);
+	});
+}
+
+StdoutMute::StdoutMute()
+	: m_saved(std::cout.rdbuf(&m_null))
+{
+}
+
+StdoutMute::~StdoutMute()
+{
+	std::cout.rdbuf(m_saved);
+}
@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file Session.hpp
+ * @brief In-process API of libnemosim: load a network once, run many input streams.
+ *
+ * The NEMOSIM executable parses the configuration, builds the network and runs one input
+ * file per process. A Session keeps the parsed NetworkParameters (weights and energy tables
+ * are loaded once and shared, not copied) and builds a fresh network from them for every
+ * run, so each run starts from the initial state without re-reading any XML or CSV file.
+ * Traces are returned in memory instead of being written to the working directory:
+ *
+ *     Session session("config.json");
+ *     for (const auto& path : inputs)
+ *     {
+ *         RunResult result = session.runFile(path);
+ *         const auto& spikes = result.traces["spikes_0_0.txt"];
+ *         double energy = result.totals["neuron_energy_fJ"];
+ *     }
+ *
+ * The readout table comes back as a trace (under readout_file) and the spike statistics
+ * summary as RunResult::spikeStats, with its per-layer spike counts in RunResult::layers.
+ * Batch drivers that only need those turn the traces off (setKeepTraces(false)). Runs of one Session are sequential; use one Session
+ * per thread to run in parallel. Checkpointing, resume and progress reports are
+ * command-line features and are not used by sessions.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "networkParams.hpp"
+#include "Pipeline.hpp"
+
+class XMLParser;
+
+/// Output activity of one BIU or LIF layer in a run.
+struct LayerActivity
+{
+    std::size_t neurons = 0;
+    std::size_t cycles = 0;   // simulated cycles (length of a spike trace)
+    double spikes = 0.0;      // output spikes of all neurons
+};
+
+struct RunResult
+{
+    TraceMap traces;                       // output file name -> values, as NEMOSIM would write them
+    std::map<std::string, double> totals;  // energies, spike counts, MAC values, ...
+    std::string spikeStats;                // spike_stats summary (JSON) when enabled, else empty
+    std::vector<LayerActivity> layers;     // from the spike statistics when enabled, else empty
+};
+
+class Session
+{
+public:
+    /// Loads the network named by a JSON run configuration (XML files or network image,
+    /// energy tables, engine options). Throws std::runtime_error if it cannot be loaded.
+    explicit Session(const std::string& jsonConfigPath);
+
+    /// Uses parameters that are already parsed.
+    explicit Session(NetworkParameters params);
+
+    const NetworkParameters& parameters() const { return m_params; }
+
+    /// false: traces (and the readout table) are dropped as the runs produce them and
+    /// RunResult::traces stays empty; totals and spike statistics are still returned.
+    void setKeepTraces(bool keep) { m_keepTraces = keep; }
+
+    /// Runs `input` (same format as the data input file) on the network in its initial state.
+    RunResult run(std::istream& input);
+    RunResult runFile(const std::string& inputPath);
+    RunResult runText(const std::string& inputText);
+
+private:
+    NetworkParameters m_params;
+    bool m_keepTraces = true;
+
+    void loadEnergyTable_();
+};
+
+// ---------------- batch helpers (sweeps, Monte Carlo) ----------------
+
+/// Per-layer activity from the spikes_<layer>_<neuron>.txt traces of `result`.
+/// (RunResult::layers has it without traces when spike_stats is on.)
+std::vector<LayerActivity> layerActivity(const RunResult& result);
+
+/// Runs job(0) .. job(count - 1) on up to `threads` threads of a TaskScheduler (0 = one per
+/// core). The first exception thrown by a job is rethrown once all workers have stopped.
+void runParallel(std::size_t count, unsigned threads, const std::function<void(std::size_t)>& job);
+
+/// Discards everything written to std::cout while alive. Network runs print progress and
+/// totals; batch drivers mute them while runs execute in parallel and report results themselves.
+class StdoutMute
+{
+public:
+    StdoutMute();
+    ~StdoutMute();
+    StdoutMute(const StdoutMute&) = delete;
+    StdoutMute& operator=(const StdoutMute&) = delete;
+
+private:
+    struct NullBuffer : std::streambuf
+    {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+    NullBuffer m_null;
+    std::streambuf* m_saved;
+};
+
+// ---------------- network loading (shared with the NEMOSIM executable) ----------------
+
+/// The XML files a configuration reads: the main one, then the supplementary one if any.
+std::vector<std::string> NetworkSources(const Config& config);
+
+/// Parses every XML file of `config` into `params`; prints the error and returns false on failure.
+bool ParseNetworkXML(XMLParser* parser, NetworkParameters* params, const Config& config);
+
+/// Loads the network from the configured network image when it was built from the current
+/// XML files; otherwise parses the XML and (re)writes the image for the next run.
+bool LoadNetworkDescription(XMLParser* parser, NetworkParameters* params, const Config& config);
+
+/// LoadNetworkDescription plus the run options of `config` (energy tables, engine switches).
+bool RetrieveNetworkParamsFromXML(XMLParser* parser, NetworkParameters* params, Config& config);
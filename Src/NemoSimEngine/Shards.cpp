@@ -0,0 +1,187 @@
+#include "Shards.hpp"
+#include "NEMOEngine.hpp"
+#include "MappedFile.hpp"
+#include "Session.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+
+namespace {
+
+// istream buffer over a byte range of the mapped input file; only read, never copied.
+class SpanBuffer : public std::streambuf
+{
+public:
+	SpanBuffer(const char* begin, const char* end)
+	{
+		char* first = const_cast<char*>(begin); // get area only: nothing is written through it
+		setg(first, first, const_cast<char*>(end));
+	}
+};
+
+// Appends the spool files of a shard to the trace files of the run and removes them.
+void appendSpool(const std::vector<std::string>& paths, const std::string& spoolPrefix)
+{
+	for (std::size_t i = 0; i < paths.size(); ++i)
+	{
+		const std::string spool = spoolPrefix + std::to_string(i);
+		{
+			std::ifstream in(spool, std::ios::binary);
+			std::ofstream out(paths[i], std::ios::binary | std::ios::app);
+			if (in.is_open() && in.peek() != std::ifstream::traits_type::eof())
+			{
+				if (out.is_open())
+					out << in.rdbuf();
+				else
+					std::cerr << "Warning: could not open " << paths[i] << " for writing.\n";
+			}
+		}
+		std::remove(spool.c_str());
+	}
+}
+
+} // namespace
+
+std::vector<ShardSpan> splitInput(const char* text, std::size_t size, std::size_t shards, std::size_t blockLines)
+{
+	// byte offset of every block, counting lines as std::getline does
+	std::vector<std::size_t> blockStarts{ 0 };
+	std::size_t lines = 0;
+	for (std::size_t pos = 0; pos < size; ++lines)
+	{
+		if (lines > 0 && lines % blockLines == 0)
+			blockStarts.push_back(pos);
+		const void* newline = std::memchr(text + pos, '\n', size - pos);
+		pos = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - text) + 1 : size;
+	}
+
+	const std::size_t blocks = blockStarts.size();
+	shards = std::max<std::size_t>(1, std::min(shards, blocks));
+	std::vector<ShardSpan> spans(shards);
+	for (std::size_t s = 0; s < shards; ++s)
+	{
+		const std::size_t first = s * blocks / shards, last = (s + 1) * blocks / shards;
+		ShardSpan& span = spans[s];
+		span.firstLine = first * blockLines;
+		span.lines = std::min(last * blockLines, lines) - std::min(span.firstLine, lines);
+		span.begin = blockStarts[first];
+		span.end = last < blocks ? blockStarts[last] : size;
+	}
+	return spans;
+}
+
+ShardedRun runSharded(const NetworkParameters& params, const std::string& inputPath, const std::string& outputDirectory)
+{
+	if (params.networkType != NetworkTypes::BIUNetworkType && params.networkType != NetworkTypes::LIFNetworkType)
+		throw std::runtime_error("Shard Error: sharded runs are supported for BIU and LIF networks");
+	if (params.resetEveryLines <= 0)
+		throw std::runtime_error("Shard Error: shards needs reset_every_lines > 0 (the input is only split where the network is reset)");
+	if (!params.checkpointPath.empty() || !params.checkpointResumePath.empty())
+		throw std::runtime_error("Shard Error: checkpoints are not available in sharded runs");
+	if (params.spikeStats)
+		throw std::runtime_error("Shard Error: spike_stats is not available in sharded runs");
+
+	MappedFile input(inputPath);
+	const char* text = reinterpret_cast<const char*>(input.data());
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	const std::vector<ShardSpan> spans = splitInput(text, input.size(),
+		params.shards > 0 ? static_cast<std::size_t>(params.shards) : cores,
+		static_cast<std::size_t>(params.resetEveryLines));
+
+	ShardedRun run;
+	run.shards = spans.size();
+
+	// the energy tables are read once and shared by the networks of all shards
+	NetworkParameters shared = params;
+	if (shared.networkType == NetworkTypes::BIUNetworkType && !shared.energyTable)
+		shared.energyTable = BIUNetwork::loadEnergyTable(shared);
+
+	// Shard 0 writes the trace files, shard s > 0 its spool files; a shard's spool is appended
+	// once all shards before it are written, by the worker that completes the sequence.
+	const std::string spoolDirectory = absolutePath(outputDirectory);
+	const auto spoolPrefix = [&](std::size_t s) {
+		return spoolDirectory + "/.shard" + std::to_string(s) + "_";
+	};
+	std::vector<std::map<std::string, double>> totals(spans.size());
+	std::vector<bool> finished(spans.size(), false);
+	std::vector<std::string> paths;       // trace files, from shard 0
+	std::size_t appended = 1;             // next shard to append
+	std::uint64_t labelled = 0, correct = 0;
+	bool readout = false;
+	std::mutex mergeMutex;
+	std::size_t done = 0;
+	{
+		StdoutMute mute; // per-shard progress and totals; the merged totals are printed instead
+
+		runParallel(spans.size(), static_cast<unsigned>(spans.size()), [&](std::size_t s) {
+			const ShardSpan& span = spans[s];
+			std::unique_ptr<BaseNetwork> network = createNetwork(shared);
+			applyRunOptions(*network, shared);
+			network->setLineOffset(span.firstLine);
+			network->redirectTraces(outputDirectory, s > 0 ? spoolPrefix(s) : std::string());
+
+			SpanBuffer buffer(text + span.begin, text + span.end);
+			std::istream in(&buffer);
+			network->run(in);
+			network->printNetworkToFile(); // traces were streamed; only the summary is printed
+			network->collectTotals(totals[s]);
+
+			std::lock_guard<std::mutex> lock(mergeMutex);
+			if (const Readout* shardReadout = network->readout())
+			{
+				readout = shardReadout->hasLabels();
+				labelled += shardReadout->labelled();
+				correct += shardReadout->correct();
+			}
+			if (s == 0)
+				paths = network->tracePaths();
+			finished[s] = true;
+			for (; appended < spans.size() && finished[0] && finished[appended]; ++appended)
+				appendSpool(paths, spoolPrefix(appended));
+			std::clog << "\rShards: " << ++done << "/" << spans.size() << " done" << std::flush;
+		});
+	}
+	std::clog << std::endl;
+
+	// Per-line averages are weighted by the lines of each shard, the readout accuracy is
+	// counted over all shards; every other total is a sum.
+	std::map<std::string, double> weights;
+	for (std::size_t s = 0; s < spans.size(); ++s)
+	{
+		run.lines += spans[s].lines;
+		for (const auto& total : totals[s])
+		{
+			if (total.first == "readout_accuracy")
+				continue;
+			if (total.first == "simulated_cycles_per_line")
+			{
+				run.totals[total.first] += total.second * static_cast<double>(spans[s].lines);
+				weights[total.first] += static_cast<double>(spans[s].lines);
+			}
+			else
+			{
+				run.totals[total.first] += total.second;
+			}
+		}
+	}
+	for (const auto& weight : weights)
+		run.totals[weight.first] = weight.second > 0.0 ? run.totals[weight.first] / weight.second : 0.0;
+	if (readout)
+		run.totals["readout_accuracy"] = labelled ? static_cast<double>(correct) / static_cast<double>(labelled) : 0.0;
+	return run;
+}
+
+void printShardedRun(std::ostream& out, const ShardedRun& run)
+{
+	out << "Finished executing " << run.lines << " input lines in " << run.shards << " shards.\n";
+	for (const auto& total : run.totals)
+		out << total.first << ": " << total.second << '\n';
+}
@@ -0,0 +1,63 @@
+#pragma once
+/**
+ * @file Shards.hpp
+ * @brief Sharded runs: the input file split where the network is reset, the parts run in parallel.
+ *
+ * With reset_every_lines = K the network returns to its initial state before input lines
+ * K+1, 2K+1, ..., so blocks of K lines do not depend on each other. A sharded run maps the
+ * input file, cuts it into `shards` contiguous parts of whole blocks and runs every part on
+ * a network of its own, one per worker thread. The networks are built from the one parsed
+ * NetworkParameters (the weight matrices, e.g. of a mapped network image, are shared and
+ * only read) and read their part in place from the mapping, numbering lines as in the
+ * whole file.
+ *
+ * Trace files go where an unsharded run puts them: the DS_<i> traces, which the network
+ * opens when it is built, in the current directory, all others in the output directory.
+ * The first shard writes the files themselves; every other shard streams its part into
+ * spool files in the output directory, which are appended to the files in input order as
+ * the shards complete, then removed. No trace is held in memory, so a sharded run needs
+ * no more memory than an unsharded one per worker. The readout rows keep their input line
+ * numbers. Totals are summed over the shards (energies up to rounding), per-line averages
+ * are weighted by the lines of each shard and the readout accuracy is counted over all
+ * of them. The files and totals therefore match an unsharded run with the same
+ * reset_every_lines.
+ *
+ * BIU and LIF networks only; checkpoints and spike statistics are not available.
+ */
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include "networkParams.hpp"
+
+/// A contiguous part of the input file: whole blocks of reset_every_lines lines.
+struct ShardSpan
+{
+	std::size_t firstLine = 0;  // lines of the file before this part
+	std::size_t lines = 0;
+	std::size_t begin = 0;      // byte range in the file
+	std::size_t end = 0;
+};
+
+/// Cuts `text` (the input file) into at most `shards` parts of whole blocks of `blockLines`
+/// lines, in file order and as even as the blocks allow. Lines are counted as std::getline
+/// reads them. Always returns at least one part (an empty one for an empty file).
+std::vector<ShardSpan> splitInput(const char* text, std::size_t size, std::size_t shards, std::size_t blockLines);
+
+struct ShardedRun
+{
+	std::map<std::string, double> totals;  // merged over the shards
+	std::size_t shards = 0;
+	std::size_t lines = 0;
+};
+
+/// Runs `inputPath` on params.shards shards (0 = one per core) and writes the merged trace
+/// files; `outputDirectory` must exist. Relative paths are resolved against the current
+/// directory. Throws std::runtime_error ("Shard Error: ...") if the configuration cannot be
+/// sharded.
+ShardedRun runSharded(const NetworkParameters& params, const std::string& inputPath, const std::string& outputDirectory);
+
+/// Prints the totals of `run`, as an unsharded run prints its own.
+void printShardedRun(std::ostream& out, const ShardedRun& run);
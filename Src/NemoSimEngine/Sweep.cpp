@@ -0,0 +1,282 @@
+#include "Sweep.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+static const char* const kSweepKeys[] = { "VTh", "refractory", "RLeak", "DSClockMHz", "DSMode" };
+
+static std::string trimSpec(const std::string& s)
+{
+	size_t first = s.find_first_not_of(" \t\r\n\"");
+	if (first == std::string::npos)
+		return "";
+	size_t last = s.find_last_not_of(" \t\r\n\"");
+	return s.substr(first, last - first + 1);
+}
+
+static double parseSweepNumber(const std::string& name, const std::string& value)
+{
+	size_t used = 0;
+	double v = 0.0;
+	try
+	{
+		v = std::stod(value, &used);
+	}
+	catch (const std::exception&)
+	{
+		used = 0;
+	}
+	if (used == 0 || used != value.size())
+		throw std::runtime_error("Sweep Error: invalid value '" + value + "' for " + name);
+	return v;
+}
+
+std::size_t SweepSpec::configurationCount() const
+{
+	std::size_t count = 1;
+	for (const auto& axis : axes)
+		count *= axis.values.size();
+	return count;
+}
+
+SweepSpec parseSweepSpec(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+		throw std::runtime_error("Sweep Error: unable to open sweep spec: " + path);
+
+	SweepSpec spec;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t colon = line.find(':');
+		if (colon == std::string::npos) continue;
+
+		std::string key = line.substr(0, colon);
+		key = trimSpec(key.substr(key.find_last_of("{,") == std::string::npos ? 0 : key.find_last_of("{,") + 1));
+		std::string rest = line.substr(colon + 1);
+
+		if (key == "threads")
+		{
+			double threads = parseSweepNumber(key, trimSpec(rest.substr(0, rest.find(','))));
+			if (threads < 0)
+				throw std::runtime_error("Sweep Error: threads cannot be negative");
+			spec.threads = static_cast<unsigned>(threads);
+			continue;
+		}
+		if (key == "summary_file")
+		{
+			size_t quote = rest.find('"');
+			spec.summaryFile = (quote == std::string::npos)
+				? trimSpec(rest.substr(0, rest.find(',')))
+				: rest.substr(quote + 1, rest.find('"', quote + 1) - quote - 1);
+			continue;
+		}
+		if (std::find(std::begin(kSweepKeys), std::end(kSweepKeys), key) == std::end(kSweepKeys))
+			throw std::runtime_error("Sweep Error: unknown parameter '" + key + "' in " + path);
+
+		size_t open = rest.find('[');
+		size_t close = rest.find(']', open == std::string::npos ? 0 : open);
+		if (open == std::string::npos || close == std::string::npos)
+			throw std::runtime_error("Sweep Error: " + key + " needs a list of values on one line, e.g. \"" + key + "\": [a, b]");
+
+		SweepAxis axis;
+		axis.name = key;
+		std::stringstream list(rest.substr(open + 1, close - open - 1));
+		std::string item;
+		while (std::getline(list, item, ','))
+		{
+			item = trimSpec(item);
+			if (!item.empty())
+				axis.values.push_back(item);
+		}
+		if (axis.values.empty())
+			throw std::runtime_error("Sweep Error: " + key + " has no values");
+		for (const auto& existing : spec.axes)
+			if (existing.name == key)
+				throw std::runtime_error("Sweep Error: " + key + " is listed twice");
+		spec.axes.push_back(std::move(axis));
+	}
+
+	if (spec.axes.empty())
+		throw std::runtime_error("Sweep Error: " + path + " lists no parameters to sweep");
+	if (spec.summaryFile.empty())
+		throw std::runtime_error("Sweep Error: summary_file is empty");
+	return spec;
+}
+
+// Replaces the network-wide value and the per-neuron values that were derived from it.
+template <typename T>
+static void replaceNominal(std::vector<std::vector<T>>& perNeuron, T nominal, T value)
+{
+	for (auto& layer : perNeuron)
+		std::replace(layer.begin(), layer.end(), nominal, value);
+}
+
+void applySweepConfiguration(const SweepSpec& spec, std::size_t index, const NetworkParameters& nominal,
+                             NetworkParameters& params, std::vector<std::string>& values)
+{
+	// mixed-radix index, the last axis varies fastest
+	values.assign(spec.axes.size(), std::string());
+	for (size_t a = spec.axes.size(); a-- > 0;)
+	{
+		const SweepAxis& axis = spec.axes[a];
+		values[a] = axis.values[index % axis.values.size()];
+		index /= axis.values.size();
+	}
+
+	for (size_t a = 0; a < spec.axes.size(); ++a)
+	{
+		const std::string& name = spec.axes[a].name;
+		const std::string& value = values[a];
+
+		if (name == "DSMode")
+		{
+			auto it = StringToDSMode.find(value);
+			if (it == StringToDSMode.end())
+				throw std::runtime_error("Sweep Error: invalid DSMode '" + value + "' (expected ThresholdMode or FrequencyMode)");
+			params.DSMode = it->second;
+			continue;
+		}
+
+		double v = parseSweepNumber(name, value);
+		if (name == "VTh")
+		{
+			if (v <= 0.0 || v >= params.VDD)
+				throw std::runtime_error("Sweep Error: VTh " + value + " must be positive and below VDD");
+			replaceNominal(params.biuNeuronVTh, nominal.VTh, v);
+			params.VTh = v;
+		}
+		else if (name == "refractory")
+		{
+			if (v < 0.0 || v != static_cast<int>(v))
+				throw std::runtime_error("Sweep Error: refractory " + value + " must be a non-negative integer");
+			replaceNominal(params.biuNeuronRefractory, static_cast<int>(nominal.refractory), static_cast<int>(v));
+			params.refractory = v;
+		}
+		else if (name == "RLeak")
+		{
+			if (v <= 0.0)
+				throw std::runtime_error("Sweep Error: RLeak " + value + " must be positive");
+			replaceNominal(params.biuNeuronRLeak, nominal.Rleak, v);
+			params.Rleak = v;
+		}
+		else if (name == "DSClockMHz")
+		{
+			if (v <= 0.0)
+				throw std::runtime_error("Sweep Error: DSClockMHz " + value + " must be positive");
+			params.DSClockMHz = v;
+		}
+	}
+}
+
+std::vector<SweepRow> runSweep(const NetworkParameters& nominal, const SweepSpec& spec, const std::string& inputPath)
+{
+	if (nominal.networkType != NetworkTypes::BIUNetworkType)
+		throw std::runtime_error("Sweep Error: sweeps are supported for BIU networks");
+
+	const std::size_t count = spec.configurationCount();
+	std::vector<SweepRow> rows(count);
+
+	// check every configuration before spending time on any run
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		NetworkParameters params = nominal;
+		applySweepConfiguration(spec, i, nominal, params, rows[i].values);
+	}
+
+	std::mutex progressMutex;
+	std::size_t done = 0;
+	StdoutMute mute; // per-run progress bars and totals; the summary reports them
+
+	runParallel(count, spec.threads, [&](std::size_t i) {
+		NetworkParameters params = nominal; // weights are shared WeightMatrix handles
+		params.verbosity = Verbosity::Info;
+		// per-layer spike counts from the spike statistics; no neuron records any trace
+		params.spikeStats = true;
+		params.probes.clear();
+		applySweepConfiguration(spec, i, nominal, params, rows[i].values);
+
+		Session session(std::move(params));
+		session.setKeepTraces(false);
+		RunResult result = session.runFile(inputPath);
+
+		SweepRow& row = rows[i];
+		row.totals = std::move(result.totals);
+		row.layers = std::move(result.layers);
+		row.clockMHz = session.parameters().DSClockMHz;
+
+		std::lock_guard<std::mutex> lock(progressMutex);
+		std::clog << "\rSweep: " << ++done << "/" << count << " configurations done" << std::flush;
+	});
+	std::clog << std::endl;
+	return rows;
+}
+
+void writeSweepSummary(std::ostream& out, const SweepSpec& spec, const std::vector<SweepRow>& rows, bool csv)
+{
+	size_t layerCount = 0;
+	for (const auto& row : rows)
+		layerCount = std::max(layerCount, row.layers.size());
+
+	std::vector<std::string> header{ "config" };
+	for (const auto& axis : spec.axes)
+		header.push_back(axis.name);
+	header.insert(header.end(), { "synaptic_energy_fJ", "neuron_energy_fJ", "spike_ins" });
+	for (size_t l = 0; l < layerCount; ++l)
+	{
+		header.push_back("spikes_L" + std::to_string(l));
+		header.push_back("rate_Hz_L" + std::to_string(l));
+	}
+
+	std::vector<std::vector<std::string>> table{ header };
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		const SweepRow& row = rows[i];
+		auto number = [](double v) { std::ostringstream s; s << std::setprecision(10) << v; return s.str(); };
+		auto total = [&](const char* key) {
+			auto it = row.totals.find(key);
+			return it == row.totals.end() ? std::string() : number(it->second);
+		};
+
+		std::vector<std::string> cells{ std::to_string(i) };
+		cells.insert(cells.end(), row.values.begin(), row.values.end());
+		cells.push_back(total("synaptic_energy_fJ"));
+		cells.push_back(total("neuron_energy_fJ"));
+		cells.push_back(total("spike_ins"));
+		for (size_t l = 0; l < layerCount; ++l)
+		{
+			if (l >= row.layers.size() || row.layers[l].neurons == 0 || row.layers[l].cycles == 0)
+			{
+				cells.insert(cells.end(), { "", "" });
+				continue;
+			}
+			const LayerActivity& layer = row.layers[l];
+			double perCycle = layer.spikes / (static_cast<double>(layer.neurons) * static_cast<double>(layer.cycles));
+			cells.push_back(number(layer.spikes));
+			cells.push_back(number(perCycle * row.clockMHz * 1e6));
+		}
+		table.push_back(std::move(cells));
+	}
+
+	std::vector<size_t> widths(header.size(), 0);
+	for (const auto& cells : table)
+		for (size_t c = 0; c < cells.size(); ++c)
+			widths[c] = std::max(widths[c], cells[c].size());
+
+	for (const auto& cells : table)
+	{
+		for (size_t c = 0; c < cells.size(); ++c)
+		{
+			if (csv)
+				out << (c ? "," : "") << cells[c];
+			else
+				out << (c ? "  " : "") << std::setw(static_cast<int>(widths[c])) << cells[c];
+		}
+		out << '\n';
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+/**
+ * @file Sweep.hpp
+ * @brief Parameter sweeps over a BIU network that is parsed once.
+ *
+ * A sweep spec lists value grids for network constants; every combination (the cartesian
+ * product, in spec order) is one configuration. The network is loaded once; each
+ * configuration copies the NetworkParameters (the weight matrices are shared, not
+ * copied), changes the swept constants and runs the input on its own Session. The
+ * configurations run in parallel, one per worker thread.
+ *
+ * Spec format (JSON, one key per line, one grid per line):
+ *
+ *     {
+ *         "VTh": [0.4, 0.5, 0.6],
+ *         "refractory": [0, 2],
+ *         "RLeak": [5e8, 1e9],
+ *         "DSClockMHz": [10, 20],
+ *         "DSMode": ["ThresholdMode", "FrequencyMode"],
+ *         "threads": 0,
+ *         "summary_file": "sweep_summary.csv"
+ *     }
+ *
+ * VTh, refractory and RLeak replace the network-wide value and every per-neuron value that
+ * equals it; per-neuron overrides from the XML that differ from the network-wide value are
+ * kept as they are.
+ */
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "networkParams.hpp"
+#include "Session.hpp"
+
+struct SweepAxis
+{
+    std::string name;                 // VTh, refractory, RLeak, DSClockMHz or DSMode
+    std::vector<std::string> values;  // as written in the spec
+};
+
+struct SweepSpec
+{
+    std::vector<SweepAxis> axes;
+    unsigned threads = 0;             // 0 = one per core
+    std::string summaryFile = "sweep_summary.csv";
+
+    std::size_t configurationCount() const;
+};
+
+/// Result of one configuration of a sweep.
+struct SweepRow
+{
+    std::vector<std::string> values;        // one per axis
+    std::map<std::string, double> totals;   // RunResult::totals
+    std::vector<LayerActivity> layers;
+    double clockMHz = 0.0;                  // DS clock of this configuration (for firing rates)
+};
+
+/// Reads a sweep spec. Throws std::runtime_error ("Sweep Error: ...") on an invalid spec.
+SweepSpec parseSweepSpec(const std::string& path);
+
+/// Sets the values of configuration `index` of `spec` on `params` (a copy of `nominal`).
+/// Throws std::runtime_error if a value is out of range.
+void applySweepConfiguration(const SweepSpec& spec, std::size_t index, const NetworkParameters& nominal,
+                             NetworkParameters& params, std::vector<std::string>& values);
+
+/// Runs every configuration of `spec` on `inputPath`; rows are in configuration order.
+std::vector<SweepRow> runSweep(const NetworkParameters& nominal, const SweepSpec& spec, const std::string& inputPath);
+
+/// Writes the summary table: one row per configuration with the swept values, the energy
+/// totals, input spikes and the output spikes and mean firing rate (Hz) of every layer.
+/// Columns are aligned for reading, or comma separated when `csv` is set.
+void writeSweepSummary(std::ostream& out, const SweepSpec& spec, const std::vector<SweepRow>& rows, bool csv);
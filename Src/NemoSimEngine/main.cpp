@@ -6,6 +6,15 @@
 #include <fstream>
 #include "XMLParser.hpp"
 #include "NEMOEngine.hpp"
+#include "NetworkImage.hpp"
+#include "Session.hpp"
+#include "Sweep.hpp"
+#include "MonteCarlo.hpp"
+#include "Shards.hpp"
+#include "Profiler.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -65,34 +74,23 @@ bool changeWorkingDirectory(const std::string& path) {
 
 
 
-bool RetrieveNetworkParamsFromXML(XMLParser* parser, NetworkParameters* params, Config& config)
+// Writes a report into the output directory (created if needed, the working directory is kept).
+bool writeReport(const Config& config, const std::string& name, const std::function<void(std::ostream&)>& write)
 {
-	if (!parser->parse(config.xmlConfigPath.c_str(), *params))
+	if (!directoryExists(config.outputDirectory) && !createDirectory(config.outputDirectory))
 	{
-		std::cerr << "Failed to parse network configuration." << std::endl;
+		std::cerr << "Failed to create output directory: " << config.outputDirectory << std::endl;
 		return false;
 	}
-
-	if (!config.supXmlConfigPath.empty())
-	{
-		if (!parser->parse(config.supXmlConfigPath.c_str(), *params))
-		{
-			std::cerr << "Failed to parse network configuration." << std::endl;
-			return false;
-		}
-	}
-
-	if (!config.neuronEnergyCsvPath.empty())
-	{
-		params->neuronEnergyCsvPath = config.neuronEnergyCsvPath;
-	}
-
-	if (!config.synapsesEnergyCsvPath.empty())
+	std::string path = config.outputDirectory + "/" + name;
+	std::ofstream out(path);
+	if (!out.is_open())
 	{
-		params->synapsesEnergyCsvPath = config.synapsesEnergyCsvPath;
+		std::cerr << "Failed to write " << path << std::endl;
+		return false;
 	}
-
-	params->verbosity = config.verbosity;
+	write(out);
+	std::cout << "Wrote " << path << std::endl;
 	return true;
 }
 
@@ -102,7 +100,7 @@ int main(int argc, char* argv[])
 	try {
 		if (argc < 2)
 		{
-			std::cerr << "Usage: " << argv[0] << " <json configuration file>" << std::endl;
+			std::cerr << "Usage: " << argv[0] << " <json configuration file> [--resume [snapshot file] | --compile [image file] | --sweep <spec file> | --montecarlo <spec file>]" << std::endl;
 			return 1;
 		}
 
@@ -110,7 +108,14 @@ int main(int argc, char* argv[])
 		XMLParser parser;
 
 		//parse json file
+		const std::uint64_t configStart = Profiler::now();
 		Config config = parser.parseConfigFromFile(argv[1]);
+		parser.setStreaming(config.xmlStreaming);
+		if (config.profile)
+		{
+			Profiler::enable(config.profileHardwareCounters);
+			Profiler::addTime(Profiler::ConfigParse, Profiler::now() - configStart);
+		}
 
 		// Validate configuration paths
 		if (config.xmlConfigPath.empty())
@@ -119,6 +124,21 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
+		// --compile [image]: parse the XML once and write the network image, then exit
+		if (argc >= 3 && std::string(argv[2]) == "--compile")
+		{
+			std::string imagePath = (argc >= 4) ? argv[3] : config.networkImagePath;
+			if (imagePath.empty())
+				imagePath = config.xmlConfigPath + ".nemoimg";
+
+			std::uint64_t sourceHash = 0;
+			if (!ParseNetworkXML(&parser, &params, config) || !hashNetworkSources(NetworkSources(config), sourceHash))
+				return 1;
+			writeNetworkImage(imagePath, params, sourceHash);
+			std::cout << "Wrote network image " << imagePath << std::endl;
+			return 0;
+		}
+
 		if (config.dataInputPath.empty())
 		{
 			std::cerr << "Configuration Error: Data input path is empty. Please specify 'DataInputFile' in the JSON config." << std::endl;
@@ -126,25 +146,119 @@ int main(int argc, char* argv[])
 		}
 
 		// Parse the XML file to get network parameters
-		bool succeed = RetrieveNetworkParamsFromXML(&parser, &params, config);
+		bool succeed;
+		{
+			Profiler::Scope timer(Profiler::XmlParse);
+			succeed = RetrieveNetworkParamsFromXML(&parser, &params, config);
+		}
 		if (!succeed)
 		{
 			return 1;
 		}
 
-		NEMOEngine NemoEngine(params);
+		// --sweep <spec>: run every configuration of the spec on the parsed network, write a summary
+		if (argc >= 3 && std::string(argv[2]) == "--sweep")
+		{
+			if (argc < 4)
+			{
+				std::cerr << "Configuration Error: --sweep needs a sweep spec file." << std::endl;
+				return 1;
+			}
+			SweepSpec spec = parseSweepSpec(argv[3]);
+			std::vector<SweepRow> rows = runSweep(params, spec, config.dataInputPath);
+
+			writeSweepSummary(std::cout, spec, rows, false);
+			bool written = writeReport(config, spec.summaryFile,
+			                           [&](std::ostream& out) { writeSweepSummary(out, spec, rows, true); });
+			if (written && Profiler::enabled())
+				written = writeReport(config, config.profileReport, Profiler::writeReport);
+			return written ? 0 : 1;
+		}
+
+		// --montecarlo <spec>: device-variation trials on the parsed network, write statistics
+		if (argc >= 3 && std::string(argv[2]) == "--montecarlo")
+		{
+			if (argc < 4)
+			{
+				std::cerr << "Configuration Error: --montecarlo needs a Monte Carlo spec file." << std::endl;
+				return 1;
+			}
+			MonteCarloSpec spec = parseMonteCarloSpec(argv[3]);
+			MonteCarloResult result = runMonteCarlo(params, spec, config.dataInputPath);
+
+			writeMonteCarloSummary(std::cout, result, false);
+			bool written = writeReport(config, spec.summaryFile,
+			                           [&](std::ostream& out) { writeMonteCarloSummary(out, result, true); });
+			if (written && !spec.trialsFile.empty())
+				written = writeReport(config, spec.trialsFile,
+				                      [&](std::ostream& out) { writeMonteCarloTrials(out, result); });
+			if (written && Profiler::enabled())
+				written = writeReport(config, config.profileReport, Profiler::writeReport);
+			return written ? 0 : 1;
+		}
+
+		// --resume [snapshot]: continue from a checkpoint (default: the configured checkpoint_path)
+		if (argc >= 3 && std::string(argv[2]) == "--resume")
+		{
+			params.checkpointResumePath = (argc >= 4) ? argv[3] : config.checkpointPath;
+			if (params.checkpointResumePath.empty())
+			{
+				std::cerr << "Configuration Error: --resume needs a snapshot file or 'checkpoint_path' in the JSON config." << std::endl;
+				return 1;
+			}
+			if (params.checkpointPath.empty())
+				params.checkpointPath = params.checkpointResumePath; // keep checkpointing into the same file
+		}
 
-		std::ifstream inputFile(config.dataInputPath);
-		if (!inputFile.is_open()) {
-		    std::cerr << "Input Data Error: Failed to open input data file: " << config.dataInputPath << std::endl;
-		    return 1;
+		if (params.shards != 1)
+		{
+			// shards: the input split at the reset_every_lines boundaries, run in parallel and
+			// merged (from the launch directory, like the unsharded construction: relative
+			// input paths and the DS_<i> files; the other traces go to the output directory)
+			if (!directoryExists(config.outputDirectory) && !createDirectory(config.outputDirectory)) {
+			    std::cerr << "Failed to create output directory: " << config.outputDirectory << std::endl;
+			    return 1;
+			}
+			ShardedRun run = runSharded(params, config.dataInputPath, config.outputDirectory);
+			if (!changeWorkingDirectory(config.outputDirectory)) {
+			    std::cerr << "Failed to change working directory to: " << config.outputDirectory << std::endl;
+			    return 1;
+			}
+			printShardedRun(std::cout, run);
 		}
-		//change working directory
-		if (!changeWorkingDirectory(config.outputDirectory)) {
-		    std::cerr << "Failed to change working directory to: " << config.outputDirectory << std::endl;
-		    return 1;
+		else
+		{
+			std::unique_ptr<NEMOEngine> NemoEngine;
+			{
+				Profiler::Scope timer(Profiler::Construction);
+				NemoEngine.reset(new NEMOEngine(params));
+			}
+
+			std::ifstream inputFile(config.dataInputPath);
+			if (!inputFile.is_open()) {
+			    std::cerr << "Input Data Error: Failed to open input data file: " << config.dataInputPath << std::endl;
+			    return 1;
+			}
+			//change working directory
+			if (!changeWorkingDirectory(config.outputDirectory)) {
+			    std::cerr << "Failed to change working directory to: " << config.outputDirectory << std::endl;
+			    return 1;
+			}
+			NemoEngine->runEngine(inputFile);
+		}
+
+		// the working directory is now the output directory
+		if (Profiler::enabled())
+		{
+			std::ofstream report(config.profileReport);
+			if (!report.is_open())
+			{
+				std::cerr << "Failed to write " << config.profileReport << std::endl;
+				return 1;
+			}
+			Profiler::writeReport(report);
+			std::cout << "Wrote " << config.profileReport << std::endl;
 		}
-		NemoEngine.runEngine(inputFile);
 	} catch (const std::exception& ex) {
         std::cerr << "Standard exception caught: " << ex.what() << std::endl;
     } catch (...) {
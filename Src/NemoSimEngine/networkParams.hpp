@@ -1,8 +1,14 @@
 ﻿#pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include "../DS/DS.hpp"
+#include "../Common/WeightMatrix.hpp"
+#include "../Common/DeviceVariation.hpp"
+#include "../Common/Probes.hpp"
+#include "../Common/Readout.hpp"
+#include "../Common/Precision.hpp"
 
 /* =========================================================
    Network types (extended with ANNNetworkType)
@@ -15,6 +21,11 @@ enum class NetworkTypes {
 
 enum class Verbosity { Info, Debug }; // NEW
 
+// Early exit of the BIU DS gating loop once the rest of an input line is silent.
+enum class EarlyExitMode { Off, Strict, Tolerance };
+
+class EnergyTable;
+
 /* =========================================================
    Parameters (kept all your existing fields; only added ANN)
    ========================================================= */
@@ -23,6 +34,9 @@ struct NetworkParameters {
     NetworkTypes networkType;
     std::string neuronEnergyCsvPath;
     std::string synapsesEnergyCsvPath;
+    // BIU energy tables already loaded from the two CSVs and shared by every network built
+    // from these parameters (see Session); null = each network loads them itself.
+    std::shared_ptr<EnergyTable> energyTable;
     // LIF / BIU common
     double Cm = 0.0;
     double Cf = 0.0;
@@ -44,6 +58,57 @@ struct NetworkParameters {
     double DSClockMHz = 0.0;
 	DS::Mode DSMode = DS::ThresholdMode;
 
+    // BIU engine options (from the JSON config)
+    bool biuQuiescentFastForward = false; // skip silent cycles, replay decay lazily
+    EarlyExitMode biuEarlyExitMode = EarlyExitMode::Off;
+    double biuEarlyExitTolerance = 0.01;  // V; Tolerance mode only
+    int biuPatternLutInputs = 0;          // spike-pattern tables for fan-in <= this (0 = off)
+    bool biuLayerPipeline = false;        // one thread per layer, wavefront over cycles
+
+    // Threads of the work-stealing scheduler that splits neuron / column / PE loops
+    // (BIU, LIF, ANN); 1 = single-threaded, 0 = one per core
+    int computeThreads = 1;
+
+    // Reader -> simulator -> writer pipeline (all network types)
+    bool pipelineEnabled = false;
+    int  pipelineDepth = 256;             // lines / trace batches in flight per stage
+
+    // Checkpoint / resume (BIU and LIF)
+    std::string checkpointPath;           // empty = no snapshots
+    int    checkpointEveryLines = 0;
+    double checkpointEverySeconds = 300.0;
+    std::string checkpointResumePath;     // from --resume; empty = fresh run
+
+    // Network back to its initial state every N input lines (BIU and LIF); 0 = never.
+    // Sharded runs split the input at these resets (see Shards.hpp); 1 = no sharding,
+    // 0 = one shard per core.
+    int resetEveryLines = 0;
+    int shards = 1;
+
+    // Progress report period in seconds (all network types); 0 = no progress output
+    int progressIntervalSeconds = 0;
+
+    // Neurons whose traces are recorded (BIU); empty = all, as the verbosity asks
+    std::vector<NeuronProbe> probes;
+
+    // Online spike statistics (BIU and LIF; see SpikeStats.hpp)
+    bool spikeStats = false;
+    std::string spikeStatsFile = "spike_stats.json";
+    int spikeStatsBinLines = 1;
+
+    // Per-line output readout (BIU and LIF; see Readout.hpp)
+    ReadoutMode readoutMode = ReadoutMode::Off;
+    std::string readoutFile = "readout.csv";
+    std::string readoutLabelsPath;
+
+    // Numeric type of the BIU/LIF neuron and crossbar kernels (see Precision.hpp)
+    Precision precision = Precision::Double;
+    FixedPointFormat fixedPoint;      // Precision::Fixed word widths
+
+    // Monte Carlo trial: per-device variation applied when a BIU or LIF network is built
+    // (BIU VTh/RLeak/Cu/Cn, Y-Flash conductances). Default: nominal devices.
+    DeviceVariation variation;
+
     // ---------- NEW: BIU per-neuron overrides (per layer) ----------
     // If empty for a given layer, BIULayer should fall back to uniform VTh/refractory.
     // Size invariants (when present):
@@ -56,11 +121,14 @@ struct NetworkParameters {
     // Topology info
     std::vector<int> layerSizes;
 
-    // BIU synapses
-    std::vector<std::vector<std::vector<double>>> allWeights;
+    // BIU synapses: one [neurons][inputs] matrix per layer
+    std::vector<WeightMatrix> allWeights;
 
-    // Legacy “flat” YFlash matrices under <Architecture> (kept)
-    std::vector<std::vector<std::vector<double>>> YFlashWeights;
+    // Legacy “flat” YFlash matrices under <Architecture> (kept), one [rows][cols] matrix each
+    std::vector<WeightMatrix> YFlashWeights;
+
+    // Binary weight files referenced by <weights file="..."> (resolved paths, in parse order)
+    std::vector<std::string> weightFiles;
 
     // =================================================================
     //                       NEW: ANN parameters
@@ -95,8 +163,8 @@ struct NetworkParameters {
         int rows = 0;
         int cols = 0;
         bool isSigned = false;  // true → W = Wpos - Wneg
-        std::vector<std::vector<double>> Wpos;
-        std::vector<std::vector<double>> Wneg; // optional
+        WeightMatrix Wpos;
+        WeightMatrix Wneg; // optional
     };
     struct PEBlock {
         int id = -1;
@@ -119,6 +187,34 @@ enum class ConfigKey {
     SynapsesEnergyCsvPath,
     ProgressIntervalSeconds,
     Verbosity, // NEW
+    QuiescentFastForward,
+    EarlyExitMode,
+    EarlyExitTolerance,
+    Pipeline,
+    PipelineDepth,
+    CheckpointPath,
+    CheckpointEveryLines,
+    CheckpointEverySeconds,
+    NetworkImage,
+    XmlStreaming,
+    Profile,
+    ProfileReport,
+    ProfileHardwareCounters,
+    Probes,
+    SpikeStats,
+    SpikeStatsFile,
+    SpikeStatsBinLines,
+    Readout,
+    ReadoutFile,
+    ReadoutLabels,
+    Precision,
+    FixedVnBits,
+    FixedRatioBits,
+    BiuPatternLut,
+    BiuLayerPipeline,
+    ComputeThreads,
+    ResetEveryLines,
+    Shards,
     Unknown
 };
 
@@ -131,6 +227,33 @@ struct Config {
     std::string synapsesEnergyCsvPath;
     int         progressIntervalSeconds = 30;
     Verbosity   verbosity = Verbosity::Info; // NEW
+    bool        quiescentFastForward = false;
+    EarlyExitMode earlyExitMode = EarlyExitMode::Off;
+    double      earlyExitTolerance = 0.01;
+    int         biuPatternLutInputs = 0;
+    bool        biuLayerPipeline = false;
+    int         computeThreads = 1;
+    bool        pipeline = false;
+    int         pipelineDepth = 256;
+    std::string checkpointPath;
+    int         checkpointEveryLines = 0;
+    double      checkpointEverySeconds = 300.0;
+    int         resetEveryLines = 0;
+    int         shards = 1;
+    std::string networkImagePath;         // precompiled network image; empty = always parse the XML
+    bool        xmlStreaming = false;     // pull-parse the XML, weights straight into their storage
+    bool        profile = false;          // phase timers and counters (see Profiler.hpp)
+    std::string profileReport = "profile.json"; // relative to the output directory
+    bool        profileHardwareCounters = false;
+    std::vector<NeuronProbe> probes;      // selective trace recording (see Probes.hpp)
+    bool        spikeStats = false;       // online spike statistics (see SpikeStats.hpp)
+    std::string spikeStatsFile = "spike_stats.json"; // relative to the output directory
+    int         spikeStatsBinLines = 1;
+    ReadoutMode readoutMode = ReadoutMode::Off; // per-line output readout (see Readout.hpp)
+    std::string readoutFile = "readout.csv";    // relative to the output directory
+    std::string readoutLabelsPath;              // one class per input line; empty = no labels
+    Precision   precision = Precision::Double;  // neuron / crossbar kernels (see Precision.hpp)
+    FixedPointFormat fixedPoint;                // word widths of precision "fixed" (BIU only)
 };
 
 /* =========================================================
@@ -147,6 +270,24 @@ static const std::unordered_map<std::string, DS::Mode> StringToDSMode = {
     {"ThresholdMode", DS::Mode::ThresholdMode}
 };
 
+static const std::unordered_map<std::string, EarlyExitMode> StringToEarlyExitMode = {
+    {"off",       EarlyExitMode::Off},
+    {"strict",    EarlyExitMode::Strict},
+    {"tolerance", EarlyExitMode::Tolerance}
+};
+
+static const std::unordered_map<std::string, ReadoutMode> StringToReadoutMode = {
+    {"off",     ReadoutMode::Off},
+    {"counts",  ReadoutMode::Counts},
+    {"latency", ReadoutMode::Latency}
+};
+
+static const std::unordered_map<std::string, Precision> StringToPrecision = {
+    {"double", Precision::Double},
+    {"float",  Precision::Float},
+    {"fixed",  Precision::Fixed}
+};
+
 static const std::unordered_map<std::string, ConfigKey> StringToConfigKey = {
     {"OutputDirectory",        ConfigKey::OutputDirectory},
     {"XmlConfigPath",          ConfigKey::XmlConfigPath},
@@ -155,5 +296,33 @@ static const std::unordered_map<std::string, ConfigKey> StringToConfigKey = {
     {"NeuronEnergyTablePath",  ConfigKey::NeuronEnergyCsvPath},
     {"SynapsesEnergyTablePath",ConfigKey::SynapsesEnergyCsvPath},
     {"ProgressIntervalSeconds",ConfigKey::ProgressIntervalSeconds},
-    {"Verbosity",              ConfigKey::Verbosity} // NEW
+    {"Verbosity",              ConfigKey::Verbosity}, // NEW
+    {"QuiescentFastForward",   ConfigKey::QuiescentFastForward},
+    {"EarlyExitMode",          ConfigKey::EarlyExitMode},
+    {"EarlyExitTolerance",     ConfigKey::EarlyExitTolerance},
+    {"Pipeline",               ConfigKey::Pipeline},
+    {"PipelineDepth",          ConfigKey::PipelineDepth},
+    {"CheckpointPath",         ConfigKey::CheckpointPath},
+    {"CheckpointEveryLines",   ConfigKey::CheckpointEveryLines},
+    {"CheckpointEverySeconds", ConfigKey::CheckpointEverySeconds},
+    {"NetworkImage",           ConfigKey::NetworkImage},
+    {"XmlStreaming",           ConfigKey::XmlStreaming},
+    {"Profile",                ConfigKey::Profile},
+    {"ProfileReport",          ConfigKey::ProfileReport},
+    {"ProfileHardwareCounters",ConfigKey::ProfileHardwareCounters},
+    {"Probes",                 ConfigKey::Probes},
+    {"SpikeStats",             ConfigKey::SpikeStats},
+    {"SpikeStatsFile",         ConfigKey::SpikeStatsFile},
+    {"SpikeStatsBinLines",     ConfigKey::SpikeStatsBinLines},
+    {"Readout",                ConfigKey::Readout},
+    {"ReadoutFile",            ConfigKey::ReadoutFile},
+    {"ReadoutLabels",          ConfigKey::ReadoutLabels},
+    {"Precision",              ConfigKey::Precision},
+    {"FixedVnBits",            ConfigKey::FixedVnBits},
+    {"FixedRatioBits",         ConfigKey::FixedRatioBits},
+    {"BiuPatternLut",          ConfigKey::BiuPatternLut},
+    {"BiuLayerPipeline",       ConfigKey::BiuLayerPipeline},
+    {"ComputeThreads",         ConfigKey::ComputeThreads},
+    {"ResetEveryLines",        ConfigKey::ResetEveryLines},
+    {"Shards",                 ConfigKey::Shards}
 };
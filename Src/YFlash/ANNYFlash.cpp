@@ -6,7 +6,7 @@
  *  Constructors
  * ============ */
 
-ANNYFlash::ANNYFlash(const std::vector<std::vector<double>>& Wpos)
+ANNYFlash::ANNYFlash(const WeightMatrix& Wpos)
     : m_Wpos(Wpos), m_rows(static_cast<int>(Wpos.size())),
     m_cols(m_rows ? static_cast<int>(Wpos.front().size()) : 0),
     m_has_signed(false)
@@ -14,8 +14,7 @@ ANNYFlash::ANNYFlash(const std::vector<std::vector<double>>& Wpos)
     validateDims_();
 }
 
-ANNYFlash::ANNYFlash(const std::vector<std::vector<double>>& Wpos,
-    const std::vector<std::vector<double>>& Wneg)
+ANNYFlash::ANNYFlash(const WeightMatrix& Wpos, const WeightMatrix& Wneg)
     : m_Wpos(Wpos), m_Wneg(Wneg),
     m_rows(static_cast<int>(Wpos.size())),
     m_cols(m_rows ? static_cast<int>(Wpos.front().size()) : 0),
@@ -162,29 +161,11 @@ std::vector<double> ANNYFlash::bitwise_pmac(const std::vector<std::vector<uint8_
 
 void ANNYFlash::validateDims_() const 
 {
-    // Ensure all rows have equal length (rectangular matrix).
+    // WeightMatrix is rectangular by construction (ragged rows are rejected when it is built).
     if (m_rows < 0 || m_cols < 0) 
     {
         throw std::invalid_argument("YFlash: negative dimensions are invalid.");
     }
-    if (m_rows == 0) return; // allow empty matrix
-
-    const auto expected_cols = m_cols;
-    for (const auto& row : m_Wpos) 
-    {
-        if (static_cast<int>(row.size()) != expected_cols) {
-            throw std::invalid_argument("YFlash: Wpos is not rectangular.");
-        }
-    }
-    if (m_has_signed) 
-    {
-        for (const auto& row : m_Wneg) 
-        {
-            if (static_cast<int>(row.size()) != expected_cols) {
-                throw std::invalid_argument("YFlash: Wneg is not rectangular.");
-            }
-        }
-    }
 }
 
 bool ANNYFlash::isBroadcastVector_(const std::vector<std::vector<uint8_t>>& bits, int rows) 
@@ -19,22 +19,23 @@
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
+#include "../Common/WeightMatrix.hpp"
 
 class ANNYFlash {
 public:
     /**
      * @brief Construct an unsigned (single-cell) Y-Flash array.
      * @param Wpos  Weight matrix of size [rows][cols]. Values are treated as non-negative.
+     *              Shared, not copied (it may be a view into a network image).
      */
-    explicit ANNYFlash(const std::vector<std::vector<double>>& Wpos);
+    explicit ANNYFlash(const WeightMatrix& Wpos);
 
     /**
      * @brief Construct a signed (dual-cell) Y-Flash array with W = Wpos - Wneg.
      * @param Wpos  Positive sub-array weights [rows][cols].
      * @param Wneg  Negative sub-array weights [rows][cols]. Must match Wpos dimensions.
      */
-    ANNYFlash(const std::vector<std::vector<double>>& Wpos,
-        const std::vector<std::vector<double>>& Wneg);
+    ANNYFlash(const WeightMatrix& Wpos, const WeightMatrix& Wneg);
 
     /// @return number of rows (wordlines).
     int getRows() const noexcept { return m_rows; }
@@ -76,8 +77,8 @@ public:
 
 private:
     // Core storage
-    std::vector<std::vector<double>> m_Wpos;
-    std::vector<std::vector<double>> m_Wneg;   // only used when m_has_signed_ == true
+    WeightMatrix m_Wpos;
+    WeightMatrix m_Wneg;   // only used when m_has_signed_ == true
 
     int m_rows = 0;
     int m_cols = 0;
@@ -1,4 +1,5 @@
 #include "YFlash.hpp"
+#include "../Common/DeviceVariation.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
@@ -34,11 +35,104 @@ YFlash::YFlash(const std::vector<std::vector<double>>& input_matrix, int index)
             throw std::invalid_argument(oss.str());
         }
     }
-    m_weights = input_matrix;
+    m_weights = WeightMatrix::fromRows(input_matrix);
     m_rows = input_matrix.size();
     m_cols = expected_cols;
 }
 
+/**
+ * @brief Construct a Y-Flash array on a shared weight matrix.
+ *        Rectangularity is guaranteed by WeightMatrix; only emptiness is checked.
+ */
+YFlash::YFlash(const WeightMatrix& weights, int index)
+    : m_weights(weights), m_index(index)
+{
+    if (weights.empty())
+    {
+        std::ostringstream oss;
+        oss << "YFlash[" << m_index << "]: input matrix must not be empty.";
+        throw std::invalid_argument(oss.str());
+    }
+    if (weights.cols() == 0)
+    {
+        std::ostringstream oss;
+        oss << "YFlash[" << m_index << "]: input matrix must have at least one column.";
+        throw std::invalid_argument(oss.str());
+    }
+    m_rows = weights.rows();
+    m_cols = weights.cols();
+}
+
+/**
+ * @brief Store G * (factor - 1) for every cell; step() adds it to the nominal weight.
+ */
+void YFlash::applyVariation(const DeviceVariation& variation)
+{
+    m_delta.clear();
+    if (variation.sigmaYFlash <= 0.0)
+        return;
+
+    m_delta.resize(m_rows * m_cols);
+    const double* g = m_weights.data();
+    for (size_t k = 0; k < m_delta.size(); ++k)
+    {
+        const double f = variation.factor(DeviceVariation::YFlashConductance, variation.sigmaYFlash,
+                                          static_cast<std::uint64_t>(m_index), k);
+        m_delta[k] = g[k] * (f - 1.0);
+    }
+    buildFloatConductance_();
+}
+
+void YFlash::setPrecision(Precision precision)
+{
+    if (precision == Precision::Fixed)
+        throw std::invalid_argument("YFlash: fixed precision is only supported by BIU layers.");
+    m_precision = precision;
+    buildFloatConductance_();
+}
+
+void YFlash::buildFloatConductance_()
+{
+    if (m_precision != Precision::Float)
+    {
+        m_conductanceFloat.reset();
+        return;
+    }
+    auto conductance = std::make_shared<std::vector<float>>(m_weights.data(), m_weights.data() + m_rows * m_cols);
+    for (size_t k = 0; k < m_delta.size(); ++k)
+        (*conductance)[k] = static_cast<float>(m_weights.data()[k] + m_delta[k]);
+    m_conductanceFloat = std::move(conductance);
+}
+
+namespace {
+
+/// currents[j] += sum_i (g[i][j] (+ delta[i][j])) * voltages[i] for the columns j in
+/// [begin, end) of a row-major rows x cols matrix, computed in Real.
+template <typename Real>
+void multiplyAccumulate(const Real* g, const double* delta, size_t rows, size_t cols, size_t begin, size_t end,
+                        const std::vector<double>& voltages, std::vector<Real>& currents)
+{
+    for (size_t i = 0; i < rows; ++i, g += cols)
+    {
+        const Real v = static_cast<Real>(voltages[i]);
+        if (delta)
+        {
+            const double* d = delta + i * cols;
+            for (size_t j = begin; j < end; ++j)
+            {
+                currents[j] += (g[j] + d[j]) * v;
+            }
+            continue;
+        }
+        for (size_t j = begin; j < end; ++j)
+        {
+            currents[j] += g[j] * v;
+        }
+    }
+}
+
+} // namespace
+
 /**
  * @brief Perform a digital vector-matrix multiplication: y = W * x.
  *        Throws if input vector size does not match the number of columns.
@@ -53,14 +147,20 @@ std::vector<double> YFlash::step(const std::vector<double>& voltages) const
         throw std::invalid_argument(oss.str());
     }
 
-    std::vector<double> currents(m_cols, 0.0);
-    for (size_t i = 0; i < m_rows; ++i)
+    if (m_conductanceFloat)
     {
-        for (size_t j = 0; j < m_cols; ++j)
-        {
-            currents[j] += m_weights[i][j] * voltages[i];
-        }
+        std::vector<float> currents(m_cols, 0.0f);
+        parallelFor(m_scheduler, m_cols, m_grain, [&](size_t begin, size_t end) {
+            multiplyAccumulate(m_conductanceFloat->data(), nullptr, m_rows, m_cols, begin, end, voltages, currents);
+        });
+        return std::vector<double>(currents.begin(), currents.end());
     }
+
+    std::vector<double> currents(m_cols, 0.0);
+    const double* delta = m_delta.empty() ? nullptr : m_delta.data();
+    parallelFor(m_scheduler, m_cols, m_grain, [&](size_t begin, size_t end) {
+        multiplyAccumulate(m_weights.data(), delta, m_rows, m_cols, begin, end, voltages, currents);
+    });
     return currents;
 }
 
@@ -70,8 +170,9 @@ std::vector<double> YFlash::step(const std::vector<double>& voltages) const
 void YFlash::print() const
 {
     std::cout << "YFlash[" << m_index << "] weights:\n";
-    for (const auto& row : m_weights)
+    for (size_t r = 0; r < m_weights.rows(); ++r)
     {
+        const WeightMatrix::Row row = m_weights[r];
         for (double val : row)
         {
             std::cout << val << " ";
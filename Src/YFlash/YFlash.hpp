@@ -7,8 +7,11 @@
  * It is intended for use in neuromorphic and in-memory computing simulations.
  *
  * Key features:
- *  - Construction from a rectangular matrix of weights (all non-negative).
+ *  - Construction from a rectangular matrix of weights (all non-negative), shared with
+ *    the network parameters rather than copied.
  *  - Digital emulation of vector-matrix multiplication: y = W * x.
+ *  - Optional device variation: per-cell conductance deltas on top of the shared weights.
+ *  - Float or double accumulation of the product (see Precision.hpp).
  *  - Access to the underlying weights and array dimensions.
  *  - Utility to print the weight matrix.
  */
@@ -17,6 +20,12 @@
 #include <cstddef>
 #include <stdexcept>
 #include <iostream>
+#include <memory>
+#include "../Common/WeightMatrix.hpp"
+#include "../Common/Precision.hpp"
+#include "../Common/TaskScheduler.hpp"
+
+struct DeviceVariation;
 
 class YFlash {
 public:
@@ -27,6 +36,32 @@ public:
      */
     YFlash(const std::vector<std::vector<double>>& input_matrix, int index = -1); // Add index parameter
 
+    /**
+     * @brief Construct a Y-Flash array on a shared weight matrix (not copied).
+     * @throws std::invalid_argument if the matrix is empty.
+     */
+    YFlash(const WeightMatrix& weights, int index = -1);
+
+    /**
+     * @brief Apply the device variation of a Monte Carlo trial: every cell conductance is
+     *        scaled by its DeviceVariation::YFlashConductance factor (group = array index).
+     *        Only the deltas are stored; the shared weights are left untouched.
+     */
+    void applyVariation(const DeviceVariation& variation);
+
+    /**
+     * @brief Numeric type of step(). Float multiplies a float copy of the conductances
+     *        (variation deltas folded in) with float accumulators; the result is returned
+     *        as double either way.
+     */
+    void setPrecision(Precision precision);
+
+    /**
+     * @brief Split step() into column ranges on `scheduler` (null = single-threaded). Each
+     *        column is still summed over the rows in order, so the result is unchanged.
+     */
+    void setScheduler(TaskScheduler* scheduler) { m_scheduler = scheduler; }
+
     /**
      * @brief Perform a digital vector-matrix multiplication: y = W * x.
      * @param voltages  Input vector of length equal to the number of columns.
@@ -43,8 +78,11 @@ public:
     void setIndex(int index) { m_index = index; }
     int getIndex() const { return m_index; }
 
-    /// The underlying weight matrix [rows][cols].
-    std::vector<std::vector<double>> m_weights;
+    /// The underlying (nominal) weight matrix [rows][cols].
+    WeightMatrix m_weights;
+
+    /// Per-cell conductance deltas, row-major; empty = nominal device.
+    std::vector<double> m_delta;
 
     /// Number of rows (wordlines).
     size_t m_rows;
@@ -53,5 +91,11 @@ public:
     size_t m_cols;
 private:
     int m_index = -1; // Add this member
+    Precision m_precision = Precision::Double;
+    std::shared_ptr<const std::vector<float>> m_conductanceFloat; // Float: G (+ delta), row-major
+    TaskScheduler* m_scheduler = nullptr;
+    mutable ParallelGrain m_grain; // cost per column of step()
+
+    void buildFloatConductance_();
 };
 
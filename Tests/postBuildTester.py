@@ -1,10 +1,15 @@
 import subprocess
 import sys
 import os
+import json
+import re
+import shutil
+import tempfile
+from decimal import Decimal
 
-# Define the path to the executable
+# Define the path to the executable (or pass it as the first argument)
 curr_WD = os.getcwd()
-exe_path = os.path.join(os.getcwd(),"..\\_build64\\Debug\\NEMOSIM.exe")
+exe_path = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.getcwd(),"..\\_build64\\Debug\\NEMOSIM.exe")
 print(f"start")
 # Hard-code the list of XML files
 xml_files = [
@@ -34,5 +39,255 @@ for xml_path in xml_files:
         print(f"An error occurred: {e}")
     print("-" * 40)
     os.chdir(curr_WD)
-print("All tasks completed.")
-sys.exit(0)  # Ensure clean exit
\ No newline at end of file
+
+# ---------------- mode equivalence cases ----------------
+# Every engine option that is documented to leave the results unchanged is run on the test
+# networks and diffed against the default run: all files written to the output directory
+# and the launch directory (DS_<i>), and the result lines of the log (ANN networks write no
+# trace files).
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+
+NETWORKS = {
+    "BIU": {
+        "xml_config_path": os.path.join(TESTS_DIR, "SNN", "BIU", "test2.xml"),
+        "sup_xml_config_path": os.path.join(TESTS_DIR, "SNN", "BIU", "supervisor.xml"),
+        "data_input_file": os.path.join(TESTS_DIR, "SNN", "BIU", "input2.txt"),
+        "synapses_energy_table_path": os.path.join(TESTS_DIR, "SNN", "BIU", "Spike-in_vs_Not_spike-in.csv"),
+        "neuron_energy_table_path": os.path.join(TESTS_DIR, "SNN", "BIU", "Energy_Neuron_CSV_Content.csv"),
+    },
+    "LIF": {
+        "xml_config_path": os.path.join(TESTS_DIR, "SNN", "LIF", "step_current_test", "test.xml"),
+        "data_input_file": os.path.join(TESTS_DIR, "SNN", "LIF", "step_current_test", "input.txt"),
+    },
+    "ANN": {
+        "xml_config_path": os.path.join(TESTS_DIR, "ANN", "test.xml"),
+        "data_input_file": os.path.join(TESTS_DIR, "ANN", "input.txt"),
+    },
+}
+RESULT_LINE = re.compile(r"^\[FIRE\]|IMC-MAC")
+
+# name, networks, options of the case, options of both runs (e.g. reset_every_lines),
+# relative tolerance of the values (0 = identical files)
+CASES = [
+    ("pipeline", ["BIU", "LIF", "ANN"], {"pipeline": True}, {}, 0.0),
+    ("xml_streaming", ["BIU", "LIF", "ANN"], {"xml_streaming": True}, {}, 0.0),
+    ("precision=double", ["BIU", "LIF"], {"precision": "double"}, {}, 0.0),
+    ("biu_pattern_lut", ["BIU"], {"biu_pattern_lut": 16}, {"verbosity": "debug"}, 1e-5),  # Vn, Vin up to rounding
+    ("biu_layer_pipeline", ["BIU"], {"biu_layer_pipeline": True}, {"verbosity": "debug"}, 0.0),
+    ("layer pipeline, exit", ["BIU"], {"biu_layer_pipeline": True}, {"early_exit_mode": "strict"}, 0.0),
+    ("compute_threads", ["BIU", "LIF", "ANN"], {"compute_threads": 4}, {}, 0.0),
+    ("compute_threads=0", ["BIU", "LIF", "ANN"], {"compute_threads": 0}, {"verbosity": "debug"}, 0.0),
+    ("shards", ["BIU", "LIF"], {"shards": 3}, {"reset_every_lines": 1000}, 0.0),
+    ("shards=0", ["BIU", "LIF"], {"shards": 0}, {"reset_every_lines": 1000, "readout": "counts"}, 0.0),
+    ("probes", ["BIU"], {"probes": "record=spikes"}, {}, 0.0),
+    ("probes, debug", ["BIU"], {"probes": "record=spikes,vn,vin"}, {"verbosity": "debug"}, 0.0),
+    ("fixed, threads", ["BIU"], {"compute_threads": 4}, {"precision": "fixed"}, 0.0),
+]
+# precision=fixed quantizes Vn, so a few spikes move by a cycle: its spike counts are held
+# to the double run within this fraction, every other file must match
+FIXED_SPIKE_TOLERANCE = 0.05
+
+
+def run_network(work_dir, run_name, network, options, args=(), fresh=True):
+    """Runs `network` with `options` from <work_dir>/<run_name>/cwd (output directory
+    <run_name>/out); returns the exit code, {file: text} of both directories plus the
+    result lines, and the log."""
+    run_dir = os.path.join(work_dir, run_name)
+    if fresh and os.path.isdir(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(os.path.join(run_dir, "cwd"), exist_ok=True)
+    config = dict(NETWORKS[network])
+    config["output_directory"] = os.path.join(run_dir, "out")
+    config["progress_interval_seconds"] = 0
+    config.update(options)
+    config_path = os.path.join(run_dir, "config.json")
+    with open(config_path, "w") as f:
+        json.dump(config, f, indent=4)  # one key per line, as the config reader expects
+    result = subprocess.run([exe_path, config_path] + list(args), cwd=os.path.join(run_dir, "cwd"),
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    files = {}
+    for sub in ("cwd", "out"):
+        root = os.path.join(run_dir, sub)
+        for dir_path, _, names in os.walk(root):
+            for name in names:
+                path = os.path.join(dir_path, name)
+                with open(path) as f:
+                    files[os.path.relpath(path, run_dir)] = f.read()
+    files["<log>"] = "\n".join(line for line in result.stdout.splitlines() if RESULT_LINE.search(line))
+    return result.returncode, files, result.stdout
+
+
+def same_values(a, b, tolerance):
+    if tolerance == 0.0:
+        return a == b
+    tokens_a, tokens_b = re.split(r"[\s,]+", a.strip()), re.split(r"[\s,]+", b.strip())
+    if len(tokens_a) != len(tokens_b):
+        return False
+    for x, y in zip(tokens_a, tokens_b):
+        try:
+            fx, fy = float(x), float(y)
+        except ValueError:
+            if x != y:
+                return False
+            continue
+        if abs(fx - fy) > tolerance * max(abs(fx), abs(fy), 1e-12):
+            return False
+    return True
+
+
+def compare_runs(expected, actual, tolerance=0.0):
+    """Names of the files that differ, are missing or are extra in `actual`."""
+    problems = [name + ": missing" for name in sorted(expected) if name not in actual]
+    problems += [name + ": extra" for name in sorted(actual) if name not in expected]
+    problems += [name + ": differs" for name in sorted(expected)
+                 if name in actual and not same_values(expected[name], actual[name], tolerance)]
+    return problems
+
+
+def compare_spike_counts(expected, actual, tolerance):
+    """compare_runs() with the spike files compared by their number of spikes."""
+    spike_files = [name for name in expected if os.path.basename(name).startswith("spikes_")]
+    problems = compare_runs(dict((name, text) for name, text in expected.items() if name not in spike_files),
+                            dict((name, text) for name, text in actual.items() if name not in spike_files))
+    for name in sorted(spike_files):
+        if name not in actual:
+            problems.append(name + ": missing")
+            continue
+        count, other = expected[name].split().count("1"), actual[name].split().count("1")
+        if abs(count - other) > tolerance * max(count, other, 20):
+            problems.append("%s: %d spikes instead of %d" % (name, other, count))
+    return problems
+
+
+def report(case, network, returncode, problems):
+    if returncode != 0:
+        problems = ["exit code %d" % returncode] + problems
+    print("%-5s %-20s %s" % (network, case, "ok" if not problems else "FAILED"))
+    for problem in problems[:10]:
+        print("      " + problem)
+    return not problems
+
+
+def run_resume_case(work_dir, network):
+    """Runs the first half of the input with a checkpoint at its end, resumes on the whole
+    input and returns the files of the resumed run (to match an uninterrupted one)."""
+    with open(NETWORKS[network]["data_input_file"]) as f:
+        lines = f.readlines()
+    half = max(1, len(lines) // 2)
+    prefix_path = os.path.join(work_dir, "prefix.txt")
+    with open(prefix_path, "w") as f:
+        f.writelines(lines[:half])
+    snapshot = os.path.join(work_dir, "snapshot.bin")
+    returncode, _, _ = run_network(work_dir, "resume", network,
+                                   {"data_input_file": prefix_path, "checkpoint_path": snapshot,
+                                    "checkpoint_every_lines": half})
+    if returncode != 0:
+        return returncode, {}
+    returncode, files, log = run_network(work_dir, "resume", network, {"checkpoint_every_lines": half},
+                                         args=["--resume", snapshot], fresh=False)
+    if "Resuming after input line %d" % half not in log:
+        files["<log>"] += "\n(the run did not resume)"
+    return returncode, files
+
+
+def run_image_case(work_dir, network):
+    """Compiles the network image with --compile, then runs from the image (which must not
+    be rebuilt)."""
+    image = os.path.join(work_dir, network + ".nemoimg")
+    returncode, _, log = run_network(work_dir, "image", network, {}, args=["--compile", image])
+    if returncode != 0 or "Wrote network image" not in log:
+        return returncode or 1, {}
+    compiled = os.stat(image).st_mtime_ns
+    returncode, files, _ = run_network(work_dir, "image", network, {"network_image": image})
+    if os.stat(image).st_mtime_ns != compiled:
+        files["<log>"] += "\n(the image was rebuilt instead of loaded)"
+    return returncode, files
+
+
+# Spellings of the same decimal value: exponents, a sign, a shifted point, and long
+# mantissas or large exponents that take the strtod path of the number parser.
+NUMBER_SPELLINGS = [
+    lambda t: t + "e0",
+    lambda t: t if t.startswith("-") else "+" + t,
+    lambda t: format(Decimal(t).scaleb(1), "f") + "e-1",
+    lambda t: t + ("0" * 25 if "." in t else "." + "0" * 25),
+    lambda t: format(Decimal(t).scaleb(30), "f") + "E-30",
+]
+NUMBER_SEPARATORS = [" ", "\t", "  \n\t  "]
+
+
+def respell_rows(xml_text):
+    """The XML with every number of its <row> elements respelled."""
+    count = [0]
+
+    def respell(match):
+        tokens = match.group(1).split()
+        for i, token in enumerate(tokens):
+            tokens[i] = NUMBER_SPELLINGS[count[0] % len(NUMBER_SPELLINGS)](token)
+            count[0] += 1
+        text = ""
+        for i, token in enumerate(tokens):
+            text += (NUMBER_SEPARATORS[(count[0] + i) % len(NUMBER_SEPARATORS)] if i else " ") + token
+        return "<row>" + text + " \n</row>"
+
+    return re.sub(r"<row>(.*?)</row>", respell, xml_text, flags=re.DOTALL)
+
+
+def run_number_case(work_dir, network, options):
+    """Runs the network from a copy of its XML whose weights are respelled."""
+    with open(NETWORKS[network]["xml_config_path"]) as f:
+        text = respell_rows(f.read())
+    xml_path = os.path.join(work_dir, network + "_numbers.xml")
+    with open(xml_path, "w") as f:
+        f.write(text)
+    return run_network(work_dir, "numbers", network, dict(options, xml_config_path=xml_path))[:2]
+
+
+def run_mode_cases():
+    work_dir = tempfile.mkdtemp(prefix="nemosim_modes_")
+    baselines = {}
+    failures = 0
+
+    def baseline(network, common):
+        key = (network, json.dumps(common, sort_keys=True))
+        if key not in baselines:
+            baselines[key] = run_network(work_dir, "base%d" % len(baselines), network, common)[:2]
+        return baselines[key]
+
+    try:
+        for case, networks, options, common, tolerance in CASES:
+            for network in networks:
+                base_returncode, expected = baseline(network, common)
+                if base_returncode != 0:
+                    failures += not report(case, network, base_returncode, ["default run failed"])
+                    continue
+                returncode, actual, _ = run_network(work_dir, "case", network, dict(common, **options))
+                failures += not report(case, network, returncode, compare_runs(expected, actual, tolerance))
+        # probes of a few neurons: exactly their files, as the default run writes them
+        probed = re.compile(r"^cwd/|^out/spikes_1_[234]\.txt$|^<log>$")
+        expected = dict((name, text) for name, text in baseline("BIU", {})[1].items() if probed.search(name))
+        returncode, actual, _ = run_network(work_dir, "case", "BIU", {"probes": "layer=1 neurons=2-4 record=spikes"})
+        failures += not report("probes, subset", "BIU", returncode, compare_runs(expected, actual))
+        base_returncode, expected = baseline("BIU", {"probes": "record=spikes"})
+        returncode, actual, _ = run_network(work_dir, "case", "BIU", {"probes": "record=spikes", "precision": "fixed"})
+        failures += not report("precision=fixed", "BIU", returncode or base_returncode,
+                               compare_spike_counts(expected, actual, FIXED_SPIKE_TOLERANCE))
+        for network in ["BIU", "LIF", "ANN"]:
+            for case, options in [("number spellings", {}), ("numbers, streaming", {"xml_streaming": True})]:
+                returncode, actual = run_number_case(work_dir, network, options)
+                failures += not report(case, network, returncode, compare_runs(baseline(network, {})[1], actual))
+        for network in ["BIU", "LIF", "ANN"]:
+            returncode, actual = run_image_case(work_dir, network)
+            failures += not report("network_image", network, returncode, compare_runs(baseline(network, {})[1], actual))
+        for network in ["BIU", "LIF"]:
+            returncode, actual = run_resume_case(work_dir, network)
+            failures += not report("checkpoint+resume", network, returncode, compare_runs(baseline(network, {})[1], actual))
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+    return failures
+
+
+failures = run_mode_cases()
+print("All tasks completed." if not failures else "%d mode case(s) FAILED." % failures)
+sys.exit(1 if failures else 0)
\ No newline at end of file